@@ -19,7 +19,7 @@
 #include "localgraph.h"
 #include "pangenome/pangraph.h"
 #include "pangenome/pannode.h"
-#include "index.h"
+#include "frozen_index.h"
 #include "noise_filtering.h"
 #include "estimate_parameters.h"
 #include "OptionsAggregator.h"
@@ -37,6 +37,8 @@ struct CompareOptions {
     uint32_t window_size { 14 };
     uint32_t kmer_size { 15 };
     uint32_t threads { 1 };
+    uint32_t read_batch_size { DEFAULT_READ_BATCH_SIZE };
+    uint32_t read_queue_depth { DEFAULT_READ_QUEUE_DEPTH };
     fs::path vcf_refs_file;
     uint8_t verbosity { 0 };
     float error_rate { 0.11 };
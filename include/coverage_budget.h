@@ -0,0 +1,74 @@
+#ifndef PANDORA_COVERAGE_BUDGET_H
+#define PANDORA_COVERAGE_BUDGET_H
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * The bases of reads which can be mapped before the maximum coverage of a genome is
+ * exceeded, shared by the mapping threads without locking. Each thread reserves bases
+ * in chunks, e.g. for a batch of reads, and consumes the reads it maps from its
+ * reservation, so the shared counters are seldom updated.
+ * Once a read doesn't fit in what is left, the reservations are drained: each gives
+ * back its unused bases the next time it is used, and reads are then reserved one by
+ * one. A read exceeds the maximum coverage only if it doesn't fit once no thread holds
+ * unused bases, so all threads map up to the maximum coverage as a single one would.
+ * The read which exceeds it has its bases consumed, but neither it nor the reads after
+ * it are mapped.
+ */
+class CoverageBudget {
+public:
+    // the coverage is exceeded once more than max_covg * genome_size bases are
+    // consumed, rounding the coverage down
+    CoverageBudget(const uint64_t genome_size, const uint32_t max_covg);
+
+    // the reservation of a thread, which gives back what it did not consume when it
+    // is released or destroyed
+    class Reservation {
+    public:
+        explicit Reservation(CoverageBudget& budget);
+        Reservation(const Reservation& other) = delete;
+        Reservation& operator=(const Reservation& other) = delete;
+        ~Reservation();
+
+        // reserves the given bases, or what is left of the budget. Nothing once the
+        // reservations are drained
+        void reserve(const uint64_t bases);
+
+        // consumes a read, reserving more if needed. False if the read can't be
+        // mapped as it exceeds the maximum coverage, which is then warned about once,
+        // or as the maximum coverage was already exceeded. While draining, it may wait
+        // for the other reservations to give back their unused bases, so a thread
+        // must not hold unused bases in another reservation
+        bool consume(const uint64_t read_length);
+
+        void release();
+
+    private:
+        CoverageBudget& budget;
+        uint64_t available { 0 };
+        uint64_t granted { 0 }; // since the last release
+        uint64_t consumed { 0 }; // since the last release
+
+        // gives back the unused bases, and is no longer counted as holding any
+        void give_back();
+    };
+
+    bool is_exceeded() const { return exceeded.load(std::memory_order_relaxed); }
+
+    // exact once the reservations are released
+    uint64_t bases_consumed() const { return consumed.load(); }
+
+private:
+    const uint64_t max_bases; // the most bases which don't exceed the coverage
+    std::atomic<uint64_t> reserved; // held by reservations or consumed
+    std::atomic<uint64_t> held; // granted to reservations, until they give it back
+    std::atomic<uint64_t> consumed;
+    std::atomic<bool> draining;
+    std::atomic<bool> exceeded;
+
+    // reserves the given bases, or what is left of the budget, and returns that
+    uint64_t reserve_up_to(const uint64_t bases);
+};
+
+#endif // PANDORA_COVERAGE_BUDGET_H
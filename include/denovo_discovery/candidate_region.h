@@ -6,6 +6,7 @@
 #include "fastaq_handler.h"
 #include "interval.h"
 #include "localPRG.h"
+#include "read_batch_reader.h"
 #include <algorithm>
 #include <set>
 #include <vector>
@@ -114,7 +115,9 @@ public:
 
     void load_candidate_region_pileups(const fs::path& reads_filepath,
         const CandidateRegions& candidate_regions,
-        const PileupConstructionMap& pileup_construction_map, uint32_t threads = 1);
+        const PileupConstructionMap& pileup_construction_map, uint32_t threads = 1,
+        const uint32_t read_batch_size = DEFAULT_READ_BATCH_SIZE,
+        const uint32_t read_queue_depth = DEFAULT_READ_QUEUE_DEPTH);
 };
 
 #endif // PANDORA_CANDIDATE_REGION_H
@@ -64,4 +64,8 @@ PathComponents find_interval_and_flanks_in_localpath(const Interval& interval,
 std::vector<MinimizerHitPtr> find_hits_inside_path(
     const std::vector<MinimizerHitPtr>& read_hits, const prg::Path& local_path);
 
+// same, for the hits of a pangenome::Read
+std::vector<MinimizerHit> find_hits_inside_path(
+    const std::vector<MinimizerHit>& read_hits, const prg::Path& local_path);
+
 #endif
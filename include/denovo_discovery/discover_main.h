@@ -6,7 +6,7 @@
 #include <boost/log/trivial.hpp>
 #include "CLI11.hpp"
 #include "utils.h"
-#include "index.h"
+#include "frozen_index.h"
 #include "pangenome/pangraph.h"
 #include "noise_filtering.h"
 #include "estimate_parameters.h"
@@ -24,6 +24,8 @@ struct DiscoverOptions {
     uint32_t window_size { 14 };
     uint32_t kmer_size { 15 };
     uint32_t threads { 1 };
+    uint32_t read_batch_size { DEFAULT_READ_BATCH_SIZE };
+    uint32_t read_queue_depth { DEFAULT_READ_QUEUE_DEPTH };
     uint8_t verbosity { 0 };
     float error_rate { 0.11 };
     uint32_t genome_size { 5000000 };
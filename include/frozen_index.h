@@ -0,0 +1,222 @@
+#ifndef PANDORA_FROZEN_INDEX_H
+#define PANDORA_FROZEN_INDEX_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include "index.h"
+#include "index_file.h"
+#include "membership_filter.h"
+#include "minimal_perfect_hash.h"
+#include "prg/path.h"
+
+namespace fs = boost::filesystem;
+
+// counts of minimizer lookups in a FrozenIndex, e.g. to tune its membership filter
+struct IndexLookupStats {
+    uint64_t lookups { 0 };
+    uint64_t filtered { 0 }; // rejected by the membership filter
+    uint64_t masked { 0 }; // found, but masked
+    uint64_t hits { 0 }; // found, with records
+
+    // passed the membership filter, but were not in the index
+    uint64_t false_positives() const { return lookups - filtered - masked - hits; }
+
+    IndexLookupStats& operator+=(const IndexLookupStats& other);
+};
+
+std::ostream& operator<<(std::ostream& out, const IndexLookupStats& stats);
+
+// records are identified by 31-bit ids, the top bit being left to the records of hits
+// not found in an index (see MinimizerHitRecords)
+constexpr uint64_t MAX_NUMBER_OF_INDEX_RECORDS = (uint64_t)1 << 31;
+
+/**
+ * A read-only, flat (CSR) representation of an Index, built once indexing is done and
+ * queried when mapping reads.
+ * The keys are sorted and the records of the i-th key are
+ * records[offsets[i], offsets[i+1]). Records are packed and refer to their k-mer path
+ * by a handle into a table of interned paths. Minimizers are looked up with a minimal
+ * perfect hash function over the keys, whose slots hold the position of their key and
+ * a fingerprint of it, so most absent minimizers are rejected without reading the
+ * keys, and the records of a minimizer are contiguous.
+ * This is exactly the layout of binary index files (see index_file.h): binary indexes
+ * are used in place from their memory mapping, without being parsed. The prg::Path of
+ * an interned path is only built the first time a record refers to it.
+ * Masked keys, too frequent to be informative, are not found, although their records
+ * are kept. An optional membership filter of the other keys rejects most absent
+ * minimizers before they are looked up.
+ */
+class FrozenIndex {
+public:
+    // the records of a minimizer, contiguous in the record array
+    class RecordRange {
+    public:
+        RecordRange(const IndexFileRecord* first, const IndexFileRecord* last)
+            : first(first)
+            , last(last)
+        {
+        }
+        const IndexFileRecord* begin() const { return first; }
+        const IndexFileRecord* end() const { return last; }
+        bool empty() const { return first == last; }
+        size_t size() const { return last - first; }
+
+    private:
+        const IndexFileRecord* first;
+        const IndexFileRecord* last;
+    };
+
+    FrozenIndex();
+
+    // freezes the given index, which can then be discarded
+    explicit FrozenIndex(const Index& index);
+
+    // records point into the owned (or mapped) arrays, which can't be shared
+    FrozenIndex(const FrozenIndex& other) = delete;
+    FrozenIndex& operator=(const FrozenIndex& other) = delete;
+    FrozenIndex(FrozenIndex&& other) = default;
+    FrozenIndex& operator=(FrozenIndex&& other) = default;
+
+    // loads <prgfile>.kK.wW.idx, exits if it was built with a different w or k
+    void load(fs::path prgfile, uint32_t w, uint32_t k);
+
+    // maps a binary index file, or loads and freezes a text one
+    void load(const fs::path& indexfile);
+
+    void save(const fs::path& indexfile) const;
+
+    void clear();
+
+    // the records of the given key, none if the key is masked
+    RecordRange find(const uint64_t& key) const;
+
+    // same, counting the outcome of the lookup in stats
+    RecordRange find(const uint64_t& key, IndexLookupStats& stats) const;
+
+    // thread safe, the path being built if it is the first time it is used
+    const prg::Path& get_path(const IndexFileRecord& record) const
+    {
+        const prg::Path* path = paths.get(record.path_id);
+        return path != nullptr ? *path : build_path(record.path_id);
+    }
+
+    // records are identified by their position in the record array, e.g. by the hits
+    // stored on reads
+    uint32_t get_record_id(const IndexFileRecord& record) const
+    {
+        return (uint32_t)(&record - records);
+    }
+    const IndexFileRecord& get_record(const uint32_t& record_id) const
+    {
+        return records[record_id];
+    }
+
+    uint32_t get_w() const { return w; }
+    uint32_t get_k() const { return k; }
+    uint32_t get_prg_id_offset() const { return prg_id_offset; }
+    uint32_t get_num_prgs() const { return num_prgs; }
+    uint64_t number_of_keys() const { return num_keys; }
+    uint64_t number_of_records() const { return num_records; }
+    uint64_t number_of_paths() const { return paths.size(); }
+    uint64_t number_of_masked_keys() const { return num_masked_keys; }
+    uint32_t get_mask_above() const { return mask_above; }
+    double get_mask_top_fraction() const { return mask_top_fraction; }
+    bool has_membership_filter() const { return !membership_filter.empty(); }
+
+    // accessors to the flat arrays, mostly for iterating over the whole index
+    uint64_t get_key(const uint64_t& i) const { return keys[i]; }
+    bool is_masked(const uint64_t& i) const { return is_masked_key(masked, i); }
+    RecordRange get_records(const uint64_t& i) const
+    {
+        return RecordRange(records + offsets[i], records + offsets[i + 1]);
+    }
+
+private:
+    // the prg::Paths of the interned paths, built when first used, which several
+    // threads may do at once: the first path published is kept
+    class LazyPaths {
+    public:
+        LazyPaths() = default;
+        LazyPaths(LazyPaths&& other) noexcept;
+        LazyPaths& operator=(LazyPaths&& other) noexcept;
+        ~LazyPaths() { clear(); }
+
+        // none of the given number of paths is built
+        void reset(const uint64_t& number_of_paths);
+        void clear();
+        uint64_t size() const { return num_paths; }
+
+        // nullptr if the path was not built yet
+        const prg::Path* get(const uint64_t& i) const
+        {
+            return slots[i].load(std::memory_order_acquire);
+        }
+
+        // the given path, or the one another thread published first
+        const prg::Path* publish(
+            const uint64_t& i, std::unique_ptr<prg::Path> path) const;
+
+    private:
+        uint64_t num_paths { 0 };
+        std::unique_ptr<std::atomic<const prg::Path*>[]> slots;
+    };
+
+    uint32_t w;
+    uint32_t k;
+    uint32_t prg_id_offset;
+    uint32_t num_prgs;
+
+    uint64_t num_keys;
+    uint64_t num_records;
+    uint64_t num_intervals;
+    const uint64_t* keys;
+    const uint64_t* offsets;
+    const IndexFileRecord* records;
+    const uint64_t* path_offsets; // num_paths + 1 values
+    const Interval* intervals;
+    const uint64_t* masked; // a bit per key
+    uint64_t num_masked_keys;
+    uint32_t mask_above; // the cutoffs keys were masked with, see Index
+    double mask_top_fraction;
+
+    // backing storage of the arrays above: either owned, or a file mapping
+    std::vector<uint64_t> owned_keys;
+    std::vector<uint64_t> owned_offsets;
+    std::vector<IndexFileRecord> owned_records;
+    std::vector<uint64_t> owned_path_offsets;
+    std::vector<Interval> owned_intervals;
+    std::vector<uint64_t> owned_masked;
+    std::unique_ptr<MappedIndexFile> mapped_file;
+
+    // the interned paths, built from the interval table
+    LazyPaths paths;
+
+    // slots[mphf.lookup(key)] locates the key in keys
+    MinimalPerfectHash mphf;
+    const IndexFileSlot* slots;
+    std::vector<IndexFileSlot> owned_slots;
+
+    MembershipFilter membership_filter;
+
+    void load_binary(const fs::path& indexfile);
+
+    void point_to_owned_arrays();
+
+    void count_masked_keys();
+
+    // throws if there are too many records to identify them, see get_record_id()
+    void check_number_of_records() const;
+
+    const prg::Path& build_path(const uint32_t& path_id) const;
+
+    // hashes the keys, if they were not hashed in the index file
+    void build_mphf();
+
+    void build_membership_filter();
+};
+
+#endif // PANDORA_FROZEN_INDEX_H
@@ -13,6 +13,7 @@ struct GetVcfRefOptions {
     std::string prgfile;
     std::string seqfile;
     bool compress { false };
+    uint32_t threads { 1 };
     uint8_t verbosity { 0 };
 };
 
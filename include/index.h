@@ -5,6 +5,7 @@
 #include <cstdint>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <memory>
 #include <boost/filesystem.hpp>
 #include "minirecord.h"
@@ -13,12 +14,55 @@
 
 namespace fs = boost::filesystem;
 
+enum class IndexFormat {
+    Binary, // memory-mappable, see index_file.h
+    Text, // tab-separated, one minimizer per line
+};
+
+/**
+ * A minimizer found when sketching a PRG, before it is added to an Index. The path is
+ * the one of the minimizer's node in the PRG's KmerGraph, which must outlive this.
+ */
+struct SketchedMinimizer {
+    uint64_t kmer_hash; // the smallest hash of the canonicals
+    uint32_t prg_id;
+    uint32_t knode_id;
+    bool strand;
+    const prg::Path* path;
+
+    // by hash, then PRG, k-mer node and strand
+    bool operator<(const SketchedMinimizer& other) const;
+};
+
+// the default budget of LocalPRG::minimizer_sketch(): the number of k-mer paths it may
+// explore when sketching a PRG. Sketching takes time and memory in proportion to this
+// number, which can blow up combinatorially with nested sites
+constexpr uint64_t DEFAULT_MAX_SKETCH_PATHS = 20000000;
+
 class Index {
 public:
     std::unordered_map<uint64_t, std::vector<MiniRecord>*>
         minhash; // map of minimizers to MiniRecords - for each minimizer, records some
                  // information of it
 
+    // metadata stored in the header of binary index files - 0 if unknown
+    uint32_t w { 0 };
+    uint32_t k { 0 };
+    uint32_t prg_id_offset { 0 }; // id of the first PRG indexed
+    uint32_t num_prgs { 0 }; // number of PRGs indexed
+
+    // minimizers too frequent to be informative, which are not looked up when mapping
+    // reads although their records are kept - see mask_frequent_minimizers()
+    std::unordered_set<uint64_t> masked_minimizers;
+
+    // the strictest cutoffs minimizers were masked with - 0 if none. They are stored in
+    // binary index files, so that merged indexes are masked again with them
+    uint32_t mask_above { 0 };
+    double mask_top_fraction { 0 };
+
+    // whether to store a membership filter of the minimizers in binary index files
+    bool with_membership_filter { false };
+
     // declares all default constructors, destructors and assignment operators
     // explicitly
     Index() = default; // default constructor
@@ -31,22 +75,56 @@ public:
     void add_record(
         const uint64_t, const uint32_t, const prg::Path&, const uint32_t, const bool);
 
-    void save(const fs::path& prgfile, uint32_t w, uint32_t k);
+    // merges runs of minimizers, each sorted, into the index. Duplicated records are
+    // only added once, and records are only searched for duplicates in keys that were
+    // already in the index
+    void add_sorted_minimizers(const std::vector<std::vector<SketchedMinimizer>>& runs);
+
+    // logs statistics on the number of records of the minimizers, and masks those with
+    // more than max_records records and the top_fraction most frequent ones (0 disables
+    // either cutoff). Returns the number of minimizers masked
+    uint64_t mask_frequent_minimizers(
+        const uint32_t max_records, const double top_fraction);
+
+    void save(const fs::path& prgfile, uint32_t w, uint32_t k,
+        const IndexFormat& format = IndexFormat::Binary);
 
-    void save(const fs::path& indexfile);
+    void save(
+        const fs::path& indexfile, const IndexFormat& format = IndexFormat::Binary);
+
+    // merges this index into the given binary index file, which must index the PRGs
+    // just before the ones of this index, without loading the file into memory. The
+    // minimizers are masked again with the strictest cutoffs of the index file and of
+    // this index (see merge_index_files())
+    void append_to(const fs::path& indexfile) const;
 
     void load(fs::path prgfile, uint32_t w, uint32_t k);
 
+    // loads binary or text index files, adding their records to this index
     void load(const fs::path& indexfile);
 
     void clear();
 
+    // widens [prg_id_offset, prg_id_offset + num_prgs) to include the given PRGs
+    void add_prg_id_range(const uint32_t& first_prg_id, const uint32_t& number_of_prgs);
+
     bool operator==(const Index& other) const;
 
     bool operator!=(const Index& other) const;
+
+private:
+    void save_binary(const fs::path& indexfile) const;
+
+    void save_text(const fs::path& indexfile) const;
+
+    void load_binary(const fs::path& indexfile);
+
+    void load_text(const fs::path& indexfile);
 };
 
-void index_prgs(std::vector<std::shared_ptr<LocalPRG>>& prgs,
-    std::shared_ptr<Index>& index, uint32_t w, uint32_t k, const fs::path& outdir,
-    uint32_t threads = 1);
+// sketches the PRGs into the index, each one within a budget of max_sketch_paths (see
+// LocalPRG::minimizer_sketch()). Returns the ids of the PRGs over budget, in order
+std::vector<uint32_t> index_prgs(std::vector<std::shared_ptr<LocalPRG>>& prgs,
+    std::shared_ptr<Index>& index, uint32_t w, uint32_t k, uint32_t threads = 1,
+    uint64_t max_sketch_paths = DEFAULT_MAX_SKETCH_PATHS);
 #endif
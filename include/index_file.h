@@ -0,0 +1,266 @@
+#ifndef PANDORA_INDEX_FILE_H
+#define PANDORA_INDEX_FILE_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include "interval.h"
+#include "membership_filter.h"
+#include "minimal_perfect_hash.h"
+
+namespace fs = boost::filesystem;
+
+/**
+ * Binary, memory-mappable layout of a pandora index (.idx) file.
+ *
+ * The file starts with an IndexFileHeader, followed by num_sections
+ * IndexSectionEntry records describing where each section lives in the file. Every
+ * section is a plain array of fixed-size little-endian values starting at a 64-byte
+ * aligned offset, so a mapped file can be used in place without any parsing:
+ *  - Keys: the minimizer hashes, sorted in increasing order (uint64_t);
+ *  - Offsets: num_keys + 1 values, the records of key i are records[offsets[i],
+ *    offsets[i+1]) (uint64_t);
+ *  - Records: the MiniRecords of all keys, without their paths (IndexFileRecord);
+ *  - PathOffsets: num_paths + 1 values, the intervals of path j are
+ *    intervals[path_offsets[j], path_offsets[j+1]) (uint64_t);
+ *  - Intervals: the intervals of all the interned k-mer paths (Interval);
+ *  - MaskedKeys: optional, a bitset of num_keys bits in which bit i % 64 of word i / 64
+ *    is set if key i is masked: it is too frequent to be looked up, although its
+ *    records are kept (uint64_t). The cutoffs keys were masked with are in the header;
+ *  - MphfLevels, MphfBlocks and MphfLeftoverKeys: the arrays of a minimal perfect hash
+ *    function over the keys (MphfLevel, uint64_t and uint64_t, see
+ *    minimal_perfect_hash.h);
+ *  - MphfSlots: num_keys values, the key hashed to slot s by the minimal perfect hash
+ *    function is keys[slots[s].key_index] (IndexFileSlot).
+ * The last four sections are optional and go together: index files without them are
+ * hashed when loaded.
+ *  - MembershipFilter: optional, the words of a Bloom filter of the keys which are not
+ *    masked (uint64_t, see membership_filter.h).
+ * Identical k-mer paths (e.g. those at the same coordinates of different PRGs) are
+ * stored only once in the path table.
+ */
+constexpr char INDEX_FILE_MAGIC[8] = { 'P', 'A', 'N', 'D', 'I', 'D', 'X', '\0' };
+constexpr uint32_t INDEX_FILE_VERSION = 2;
+constexpr uint32_t INDEX_FILE_BYTE_ORDER_MARK = 0x01020304;
+constexpr uint64_t INDEX_FILE_SECTION_ALIGNMENT = 64;
+
+// how the keys of the index were computed from the k-mers
+enum class IndexHashScheme : uint32_t {
+    // minimap's invertible hash64() of the 2-bit encoded k-mer, min of both strands
+    Hash64Canonical = 1,
+};
+
+enum class IndexSection : uint32_t {
+    Keys = 1,
+    Offsets = 2,
+    Records = 3,
+    PathOffsets = 4,
+    Intervals = 5,
+    MaskedKeys = 6,
+    MphfLevels = 7,
+    MphfBlocks = 8,
+    MphfLeftoverKeys = 9,
+    MphfSlots = 10,
+    MembershipFilter = 11,
+};
+
+// the number of words of the bitset of masked keys
+constexpr uint64_t number_of_mask_words(const uint64_t num_keys)
+{
+    return (num_keys + 63) / 64;
+}
+
+inline bool is_masked_key(const uint64_t* masked, const uint64_t i)
+{
+    return (masked[i / 64] >> (i % 64)) & 1;
+}
+
+/**
+ * The number of records above which keys are masked: those with more than max_records
+ * records, and the top_fraction of the keys with the most records (0 disables either
+ * cutoff). Takes the sorted numbers of records of all the keys.
+ */
+uint32_t masked_keys_cutoff(const std::vector<uint32_t>& sorted_numbers_of_records,
+    const uint32_t max_records, const double top_fraction);
+
+struct IndexFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order_mark;
+    uint32_t w; // 0 if unknown (e.g. converted from a text index)
+    uint32_t k; // 0 if unknown (e.g. converted from a text index)
+    uint32_t hash_scheme;
+    uint32_t num_sections;
+    uint32_t prg_id_offset; // id of the first PRG in this index
+    uint32_t num_prgs; // number of PRGs indexed, from prg_id_offset onwards
+    uint64_t num_keys;
+    uint64_t num_records;
+    uint64_t num_paths;
+    uint64_t num_intervals;
+    // keys with more records than the cutoff of both are masked (0 disables either),
+    // see masked_keys_cutoff()
+    double mask_top_fraction;
+    uint32_t mask_above;
+    uint32_t reserved; // 0
+
+    IndexFileHeader();
+};
+
+struct IndexSectionEntry {
+    uint32_t id;
+    uint32_t element_size;
+    uint64_t offset; // in bytes, from the start of the file
+    uint64_t size; // in bytes
+};
+
+struct IndexFileRecord {
+    uint32_t prg_id;
+    uint32_t knode_id;
+    uint32_t path_id; // index into the path table
+    uint32_t strand;
+};
+
+struct IndexFileSlot {
+    uint32_t key_index;
+    uint32_t fingerprint; // MinimalPerfectHash::fingerprint() of the key
+};
+
+// the sections of an index file, as arrays pointing into its mapping
+struct IndexFileArrays {
+    uint64_t num_keys;
+    uint64_t num_records;
+    uint64_t num_paths;
+    uint64_t num_intervals;
+    const uint64_t* keys;
+    const uint64_t* offsets; // num_keys + 1 values
+    const IndexFileRecord* records;
+    const uint64_t* path_offsets; // num_paths + 1 values
+    const Interval* intervals;
+    const uint64_t* masked; // nullptr if no key is masked
+    // nullptr if the keys are not hashed
+    const MphfLevel* mphf_levels;
+    uint64_t num_mphf_levels;
+    const uint64_t* mphf_blocks;
+    uint64_t num_mphf_blocks;
+    const uint64_t* mphf_leftover_keys;
+    uint64_t num_mphf_leftover_keys;
+    const IndexFileSlot* mphf_slots;
+    const uint64_t* filter_words; // nullptr if there is no membership filter
+    uint64_t num_filter_words;
+};
+
+static_assert(sizeof(IndexFileHeader) == 88, "unexpected IndexFileHeader padding");
+static_assert(sizeof(IndexSectionEntry) == 24, "unexpected IndexSectionEntry padding");
+static_assert(sizeof(IndexFileRecord) == 16, "unexpected IndexFileRecord padding");
+static_assert(sizeof(IndexFileSlot) == 8, "unexpected IndexFileSlot padding");
+static_assert(sizeof(MphfLevel) == 16, "unexpected MphfLevel padding");
+static_assert(sizeof(Interval) == 8, "Interval must be two packed uint32_t");
+
+/**
+ * Checks if the given file starts with the binary index magic number.
+ */
+bool is_binary_index_file(const fs::path& filepath);
+
+/**
+ * Writes a binary index file section by section. The header and the section
+ * directory are written when the file is closed, once all sizes are known, so sections
+ * can be streamed out one after the other without being held in memory.
+ */
+class IndexFileWriter {
+public:
+    IndexFileWriter(const fs::path& filepath, const IndexFileHeader& header);
+    ~IndexFileWriter();
+
+    void begin_section(const IndexSection& id, const uint32_t& element_size);
+    void append(const void* data, const uint64_t& size);
+    void end_section();
+
+    template <typename T>
+    void write_section(const IndexSection& id, const std::vector<T>& values)
+    {
+        begin_section(id, sizeof(T));
+        append(values.data(), values.size() * sizeof(T));
+        end_section();
+    }
+
+    // replaces the header written on close(), e.g. once the number of keys is known.
+    // The number of sections can't change
+    void set_header(const IndexFileHeader& header);
+
+    void close();
+
+private:
+    fs::path filepath;
+    fs::ofstream handle;
+    IndexFileHeader header;
+    std::vector<IndexSectionEntry> sections;
+    bool in_section;
+    bool closed;
+
+    void pad_to_alignment();
+};
+
+/**
+ * Writes the MphfLevels, MphfBlocks, MphfLeftoverKeys and MphfSlots sections of a
+ * minimal perfect hash function over the keys of an index, and the slots of the keys.
+ */
+void write_mphf_sections(IndexFileWriter& writer, const MinimalPerfectHash& mphf,
+    const IndexFileSlot* slots);
+
+/**
+ * A read-only memory mapping of a binary index file. Sections are exposed as typed
+ * arrays pointing directly into the mapping, which lives as long as this object.
+ */
+class MappedIndexFile {
+public:
+    explicit MappedIndexFile(const fs::path& filepath);
+
+    const IndexFileHeader& header() const { return *header_ptr; }
+
+    bool has_section(const IndexSection& id) const;
+
+    template <typename T>
+    const T* section(const IndexSection& id, uint64_t& number_of_elements) const
+    {
+        const IndexSectionEntry& entry = find_section(id);
+        if (entry.element_size != sizeof(T)) {
+            throw std::runtime_error(
+                "Index section " + std::to_string((uint32_t)id) + " of "
+                + filepath.string() + " has an unexpected element size");
+        }
+        number_of_elements = entry.size / sizeof(T);
+        return reinterpret_cast<const T*>(file.data() + entry.offset);
+    }
+
+    // all the sections of the index, throws if they are inconsistent with each other
+    IndexFileArrays arrays() const;
+
+private:
+    fs::path filepath;
+    boost::iostreams::mapped_file_source file;
+    const IndexFileHeader* header_ptr;
+    const IndexSectionEntry* sections_ptr;
+
+    const IndexSectionEntry& find_section(const IndexSection& id) const;
+};
+
+/**
+ * Merges binary index files of disjoint sets of PRGs into a single binary index,
+ * streaming through the inputs in key order so that only the memory mappings of the
+ * inputs, and not their records, need to fit in memory. Path tables are concatenated
+ * rather than interned again. Keys are masked again according to their merged number
+ * of records, with the strictest masking cutoffs of the inputs, and keys masked in
+ * inputs without cutoffs stay masked. The minimal perfect hash function of the merged
+ * keys is built without holding them in memory, but its slots (8 bytes per key) are.
+ * The merged index has a membership filter if any input has one.
+ * Throws if the inputs were built with different w or k, or if their PRG id ranges
+ * overlap (see IndexOptions::id_offset).
+ */
+void merge_index_files(
+    const std::vector<fs::path>& indexfiles, const fs::path& outfile);
+
+#endif // PANDORA_INDEX_FILE_H
@@ -15,6 +15,9 @@
 
 #include "utils.h"
 #include "localPRG.h"
+#include "index.h"
+#include "index_file.h"
+#include "kmergraph_archive.h"
 #include "CLI11.hpp"
 
 /// Collection of all options of index subcommand.
@@ -24,7 +27,14 @@ struct IndexOptions {
     uint32_t kmer_size { 15 };
     uint32_t threads { 1 };
     uint32_t id_offset { 0 };
+    uint32_t max_minimizer_records { 0 };
+    double mask_top_fraction { 0 };
+    uint64_t max_sketch_paths { DEFAULT_MAX_SKETCH_PATHS };
+    bool membership_filter { false };
     fs::path outfile;
+    bool text_index { false };
+    bool append { false };
+    bool kmer_graphs_gfa { false };
     uint8_t verbosity { 0 };
 };
 
@@ -4,7 +4,8 @@
 
 #include <cstdint>
 #include <string> //cstring doesn't compile on mac here
-#include <unordered_map>
+#include <utility>
+#include <vector>
 
 uint32_t nt4(char);
 
@@ -12,12 +13,41 @@ uint64_t hash64(uint64_t key, const uint64_t& mask);
 
 void test_table();
 
+// the instruction sets hash_kmers() can use
+enum class KmerHashKernel { Scalar, SSE2, AVX2 };
+
+// the fastest kernel this CPU supports, found once at runtime
+KmerHashKernel best_kmer_hash_kernel();
+
+bool kmer_hash_kernel_supported(const KmerHashKernel& kernel);
+
+/**
+ * Encodes the letters of seq[0, length) and computes the hash64() of the forward and
+ * reverse complement k-mers at each position, as a k-mer would be hashed by adding its
+ * letters one by one: the k-mer starting at position i goes to forward_hashes[i] and
+ * reverse_hashes[i], which must have room for length - k + 1 values.
+ * Stops at the first non ACGT letter, so only the k-mers before it are hashed, and
+ * returns the number of letters before it (length if there is none).
+ * The letters are encoded and the k-mers hashed several at a time with the given
+ * kernel, by default the best one for this CPU, which must be supported.
+ */
+uint32_t hash_kmers(const char* seq, const uint32_t& length, const uint32_t& k,
+    uint64_t* forward_hashes, uint64_t* reverse_hashes,
+    const KmerHashKernel& kernel = best_kmer_hash_kernel());
+
+// hashes a k-mer as a sequence would be by hash_kmers(), skipping any non ACGT letter
 class KmerHash {
-    std::unordered_map<std::string, std::pair<uint64_t, uint64_t>>
-        lookup; // TODO: replace by GATB's MPHF? -> Hashes a string to two values due to
-                // forward and RC
 public:
     std::pair<uint64_t, uint64_t> kmerhash(const std::string& s, const uint32_t k);
 };
 
+/**
+ * The hashes of every k-mer of seq, as given by KmerHash::kmerhash() but rolled along
+ * seq with hash_kmers() (only the k-mers with non ACGT letters are hashed on their
+ * own): the k-mer starting at position i goes to forward_hashes[i] and
+ * reverse_hashes[i], which are resized to the number of k-mers.
+ */
+void hash_every_kmer(const std::string& seq, const uint32_t& k,
+    std::vector<uint64_t>& forward_hashes, std::vector<uint64_t>& reverse_hashes);
+
 #endif
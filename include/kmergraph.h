@@ -77,6 +77,7 @@ public:
     // friends
     friend struct condition;
     friend class KmerGraphWithCoverage;
+    friend class KmerGraphArchive;
 
     friend class KmerGraphWithCoverageTest_set_p_Test;
     friend class KmerGraphWithCoverageTest_prob_failNoNumReads_Test;
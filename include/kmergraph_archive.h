@@ -0,0 +1,141 @@
+#ifndef PANDORA_KMERGRAPH_ARCHIVE_H
+#define PANDORA_KMERGRAPH_ARCHIVE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include "interval.h"
+
+class KmerGraph;
+class LocalPRG;
+
+namespace fs = boost::filesystem;
+
+/**
+ * Binary, memory-mappable archive (.kga file) of the k-mer graphs of consecutive PRGs,
+ * written by pandora index instead of a GFA file per PRG.
+ *
+ * The file starts with a KmerGraphArchiveHeader, followed by five arrays, each one
+ * starting at a 64-byte aligned offset given in the header:
+ *  - Graphs: num_prgs + 1 entries, the offset table. The graph of the i-th PRG (of id
+ *    prg_id_offset + i) has nodes [graphs[i].first_node, graphs[i+1].first_node),
+ *    edges [graphs[i].first_edge, graphs[i+1].first_edge) and its PRG name is
+ *    names[graphs[i].first_name_char, graphs[i+1].first_name_char)
+ *    (KmerGraphArchiveEntry);
+ *  - PathOffsets: num_nodes + 1 values, the path of node j is
+ *    intervals[path_offsets[j], path_offsets[j+1]) (uint64_t);
+ *  - Intervals: the intervals of the paths of all nodes (Interval);
+ *  - Edges: the edges of each graph, between node ids local to the graph, in the order
+ *    in which they are added to the graph (KmerGraphArchiveEdge);
+ *  - Names: the names of the PRGs, without separators (char).
+ * Any graph can thus be loaded on its own, and graphs can be loaded in parallel.
+ */
+constexpr char KMERGRAPH_ARCHIVE_MAGIC[8] = { 'P', 'A', 'N', 'D', 'K', 'G', 'A', '\0' };
+constexpr uint32_t KMERGRAPH_ARCHIVE_VERSION = 1;
+constexpr uint32_t KMERGRAPH_ARCHIVE_BYTE_ORDER_MARK = 0x01020304;
+constexpr uint64_t KMERGRAPH_ARCHIVE_ALIGNMENT = 64;
+
+struct KmerGraphArchiveHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order_mark;
+    uint32_t w;
+    uint32_t k;
+    uint32_t prg_id_offset; // id of the first PRG in this archive
+    uint32_t num_prgs;
+    uint64_t num_nodes;
+    uint64_t num_intervals;
+    uint64_t num_edges;
+    uint64_t num_name_chars;
+    // in bytes, from the start of the file
+    uint64_t graphs_offset;
+    uint64_t path_offsets_offset;
+    uint64_t intervals_offset;
+    uint64_t edges_offset;
+    uint64_t names_offset;
+
+    KmerGraphArchiveHeader();
+};
+
+struct KmerGraphArchiveEntry {
+    uint64_t first_node;
+    uint64_t first_edge;
+    uint64_t first_name_char;
+};
+
+struct KmerGraphArchiveEdge {
+    uint32_t from;
+    uint32_t to;
+};
+
+static_assert(sizeof(KmerGraphArchiveHeader) == 104,
+    "unexpected KmerGraphArchiveHeader padding");
+static_assert(
+    sizeof(KmerGraphArchiveEntry) == 24, "unexpected KmerGraphArchiveEntry padding");
+static_assert(
+    sizeof(KmerGraphArchiveEdge) == 8, "unexpected KmerGraphArchiveEdge padding");
+
+/**
+ * The archive of the k-mer graphs of the PRGs of prgfile, from id_offset onwards: in
+ * the kmer_prgs directory next to prgfile, so that the archives of pieces of a PanRG
+ * indexed separately are found along with the one of the whole PanRG.
+ */
+fs::path kmer_graph_archive_file(const fs::path& prgfile, const uint32_t& w,
+    const uint32_t& k, const uint32_t& id_offset = 0);
+
+/**
+ * Writes the k-mer graphs of the given PRGs, which must have consecutive ids, to an
+ * archive. Throws if the file can't be written.
+ */
+void save_kmer_graph_archive(const fs::path& filepath,
+    const std::vector<std::shared_ptr<LocalPRG>>& prgs, const uint32_t& w,
+    const uint32_t& k);
+
+/**
+ * Checks that the PRGs of prgfile with the given names, from id_offset onwards, are
+ * those whose k-mer graphs were archived, e.g. before indexing the PRGs appended after
+ * them. Throws if a PRG is not in the archives of prgfile or has another name.
+ */
+void check_archived_prg_names(const fs::path& prgfile, const uint32_t& w,
+    const uint32_t& k, const uint32_t& id_offset,
+    const std::vector<std::string>& prg_names);
+
+/**
+ * A read-only memory mapping of a k-mer graph archive. The whole archive is checked
+ * when it is opened, so loading its graphs can't fail and is thread-safe.
+ */
+class KmerGraphArchive {
+public:
+    // throws if the file is not a valid archive
+    explicit KmerGraphArchive(const fs::path& filepath);
+
+    const KmerGraphArchiveHeader& header() const { return *header_ptr; }
+
+    // if the archive has the graph of a PRG of this id
+    bool contains(const uint32_t& prg_id) const;
+
+    // the name of the PRG of this id, which must be in the archive
+    std::string prg_name(const uint32_t& prg_id) const;
+
+    // replaces kmer_graph by the graph of the PRG of this id, which must be in the
+    // archive
+    void load(const uint32_t& prg_id, KmerGraph& kmer_graph) const;
+
+private:
+    fs::path filepath;
+    boost::iostreams::mapped_file_source file;
+    const KmerGraphArchiveHeader* header_ptr;
+    const KmerGraphArchiveEntry* graphs;
+    const uint64_t* path_offsets;
+    const Interval* intervals;
+    const KmerGraphArchiveEdge* edges;
+    const char* names;
+
+    template <typename T>
+    const T* array(const uint64_t& offset, const uint64_t& number_of_elements) const;
+};
+
+#endif // PANDORA_KMERGRAPH_ARCHIVE_H
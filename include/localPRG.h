@@ -6,6 +6,10 @@
 #include <vector>
 #include <iostream>
 #include <memory>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
 #include "interval.h"
 #include "index.h"
 #include "localgraph.h"
@@ -20,6 +24,48 @@
 using PanNodePtr = std::shared_ptr<pangenome::Node>;
 namespace fs = boost::filesystem;
 
+/**
+ * A flag set by the first of several threads calling call_once(). Unlike
+ * std::once_flag it can be copied, along with the object it belongs to: copies get
+ * their own lock.
+ */
+class CopyableOnceFlag {
+public:
+    explicit CopyableOnceFlag(bool done = false)
+        : done(done)
+    {
+    }
+    CopyableOnceFlag(const CopyableOnceFlag& other)
+        : done(other.is_done())
+    {
+    }
+    CopyableOnceFlag& operator=(const CopyableOnceFlag& other)
+    {
+        done.store(other.is_done());
+        return *this;
+    }
+
+    bool is_done() const { return done.load(std::memory_order_acquire); }
+
+    // calls f unless it has already been called, by this thread or another one. Other
+    // threads calling this at the same time wait for f to return
+    template <typename F> void call_once(F f)
+    {
+        if (is_done()) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!done.load(std::memory_order_relaxed)) {
+            f();
+            done.store(true, std::memory_order_release);
+        }
+    }
+
+private:
+    std::atomic<bool> done;
+    std::mutex mutex;
+};
+
 /**
  * Represents a PRG of the many given as input to pandora
  */
@@ -31,9 +77,26 @@ private:
                       // works only in a method, not an object variable
     std::vector<LocalNodePtr> nodes_along_path_core(const prg::Path&) const;
 
+    // memoized results of nodes_along_path(), only used when
+    // do_path_memoization_in_nodes_along_path_method is set - a LocalPRG is only ever
+    // sketched by one thread
+    mutable std::unordered_map<prg::Path, std::vector<LocalNodePtr>, PathHash>
+        nodes_along_path_memo;
+
+    // set once prg is built and kmer_prg is loaded, see materialize()
+    CopyableOnceFlag materialized;
+    std::function<void(KmerGraph&)> kmer_graph_loader;
+
+    void build_local_graph();
+
+    // the degraded sketch of PRGs exceeding the budget of minimizer_sketch()
+    void sketch_representative_paths(
+        std::vector<SketchedMinimizer>& minimizers, const uint32_t w, const uint32_t k);
+
 public:
     uint32_t next_site; // denotes the id of the next variant site to be processed -
                         // TODO: maybe this should not be an object variable
+    uint32_t site_nesting_depth; // 0 without sites, 1 if no site is nested in another
     uint32_t id; // id of this LocalPRG in the full graph (first gene is 0, second is 1,
                  // and so on...)
     std::string name; // name (fasta comment)
@@ -45,7 +108,23 @@ public:
 
     static bool do_path_memoization_in_nodes_along_path_method;
 
-    LocalPRG(uint32_t id, const std::string& name, const std::string& seq);
+    // a lazy LocalPRG only builds prg, and loads kmer_prg, when materialize() is
+    // first called, so that only the PRGs which reads hit cost time and memory
+    LocalPRG(uint32_t id, const std::string& name, const std::string& seq,
+        bool lazy = false);
+
+    // builds prg and loads kmer_prg with the loader given to set_kmer_graph_loader(),
+    // unless they already are. Thread-safe, and a no-op for PRGs which are not lazy
+    void materialize();
+
+    bool is_materialized() const { return materialized.is_done(); }
+
+    // a relative estimate of the cost of sketching this PRG, which grows with its
+    // length and number of nodes, and exponentially with the nesting of its sites
+    uint64_t sketch_cost() const;
+
+    // how materialize() loads kmer_prg, only for lazy PRGs not materialized yet
+    void set_kmer_graph_loader(const std::function<void(KmerGraph&)>& loader);
 
     // functions used to create LocalGraph from PRG string, and to sketch graph
     bool isalpha_string(const std::string&) const;
@@ -54,7 +133,7 @@ public:
 
     static std::string string_along_path(const std::vector<LocalNodePtr>&);
 
-    std::vector<LocalNodePtr> nodes_along_path(prg::Path&) const;
+    std::vector<LocalNodePtr> nodes_along_path(const prg::Path&) const;
 
     std::vector<Interval> split_by_site(const Interval&) const;
 
@@ -66,6 +145,15 @@ public:
     void minimizer_sketch(const std::shared_ptr<Index>& index, const uint32_t w,
         const uint32_t k, double percentageDone = -1.0);
 
+    // sketches this PRG into its kmer_prg, appending its minimizers to the given ones.
+    // If exploring the k-mer paths of the PRG takes more than max_paths of them (0 for
+    // no limit), only the k-mers along prg.representative_paths() are sketched instead,
+    // and false is returned: the k-mers of the combinations of alleles off these paths
+    // are missed, so reads of these combinations get fewer hits
+    bool minimizer_sketch(std::vector<SketchedMinimizer>& minimizers, const uint32_t w,
+        const uint32_t k, double percentageDone = -1.0,
+        const uint64_t max_paths = DEFAULT_MAX_SKETCH_PATHS);
+
     // functions used once hits have been collected against the PRG
     std::vector<KmerNodePtr> kmernode_path_from_localnode_path(
         const std::vector<LocalNodePtr>&) const;
@@ -132,7 +220,6 @@ public:
 
     // friends definitions
     friend std::ostream& operator<<(std::ostream& out, const LocalPRG& data);
-    friend class prg::Path; // for memoization
 };
 
 bool operator<(const std::pair<std::vector<LocalNodePtr>, float>& p1,
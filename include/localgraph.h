@@ -3,6 +3,8 @@
 
 #include <map>
 #include <vector>
+#include <functional>
+#include <unordered_map>
 #include <iostream>
 #include <cstring>
 #include <cstdint>
@@ -11,6 +13,14 @@
 #include "localnode.h"
 #include "IITree.h"
 
+// Whether walks of some length exist from the start of each node of a LocalGraph, keyed
+// by node id and length. It is valid while the graph does not change, so the walk
+// queries made while sketching a PRG can share it.
+typedef std::unordered_map<uint64_t, bool> WalkMemo;
+
+// called with each walk found, returns false to stop walking
+typedef std::function<bool(const prg::Path&)> WalkCallback;
+
 class LocalGraph {
 public:
     std::map<uint32_t, LocalNodePtr> nodes; // representing nodes in graph
@@ -32,9 +42,26 @@ public:
 
     std::vector<PathPtr> walk(const uint32_t&, const uint32_t&, const uint32_t&) const;
 
+    // Streams the walks of walk(), in the same order, to on_walk: a single path is
+    // extended and shortened along the graph, and nodes from which no walk of the
+    // remaining length exists are not explored. Returns false if on_walk stopped it.
+    bool walk(const uint32_t& node_id, const uint32_t& pos, const uint32_t& len,
+        const WalkCallback& on_walk, WalkMemo& memo) const;
+
+    bool walk(const uint32_t& node_id, const uint32_t& pos, const uint32_t& len,
+        const WalkCallback& on_walk) const;
+
+    // if walk() would find any walk
+    bool has_walk(const uint32_t& node_id, const uint32_t& pos, const uint32_t& len,
+        WalkMemo& memo) const;
+
     std::vector<PathPtr> walk_back(
         const uint32_t&, const uint32_t&, const uint32_t&) const;
 
+    // streams the walks of walk_back(), in the same order, as walk() does
+    bool walk_back(const uint32_t& node_id, const uint32_t& pos, const uint32_t& len,
+        const WalkCallback& on_walk) const;
+
     LocalNodePtr get_previous_node(const LocalNodePtr) const;
 
     std::vector<LocalNodePtr> nodes_along_string(
@@ -44,11 +71,33 @@ public:
 
     std::vector<LocalNodePtr> bottom_path() const;
 
+    // paths from the first to the last node which together go through every node: the
+    // first one is top_path(), each of the others goes through a node not on the
+    // previous ones, so there are at most as many paths as nodes
+    std::vector<std::vector<LocalNodePtr>> representative_paths() const;
+
     bool operator==(const LocalGraph& y) const;
 
     bool operator!=(const LocalGraph& y) const;
 
     friend std::ostream& operator<<(std::ostream& out, LocalGraph const& data);
+
+private:
+    bool has_walk_from_start(
+        const LocalNodePtr& node, const uint32_t& len, WalkMemo& memo) const;
+
+    bool walk(const uint32_t& node_id, const uint32_t& pos, const uint32_t& len,
+        std::vector<Interval>& intervals, prg::Path& path, const WalkCallback& on_walk,
+        WalkMemo& memo) const;
+
+    std::vector<LocalNodePtr> in_nodes(const uint32_t& node_id) const;
+
+    bool has_walk_back_from_end(
+        const LocalNodePtr& node, const uint32_t& len, WalkMemo& memo) const;
+
+    bool walk_back(const uint32_t& node_id, const uint32_t& pos, const uint32_t& len,
+        std::vector<Interval>& reversed_intervals, prg::Path& path,
+        const WalkCallback& on_walk, WalkMemo& memo) const;
 };
 
 #endif
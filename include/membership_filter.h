@@ -0,0 +1,56 @@
+#ifndef PANDORA_MEMBERSHIP_FILTER_H
+#define PANDORA_MEMBERSHIP_FILTER_H
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+ * A blocked Bloom filter (Putze et al., 2007) over a static set of 64-bit keys, used
+ * to reject most keys which are not in an index before looking them up. Each key
+ * sets NUM_PROBES bits in a single block of 512 bits, so a query reads a single cache
+ * line. With BITS_PER_KEY bits per key, about 1% of the keys not in the set pass the
+ * filter.
+ * A filter without any block, e.g. the one of an index which has none, lets every key
+ * pass.
+ */
+class MembershipFilter {
+public:
+    static constexpr uint64_t WORDS_PER_BLOCK = 8;
+    static constexpr uint64_t BITS_PER_KEY = 10;
+    static constexpr uint32_t NUM_PROBES = 7;
+
+    // calls the given callback on each key of a set
+    typedef std::function<void(const std::function<void(const uint64_t&)>&)>
+        KeyIterator;
+
+    // a filter letting every key pass
+    MembershipFilter();
+
+    // builds a filter over num_keys keys, iterated over by for_each_key
+    MembershipFilter(const uint64_t& num_keys, const KeyIterator& for_each_key);
+
+    // uses the words of an index file, which must outlive this
+    MembershipFilter(const uint64_t* words, const uint64_t& num_words);
+
+    // the words point into the owned vector, which can't be shared
+    MembershipFilter(const MembershipFilter& other) = delete;
+    MembershipFilter& operator=(const MembershipFilter& other) = delete;
+    MembershipFilter(MembershipFilter&& other) = default;
+    MembershipFilter& operator=(MembershipFilter&& other) = default;
+
+    // false if the key is certainly not in the set
+    bool may_contain(const uint64_t& key) const;
+
+    bool empty() const { return num_blocks == 0; }
+
+    const uint64_t* get_words() const { return words; }
+    uint64_t get_num_words() const { return num_blocks * WORDS_PER_BLOCK; }
+
+private:
+    const uint64_t* words;
+    uint64_t num_blocks;
+    std::vector<uint64_t> owned_words;
+};
+
+#endif // PANDORA_MEMBERSHIP_FILTER_H
@@ -9,6 +9,8 @@
 
 #include "utils.h"
 #include "localPRG.h"
+#include "index.h"
+#include "index_file.h"
 #include "CLI11.hpp"
 
 namespace fs = boost::filesystem;
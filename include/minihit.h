@@ -3,9 +3,16 @@
 
 #include <ostream>
 #include <cstdint>
+#include <limits>
 #include "minimizer.h"
 #include "minirecord.h"
 
+struct FlatMinimizerHit;
+
+// the record id of hits which were not found in a FrozenIndex, e.g. built from a
+// MiniRecord
+constexpr uint32_t NO_RECORD_ID = std::numeric_limits<uint32_t>::max();
+
 /**
  * Describes a hit between a read an a minimizer from the PRG
  * TODO: Possible improvement (memory): here we have one MinimizerHit for each (read_id,
@@ -21,23 +28,38 @@ private:
         read_start_position; // TODO: Possible improvement (memory): this can be made a
                              // template and change depending on the maximum read length
     bool read_strand;
-    const MiniRecord& minimizer_from_PRG;
+    bool prg_strand;
+    uint32_t prg_id;
+    uint32_t knode_id;
+    uint32_t record_id; // of the record hit, in the FrozenIndex if found in one
+    const prg::Path& prg_path; // owned by the index the minimizer was found in
 
 public:
     inline uint32_t get_read_id() const { return read_id; }
     inline uint32_t get_read_start_position() const { return read_start_position; }
-    inline uint32_t get_prg_id() const { return minimizer_from_PRG.prg_id; }
-    inline const prg::Path& get_prg_path() const { return minimizer_from_PRG.path; }
-    inline uint32_t get_kmer_node_id() const { return minimizer_from_PRG.knode_id; }
+    inline uint32_t get_prg_id() const { return prg_id; }
+    inline const prg::Path& get_prg_path() const { return prg_path; }
+    inline uint32_t get_kmer_node_id() const { return knode_id; }
+    inline uint32_t get_record_id() const { return record_id; }
+    inline bool get_read_strand() const { return read_strand; }
+    inline bool get_prg_strand() const { return prg_strand; }
     inline bool is_forward() const
     {
-        return read_strand == minimizer_from_PRG.strand;
+        return read_strand == prg_strand;
     } // TODO: the name of this method is very misleading, should be same_strands() or
       // sth like this
 
     MinimizerHit(const uint32_t i, const Minimizer& minimizer_from_read,
         const MiniRecord& minimizer_from_PRG);
 
+    // a hit against a record of a FrozenIndex, whose paths are stored apart
+    MinimizerHit(const uint32_t i, const Minimizer& minimizer_from_read,
+        const uint32_t prg_id, const prg::Path& prg_path, const uint32_t knode_id,
+        const bool prg_strand, const uint32_t record_id = NO_RECORD_ID);
+
+    // a hit collected by MinimizerHits
+    explicit MinimizerHit(const FlatMinimizerHit& hit);
+
     bool operator<(const MinimizerHit& y) const;
 
     bool operator==(const MinimizerHit& y) const;
@@ -0,0 +1,88 @@
+#ifndef PANDORA_MINIHIT_RECORDS_H
+#define PANDORA_MINIHIT_RECORDS_H
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <utility>
+#include "minihit.h"
+#include "prg/path.h"
+
+class FrozenIndex;
+
+// a MinimizerHit as stored on its read: the read is implied, and the record it hit is
+// identified by its id in the MinimizerHitRecords of the pangenome graph
+struct CompactMinimizerHit {
+    uint32_t read_start_position;
+    uint32_t record_id;
+    bool read_strand;
+};
+
+/**
+ * The records hit by the reads of a pangenome graph, by 32-bit id: the ids of the
+ * records of the FrozenIndex the reads were mapped against, and, with the top bit set,
+ * ids given to the records of other hits, e.g. of MiniRecords in tests, which are
+ * copied here.
+ * Reads store their hits as CompactMinimizerHits, which are expanded into
+ * MinimizerHits, referring to the paths of the records, when they are used.
+ * Like the graph, it is not thread safe.
+ */
+class MinimizerHitRecords {
+public:
+    static constexpr uint32_t ADDED_RECORD_BIT = (uint32_t)1 << 31;
+
+    // the index must outlive the reads, as hits refer to its paths
+    explicit MinimizerHitRecords(std::shared_ptr<const FrozenIndex> index = nullptr);
+
+    void set_index(std::shared_ptr<const FrozenIndex> index);
+
+    // the hit without its read id, copying its record if it is not one of the index
+    CompactMinimizerHit compact(const MinimizerHit& hit);
+
+    // the ids given to copied records are not those of an index, so the hits expanded
+    // from them have NO_RECORD_ID, e.g. to be compacted by the records of another graph
+    MinimizerHit expand(const uint32_t read_id, const CompactMinimizerHit& hit) const;
+
+    uint32_t get_prg_id(const CompactMinimizerHit& hit) const;
+
+    bool is_forward(const CompactMinimizerHit& hit) const;
+
+    // order the hits of a read as MinimizerHit::operator< and operator== do, without
+    // expanding them: by a key of their PRG, strand (forward first) and read position,
+    // then by the paths of their records only if they have the same key
+    bool less(const CompactMinimizerHit& lhs, const CompactMinimizerHit& rhs) const;
+    bool equal(const CompactMinimizerHit& lhs, const CompactMinimizerHit& rhs) const;
+
+    uint64_t number_of_added_records() const { return added_records.size(); }
+
+    // whether the hits compacted by these records are valid in the other records too,
+    // as they are all of the same index
+    bool shares_ids_with(const MinimizerHitRecords& other) const
+    {
+        return added_records.empty() and index == other.index;
+    }
+
+private:
+    struct AddedRecord {
+        uint32_t prg_id;
+        uint32_t knode_id;
+        bool strand;
+        prg::Path path;
+    };
+
+    static bool is_added(const uint32_t record_id)
+    {
+        return (record_id & ADDED_RECORD_BIT) != 0;
+    }
+
+    std::pair<uint32_t, uint64_t> sort_key(const CompactMinimizerHit& hit) const;
+
+    const prg::Path& get_path(const CompactMinimizerHit& hit) const;
+
+    std::shared_ptr<const FrozenIndex> index;
+    std::deque<AddedRecord> added_records; // not moved as they are added
+};
+
+typedef std::shared_ptr<MinimizerHitRecords> MinimizerHitRecordsPtr;
+
+#endif // PANDORA_MINIHIT_RECORDS_H
@@ -4,8 +4,10 @@
 #include <set>
 #include <unordered_set>
 #include <memory>
+#include <vector>
 #include "minimizer.h"
 #include "minirecord.h"
+#include "minihit.h"
 
 struct MinimizerHit;
 struct pComp;
@@ -36,19 +38,57 @@ struct clusterComp_size {
     bool operator()(const MinimizerHitCluster lhs, const MinimizerHitCluster rhs);
 };
 
+/**
+ * A hit as collected by MinimizerHits: plain data, so that the hits of a read are
+ * stored and sorted in a flat buffer without allocating each of them
+ */
+struct FlatMinimizerHit {
+    uint32_t read_id;
+    uint32_t read_start_position;
+    uint32_t prg_id;
+    uint32_t knode_id;
+    uint32_t record_id; // of the record hit, in the FrozenIndex if found in one
+    bool read_strand;
+    bool prg_strand;
+    const prg::Path* prg_path; // owned by the index the minimizer was found in
+
+    bool is_forward() const { return read_strand == prg_strand; }
+};
+
+/**
+ * The hits of reads against an index. Hits are appended to a flat buffer, which is
+ * reused from read to read, and sort() orders them once as MinimizerHit::operator<
+ * does, for clustering
+ */
 class MinimizerHits {
 public:
     MinimizerHits() = default;
     ~MinimizerHits() = default;
 
-    std::set<MinimizerHitPtr, pComp> hits;
+    std::vector<FlatMinimizerHit> hits;
 
     void add_hit(const uint32_t i, const Minimizer& minimizer_from_read,
         const MiniRecord& minimizer_from_PRG);
 
+    void add_hit(const uint32_t i, const Minimizer& minimizer_from_read,
+        const uint32_t prg_id, const prg::Path& prg_path, const uint32_t knode_id,
+        const bool prg_strand, const uint32_t record_id = NO_RECORD_ID);
+
+    // sorts the hits by read, PRG, strand (forward first), read position then PRG
+    // path, with a radix sort, and removes the duplicates
+    void sort();
+
+    // the hits in [begin, end) as a cluster, e.g. all of them. Each hit is allocated
+    // as a MinimizerHit, so only the clusters kept should be built
+    MinimizerHitCluster cluster(const size_t begin, const size_t end) const;
+
+    MinimizerHitCluster cluster() const { return cluster(0, hits.size()); }
+
+    // keeps the memory of the buffers, to be reused for the next read
     void clear() { hits.clear(); }
 
-    // friend std::ostream &operator<<(std::ostream &out, const MinimizerHits &m);
+private:
+    std::vector<FlatMinimizerHit> sort_buffer;
 };
 
 #endif
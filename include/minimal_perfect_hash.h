@@ -0,0 +1,97 @@
+#ifndef PANDORA_MINIMAL_PERFECT_HASH_H
+#define PANDORA_MINIMAL_PERFECT_HASH_H
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// a level of a MinimalPerfectHash, as stored in index files
+struct MphfLevel {
+    uint64_t first_bit; // position of the first bit of this level in the bit array
+    uint64_t num_bits;
+};
+
+/**
+ * A minimal perfect hash function over a static set of 64-bit keys, built with the
+ * BBHash algorithm (Limasset et al., 2017) used by GATB's MPHF: a cascade of bit
+ * arrays, where each key is placed in the first level in which it does not collide
+ * with any other key not placed yet. The hash of a key is the rank of its bit among
+ * the set bits of all levels, so the n keys are mapped to [0, n) without collisions.
+ * The few keys not placed after MAX_LEVELS levels are kept in a sorted array.
+ * Other keys are mapped to an arbitrary value, possibly n or more, so callers must
+ * check that the key stored at the returned position is the one looked up.
+ * The bits of all levels are stored in blocks of 8 words, the first one counting the
+ * bits set before the block, so that testing a level and ranking its bit reads a
+ * single cache line.
+ */
+class MinimalPerfectHash {
+public:
+    static constexpr uint32_t MAX_LEVELS = 32;
+    static constexpr uint64_t WORDS_PER_BLOCK = 8;
+    static constexpr uint64_t BITS_PER_BLOCK = (WORDS_PER_BLOCK - 1) * 64;
+
+    // calls the given callback on each key of a set, in the same order every time
+    typedef std::function<void(const std::function<void(const uint64_t&)>&)>
+        KeyIterator;
+
+    MinimalPerfectHash();
+
+    // builds the function over the given distinct keys
+    MinimalPerfectHash(const uint64_t* keys, const uint64_t& num_keys);
+
+    // builds the function over num_keys distinct keys, iterated over by for_each_key a
+    // few times, so that they don't need to be held in memory
+    MinimalPerfectHash(const uint64_t& num_keys, const KeyIterator& for_each_key);
+
+    // uses arrays read from an index file, which must outlive this
+    MinimalPerfectHash(const uint64_t& num_keys, const MphfLevel* levels,
+        const uint64_t& num_levels, const uint64_t* blocks, const uint64_t& num_blocks,
+        const uint64_t* leftover_keys, const uint64_t& num_leftover_keys);
+
+    // the arrays point into the owned vectors, which can't be shared
+    MinimalPerfectHash(const MinimalPerfectHash& other) = delete;
+    MinimalPerfectHash& operator=(const MinimalPerfectHash& other) = delete;
+    MinimalPerfectHash(MinimalPerfectHash&& other) = default;
+    MinimalPerfectHash& operator=(MinimalPerfectHash&& other) = default;
+
+    // in [0, size()) for the keys of the set, arbitrary for other keys
+    uint64_t lookup(const uint64_t& key) const;
+
+    uint64_t size() const { return num_keys; }
+
+    // a hash of the key independent of the one of the levels, to be stored next to
+    // the keys so that most other keys are rejected without reading the keys
+    static uint32_t fingerprint(const uint64_t& key);
+
+    // the arrays, e.g. to save them
+    const MphfLevel* get_levels() const { return levels; }
+    uint64_t get_num_levels() const { return num_levels; }
+    const uint64_t* get_blocks() const { return blocks; }
+    uint64_t get_num_blocks() const { return num_blocks; }
+    const uint64_t* get_leftover_keys() const { return leftover_keys; }
+    uint64_t get_num_leftover_keys() const { return num_leftover_keys; }
+
+private:
+    uint64_t num_keys;
+    const MphfLevel* levels;
+    uint64_t num_levels;
+    const uint64_t* blocks;
+    uint64_t num_blocks;
+    const uint64_t* leftover_keys; // sorted
+    uint64_t num_leftover_keys;
+    uint64_t num_placed_keys; // in the levels
+
+    std::vector<MphfLevel> owned_levels;
+    std::vector<uint64_t> owned_blocks;
+    std::vector<uint64_t> owned_leftover_keys;
+
+    void build(const KeyIterator& for_each_key);
+
+    void point_to_owned_arrays();
+
+    bool is_set(const uint64_t& bit) const;
+
+    uint64_t rank(const uint64_t& bit) const;
+};
+
+#endif // PANDORA_MINIMAL_PERFECT_HASH_H
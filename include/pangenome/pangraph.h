@@ -15,6 +15,7 @@ class KmerNode;
 #include <boost/filesystem.hpp>
 
 #include "minihits.h"
+#include "minihit_records.h"
 #include "localPRG.h"
 #include "pangenome/ns.cpp"
 
@@ -38,6 +39,8 @@ public:
     // TODO: move all attributes to private
     std::map<ReadId, ReadPtr> reads;
     std::unordered_map<NodeId, NodePtr> nodes;
+    // the records hit by the reads, e.g. those of the index they were mapped against
+    MinimizerHitRecordsPtr hit_records;
 
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     // declares all default constructors, destructors and assignment operators
@@ -98,6 +101,18 @@ public:
         std::set<MinimizerHitPtr, pComp>& cluster // the cluster itself
     );
 
+    /**
+     * Same, for a cluster of hits already compacted by the hit records of this graph,
+     * and sorted as their MinimizerHits are, e.g. kept by a GraphShard.
+     * @param prg
+     * @param read_id
+     * @param first : the first hit of the cluster
+     * @param last : past the last hit of the cluster
+     */
+    void add_hits_between_PRG_and_read(const std::shared_ptr<LocalPRG>& prg,
+        const uint32_t read_id, const CompactMinimizerHit* first,
+        const CompactMinimizerHit* last);
+
     /**
      * Adds hits between the given PRG and sample described as a path of minimizer kmers
      * from the consensus path. This is just used in the global pangraph in pandora
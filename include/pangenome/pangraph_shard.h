@@ -0,0 +1,49 @@
+#ifndef __PANGRAPH_SHARD_H_INCLUDED__ // if pangraph_shard.h hasn't been included yet...
+#define __PANGRAPH_SHARD_H_INCLUDED__
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "minihits.h"
+#include "minihit_records.h"
+#include "pangenome/ns.cpp"
+
+class FrozenIndex;
+class LocalPRG;
+
+/**
+ * The clusters of hits of the reads mapped by a thread, kept compact until all reads
+ * are mapped and the shards are merged into the pangenome graph, which takes the
+ * compact hits as they are if they are of the same index. Merging adds the
+ * clusters read by read, in the order of the read ids, so the graph is the same
+ * whichever thread mapped each read, and the threads don't wait on each other to add
+ * their reads to it.
+ */
+class pangenome::GraphShard {
+public:
+    // the hits must be found in the given index, if any
+    explicit GraphShard(std::shared_ptr<const FrozenIndex> index = nullptr);
+
+    // the clusters of a read must be added in the order of the read
+    void add_cluster(const MinimizerHitCluster& cluster);
+
+    size_t number_of_clusters() const { return clusters.size(); }
+
+    // adds the clusters of the shards to the graph and clears the shards
+    static void merge(std::vector<GraphShard>& shards, Graph& graph,
+        const std::vector<std::shared_ptr<LocalPRG>>& prgs);
+
+private:
+    // the hits of a cluster are hits[first_hit, first_hit of the next cluster)
+    struct Cluster {
+        uint32_t read_id;
+        uint32_t prg_id;
+        uint64_t first_hit;
+    };
+
+    std::vector<Cluster> clusters;
+    std::vector<CompactMinimizerHit> hits;
+    MinimizerHitRecords hit_records;
+};
+
+#endif
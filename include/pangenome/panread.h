@@ -8,27 +8,36 @@
 #include <unordered_map>
 #include <minihit.h>
 #include "minihits.h"
+#include "minihit_records.h"
 #include "pangenome/ns.cpp"
 
 class pangenome::Read {
 private:
-    // TODO: derive this from MinimizerHits?
-    // TODO: or maybe keep it here but without the read id, since it is duplicated?
-    std::vector<MinimizerHit*> hits; // store all Minimizer Hits mapping to this read
+    // the records hit, shared by the reads of a graph
+    MinimizerHitRecordsPtr hit_records;
+    // store all Minimizer Hits mapping to this read, compacted, in the order of their
+    // MinimizerHits
+    std::vector<CompactMinimizerHit> hits;
     std::vector<WeakNodePtr> nodes;
 
+    // merges the hits appended from before_size on, sorted, with the hits already
+    // there, and adds the node if the read didn't just go through it
+    void merge_added_hits(const NodePtr& node_ptr, const size_t before_size);
+
 public:
     const uint32_t id; // read id
     std::vector<bool> node_orientations;
 
     // constructor/destructors
     Read(const uint32_t);
-    virtual ~Read();
+    Read(const uint32_t, MinimizerHitRecordsPtr hit_records);
+    virtual ~Read() = default;
+
+    // the hits against the given prg, expanded from the compact ones stored
+    std::vector<MinimizerHit> get_hits(const uint32_t prg_id) const;
 
     // TODO: this can be a source of time inneficiency at the cost of using less memory
-    // TODO: check if we should fallback to representing hits as
-    // std::unordered_map<uint32_t, std::vector<MinimizerHitPtr>> directly
-    std::unordered_map<uint32_t, std::vector<MinimizerHitPtr>>
+    std::unordered_map<uint32_t, std::vector<MinimizerHit>>
     get_hits_as_unordered_map() const;
 
     const std::vector<WeakNodePtr>& get_nodes() const { return nodes; }
@@ -57,6 +66,11 @@ public:
     void add_hits(
         const NodePtr& node_ptr, const std::set<MinimizerHitPtr, pComp>& cluster);
 
+    // same, for hits compacted by the hit records of this read and sorted as their
+    // MinimizerHits are, e.g. those of a cluster
+    void add_hits(const NodePtr& node_ptr, const CompactMinimizerHit* first,
+        const CompactMinimizerHit* last);
+
     std::pair<uint32_t, uint32_t> find_position(const std::vector<uint_least32_t>&,
         const std::vector<bool>&, const uint16_t min_overlap = 1);
 
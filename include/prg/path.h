@@ -15,81 +15,45 @@ typedef std::shared_ptr<LocalNode>
     LocalNodePtr; // TODO: this is replicated from localnode.h and I really don't like
                   // it, fix
 
+// A path through a LocalPRG, as a sequence of intervals. This is a plain value type:
+// the nodes along a path are memoized by the LocalPRG the path belongs to (see
+// LocalPRG::nodes_along_path()), so that the many copies of k-mer paths held by the
+// index and the k-mer graphs only cost their intervals.
 class prg::Path {
 private:
     std::vector<Interval>
         path; // the interval path - we control acess to this variable now
 
-    // variables for memoization:
-    bool isMemoized; // flag that indicated if the first memoization was already done
-    std::vector<LocalNodePtr> memoizedLocalNodePath; // the memoized local node path
-    bool memoizedDirty; // was this path modified and thus memoizedLocalNodePath needs
-                        // to be recomputed?
-    uint32_t localPRGIdOfMemoizedLocalNodePath; // just to make sure we don't memoize
-                                                // one interval for one localPRG and
-                                                // return it to a different localPRg
-
 public:
     // constructors
-    Path()
-        : path {}
-        , isMemoized { false }
-        , memoizedLocalNodePath {}
-        , memoizedDirty { true }
-        , localPRGIdOfMemoizedLocalNodePath { 0 }
-    {
-    } // default constructor
+    Path() = default; // default constructor
     Path(const Path& other) = default; // copy default constructor
-    Path(Path&& other)
-    { // move constructor
-        *this = std::move(other);
-    }
+    Path(Path&& other) = default; // move default constructor
 
     // assignment operators
     Path& operator=(const Path& other) = default; // copy assignment operator
-    Path& operator=(Path&& other)
-    {
-        if (this != &other) {
-            this->path = std::move(other.path);
-            this->isMemoized = std::move(other.isMemoized);
-            this->memoizedLocalNodePath = std::move(other.memoizedLocalNodePath);
-            this->memoizedDirty = std::move(other.memoizedDirty);
-            this->localPRGIdOfMemoizedLocalNodePath
-                = std::move(other.localPRGIdOfMemoizedLocalNodePath);
-        }
-        return *this;
-    }
+    Path& operator=(Path&& other) = default; // move assignment operator
 
     // destructor
-    virtual ~Path() = default;
+    ~Path() = default;
 
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    // DIRTY METHODS - THAT CAN MODIFY path - memoization must be redone
+    // DIRTY METHODS - THAT CAN MODIFY path
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     // delegated std::vector methods
-    void push_back(const Interval& interval)
-    {
-        memoizedDirty = true;
-        path.push_back(interval);
-    }
+    void push_back(const Interval& interval) { path.push_back(interval); }
 
-    void clear()
-    {
-        memoizedDirty = true;
-        path.clear();
-    }
+    void clear() { path.clear(); }
 
     // add all intervals in the given range to the end of the path
     template <class Iterator>
     void insert_to_the_end(const Iterator& begin, const Iterator& end)
     {
-        memoizedDirty = true;
         path.insert(path.end(), begin, end);
     }
 
     Interval getAndRemoveLastInterval()
     {
-        memoizedDirty = true;
         Interval interval = path.back();
         path.pop_back();
         return interval;
@@ -103,7 +67,6 @@ public:
     void initialize(
         const Iterator& begin, const Iterator& end, uint32_t reservedSize = 16)
     {
-        memoizedDirty = true;
         path.clear();
         path.reserve(reservedSize);
         insert_to_the_end(begin, end);
@@ -113,7 +76,6 @@ public:
     // code initialize with a single interval
     void initialize(const Interval& i)
     {
-        memoizedDirty = true;
         std::vector<Interval> vectorOfInterval = { i };
         initialize(vectorOfInterval.begin(), vectorOfInterval.end());
     }
@@ -125,16 +87,11 @@ public:
         if (container.empty())
             return;
         */
-        memoizedDirty = true;
         initialize(container.begin(), container.end(), container.size() + 5);
     }
 
     // initializes from a previous path
-    void initialize(const prg::Path& p)
-    {
-        memoizedDirty = true;
-        initialize(p.path);
-    }
+    void initialize(const prg::Path& p) { initialize(p.path); }
 
     // add an interval to the end
     void add_end_interval(const Interval&);
@@ -144,8 +101,7 @@ public:
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    // CONST METHODS - THAT CANNOT MODIFY path - memoization does not need to be redone
-    // in these cases
+    // CONST METHODS - THAT CANNOT MODIFY path
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     // delegated std::vector methods
     bool empty() const { return path.empty(); }
@@ -191,12 +147,6 @@ public:
     // CONST METHODS - THAT CANNOT MODIFY path
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    // MEMOIZATION METHOD
-    // the method responsible for memoization itself
-    std::vector<LocalNodePtr> nodes_along_path(const LocalPRG& localPrg);
-    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     // friend methods
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -214,6 +164,11 @@ public:
 
 bool equal_except_null_nodes(const prg::Path&, const prg::Path&);
 
+// hashes the intervals along a path, so that paths can be used in unordered containers
+struct PathHash {
+    size_t operator()(const prg::Path& path) const;
+};
+
 typedef std::shared_ptr<prg::Path> PathPtr;
 struct ComparePathPtr {
     bool operator()(const PathPtr& p1, const PathPtr& p2) const
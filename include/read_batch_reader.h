@@ -0,0 +1,76 @@
+#ifndef PANDORA_READ_BATCH_READER_H
+#define PANDORA_READ_BATCH_READER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct FastaqHandler;
+
+constexpr uint32_t DEFAULT_READ_BATCH_SIZE = 1000;
+constexpr uint32_t DEFAULT_READ_QUEUE_DEPTH = 4;
+
+// consecutive reads of a file, the i-th having id first_id + i
+struct ReadBatch {
+    uint32_t first_id { 0 };
+    uint32_t size { 0 };
+    // their strings are reused from batch to batch, so only the first size are reads
+    std::vector<std::string> names;
+    std::vector<std::string> reads;
+};
+
+/**
+ * Reads a fasta/q file, possibly gzipped, in a thread of its own, into batches of
+ * reads handed to the threads processing them, so that they don't wait for the file
+ * to be inflated and parsed. The reader fills at most queue_depth batches ahead of
+ * them, and batches are recycled once processed, so their strings are reused.
+ */
+class ReadBatchReader {
+public:
+    // starts reading the file, throws if it can't be opened
+    explicit ReadBatchReader(const std::string& filepath,
+        const uint32_t batch_size = DEFAULT_READ_BATCH_SIZE,
+        const uint32_t queue_depth = DEFAULT_READ_QUEUE_DEPTH);
+
+    ReadBatchReader(const ReadBatchReader& other) = delete;
+    ReadBatchReader& operator=(const ReadBatchReader& other) = delete;
+
+    // stops reading, e.g. if the reads after those processed are not needed
+    ~ReadBatchReader();
+
+    // swaps the given batch, whose reads were processed, for the next batch of reads,
+    // waiting for it if needed. Returns false once all reads were handed out, and
+    // rethrows the errors met reading the file. Thread safe
+    bool next_batch(ReadBatch& batch);
+
+    // the number of reads handed out
+    uint32_t number_of_reads() const;
+
+private:
+    const uint32_t batch_size;
+    const uint32_t queue_depth;
+
+    std::unique_ptr<FastaqHandler> fh; // used by the reader thread only
+
+    mutable std::mutex mutex;
+    std::condition_variable batch_ready;
+    std::condition_variable queue_has_room;
+    std::deque<ReadBatch> ready_batches;
+    std::vector<ReadBatch> free_batches;
+    uint32_t num_reads_handed_out { 0 };
+    bool finished { false };
+    bool stopped { false };
+    std::exception_ptr error;
+
+    std::thread reader;
+
+    void read_batches();
+};
+
+#endif // PANDORA_READ_BATCH_READER_H
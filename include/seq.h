@@ -3,7 +3,7 @@
 
 #include <string>
 #include <cstdint>
-#include <set>
+#include <vector>
 #include <ostream>
 #include "minimizer.h"
 
@@ -12,7 +12,10 @@ public:
     uint32_t id;
     std::string name;
     std::string seq;
-    std::set<Minimizer> sketch;
+    std::vector<Minimizer> sketch; // sorted, without duplicates
+    // non ACGT letters, which the k-mers of the sketch skip (0 if the read is too short
+    // to be sketched)
+    uint32_t number_ambiguous_bases;
 
     Seq(uint32_t, const std::string&, const std::string&, uint32_t, uint32_t);
 
@@ -21,18 +24,19 @@ public:
     void initialize(
         uint32_t, const std::string&, const std::string&, uint32_t, uint32_t);
 
-    bool add_letter_to_get_next_kmer(const char&, const uint64_t&, const uint64_t&,
-        uint32_t&, uint64_t (&)[2], uint64_t (&)[2]);
-
-    void add_minimizing_kmers_to_sketch(const std::vector<Minimizer>&, const uint64_t&);
-
-    void minimize_window(std::vector<Minimizer>&, uint64_t&);
-
-    void add_new_smallest_minimizer(std::vector<Minimizer>&, uint64_t&);
-
     void minimizer_sketch(const uint32_t w, const uint32_t k);
 
     friend std::ostream& operator<<(std::ostream& out, const Seq& data);
+
+private:
+    template <uint32_t W, uint32_t K>
+    void minimizer_sketch_of_sizes(const uint32_t any_w, const uint32_t any_k);
+
+    // ring buffer of the k-mers of the current window which can still minimize it or
+    // a later window, kept to reuse its memory when the Seq is reinitialized
+    std::vector<Minimizer> window;
+    // hashes of the forward and reverse complement k-mers of the read, reused likewise
+    std::vector<uint64_t> forward_hashes, reverse_hashes;
 };
 
 #endif
@@ -20,6 +20,7 @@ struct Seq2PathOptions {
     bool top { false };
     bool bottom { false };
     bool flag { false };
+    uint32_t threads { 1 };
     uint8_t verbosity { 0 };
 };
 
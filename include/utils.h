@@ -10,6 +10,7 @@
 #include <limits>
 #include <boost/filesystem/path.hpp>
 #include "minihits.h"
+#include "read_batch_reader.h"
 #include "pangenome/ns.cpp"
 
 namespace fs = boost::filesystem;
@@ -22,6 +23,9 @@ enum class Strand {
 }
 class Index;
 
+class FrozenIndex;
+struct IndexLookupStats;
+
 class PanNode;
 
 class LocalPRG;
@@ -65,15 +69,33 @@ std::string rev_complement(std::string);
 float lognchoosek2(uint32_t, uint32_t, uint32_t);
 
 // probably should be moved to map_main.cpp
+// reads the PRGs of the file, numbered from id. The first number_of_prgs_to_skip PRGs
+// are not read, although they still take their ids, and their names are added to
+// skipped_prg_names if given. Lazy PRGs only build their graphs once materialized (see
+// LocalPRG::materialize()). The PRGs are built on the given number of threads, with
+// the same ids and order as with a single one
 void read_prg_file(std::vector<std::shared_ptr<LocalPRG>>& prgs,
-    const fs::path& filepath, uint32_t id = 0);
-
+    const fs::path& filepath, uint32_t id = 0, uint32_t number_of_prgs_to_skip = 0,
+    bool lazy = false, uint32_t threads = 1,
+    std::vector<std::string>* skipped_prg_names = nullptr);
+
+// writes the k-mer graph of each PRG as a GFA file in kmer_prgs_dir, in directories of
+// 4000 files by PRG id
+void save_PRG_kmergraphs_as_gfa(const std::vector<std::shared_ptr<LocalPRG>>& prgs,
+    const uint32_t& w, const uint32_t& k, const fs::path& kmer_prgs_dir,
+    uint32_t threads = 1);
+
+// loads the k-mer graphs of the PRGs from the k-mer graph archives next to prgfile,
+// those of the PRG file first, or else from their GFA files. The graphs of lazy PRGs
+// are only loaded once they are materialized
 void load_PRG_kmergraphs(std::vector<std::shared_ptr<LocalPRG>>& prgs,
-    const uint32_t& w, const uint32_t& k, const fs::path& prgfile);
+    const uint32_t& w, const uint32_t& k, const fs::path& prgfile,
+    uint32_t threads = 1);
 
 void load_vcf_refs_file(const fs::path& filepath, VCFRefs& vcf_refs);
 
-void add_read_hits(const Seq&, const std::shared_ptr<MinimizerHits>&, const Index&);
+void add_read_hits(const Seq&, const std::shared_ptr<MinimizerHits>&,
+    const FrozenIndex&, IndexLookupStats* lookup_stats = nullptr);
 
 void define_clusters(std::set<std::set<MinimizerHitPtr, pComp>, clusterComp>&,
     const std::vector<std::shared_ptr<LocalPRG>>&, std::shared_ptr<MinimizerHits>,
@@ -90,12 +112,21 @@ void infer_localPRG_order_for_reads(const std::vector<std::shared_ptr<LocalPRG>>
     const uint32_t expected_number_kmers_in_short_read_sketch
     = std::numeric_limits<uint32_t>::max());
 
+// same, keeping the clusters in the shard of the calling thread
+void infer_localPRG_order_for_reads(const std::vector<std::shared_ptr<LocalPRG>>& prgs,
+    std::shared_ptr<MinimizerHits> minimizer_hits, pangenome::GraphShard&, const int,
+    const float&, const uint32_t min_cluster_size = 10,
+    const uint32_t expected_number_kmers_in_short_read_sketch
+    = std::numeric_limits<uint32_t>::max());
+
 uint32_t pangraph_from_read_file(const std::string&, std::shared_ptr<pangenome::Graph>,
-    std::shared_ptr<Index>, const std::vector<std::shared_ptr<LocalPRG>>&,
+    std::shared_ptr<FrozenIndex>, const std::vector<std::shared_ptr<LocalPRG>>&,
     const uint32_t, const uint32_t, const int, const float&,
     const uint32_t min_cluster_size = 10, const uint32_t genome_size = 5000000,
     const bool illumina = false, const bool clean = false,
-    const uint32_t max_covg = 300, uint32_t threads = 1);
+    const uint32_t max_covg = 300, uint32_t threads = 1,
+    const uint32_t read_batch_size = DEFAULT_READ_BATCH_SIZE,
+    const uint32_t read_queue_depth = DEFAULT_READ_QUEUE_DEPTH);
 
 //, const uint32_t, const float&, bool);
 void infer_most_likely_prg_path_for_pannode(
@@ -14,6 +14,7 @@ struct WalkOptions {
     std::string seqfile;
     bool top { false };
     bool bottom { false };
+    uint32_t threads { 1 };
 };
 
 void setup_walk_subcommand(CLI::App& app);
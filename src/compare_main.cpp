@@ -49,6 +49,22 @@ void setup_compare_subcommand(CLI::App& app)
         ->capture_default_str()
         ->group("Input/Output");
 
+    compare_subcmd
+        ->add_option("--read-batch-size", opt->read_batch_size,
+            "Number of reads handed to a thread at once")
+        ->type_name("INT")
+        ->capture_default_str()
+        ->check(CLI::PositiveNumber.description(""))
+        ->group("Input/Output");
+
+    compare_subcmd
+        ->add_option("--read-queue-depth", opt->read_queue_depth,
+            "Maximum number of batches of reads read ahead of the threads")
+        ->type_name("INT")
+        ->capture_default_str()
+        ->check(CLI::PositiveNumber.description(""))
+        ->group("Input/Output");
+
     description = "Fasta file with a reference sequence to use for each loci. The "
                   "sequence MUST have a perfect match in <TARGET> and the same name";
     compare_subcmd->add_option("--vcf-refs", opt->vcf_refs_file, description)
@@ -248,11 +264,13 @@ int pandora_compare(CompareOptions& opt)
         false);
 
     BOOST_LOG_TRIVIAL(info) << "Loading Index and LocalPRGs from file...";
-    auto index = std::make_shared<Index>();
+    auto index = std::make_shared<FrozenIndex>();
     index->load(opt.prgfile, opt.window_size, opt.kmer_size);
     std::vector<std::shared_ptr<LocalPRG>> prgs;
-    read_prg_file(prgs, opt.prgfile);
-    load_PRG_kmergraphs(prgs, opt.window_size, opt.kmer_size, opt.prgfile);
+    // the graphs of a PRG are only built once reads hit it
+    read_prg_file(prgs, opt.prgfile, 0, 0, true, opt.threads);
+    load_PRG_kmergraphs(
+        prgs, opt.window_size, opt.kmer_size, opt.prgfile, opt.threads);
 
     BOOST_LOG_TRIVIAL(info) << "Loading read index file...";
     auto samples = load_read_index(opt.reads_idx_file);
@@ -280,7 +298,7 @@ int pandora_compare(CompareOptions& opt)
         uint32_t covg = pangraph_from_read_file(sample_fpath, pangraph_sample, index,
             prgs, opt.window_size, opt.kmer_size, opt.max_diff, opt.error_rate,
             opt.min_cluster_size, opt.genome_size, opt.illumina, opt.clean,
-            opt.max_covg, opt.threads);
+            opt.max_covg, opt.threads, opt.read_batch_size, opt.read_queue_depth);
 
         const auto pangraph_gfa { sample_outdir / "pandora.pangraph.gfa" };
         BOOST_LOG_TRIVIAL(info) << "Writing pangenome::Graph to file " << pangraph_gfa;
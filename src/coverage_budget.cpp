@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <thread>
+#include <boost/log/trivial.hpp>
+#include "coverage_budget.h"
+
+CoverageBudget::CoverageBudget(const uint64_t genome_size, const uint32_t max_covg)
+    : max_bases { ((uint64_t)max_covg + 1) * genome_size - 1 }
+    , reserved { 0 }
+    , held { 0 }
+    , consumed { 0 }
+    , draining { false }
+    , exceeded { false }
+{
+}
+
+uint64_t CoverageBudget::reserve_up_to(const uint64_t bases)
+{
+    uint64_t current = reserved.load();
+    uint64_t granted;
+    do {
+        if (current >= max_bases) {
+            return 0;
+        }
+        granted = std::min(bases, max_bases - current);
+    } while (not reserved.compare_exchange_weak(current, current + granted));
+    return granted;
+}
+
+CoverageBudget::Reservation::Reservation(CoverageBudget& budget)
+    : budget(budget)
+{
+}
+
+CoverageBudget::Reservation::~Reservation() { release(); }
+
+void CoverageBudget::Reservation::reserve(const uint64_t bases)
+{
+    if (available < bases and not budget.draining.load()) {
+        // counted as held first, so that a draining thread waits for these bases
+        const uint64_t wanted = bases - available;
+        budget.held.fetch_add(wanted);
+        const uint64_t bases_granted = budget.reserve_up_to(wanted);
+        budget.held.fetch_sub(wanted - bases_granted);
+        available += bases_granted;
+        granted += bases_granted;
+    }
+}
+
+bool CoverageBudget::Reservation::consume(const uint64_t read_length)
+{
+    if (budget.is_exceeded()) {
+        return false;
+    }
+    if (not budget.draining.load()) {
+        reserve(read_length);
+        if (available >= read_length) {
+            available -= read_length;
+            consumed += read_length;
+            if (available == 0) {
+                give_back(); // holds nothing a draining thread could wait for
+            }
+            return true;
+        }
+        budget.draining.store(true);
+    }
+
+    // the budget is nearly spent: the read is reserved on its own once the other
+    // threads have given back what they hold, if it fits
+    give_back();
+    while (not budget.is_exceeded()) {
+        uint64_t current = budget.reserved.load();
+        if (current + read_length <= budget.max_bases) {
+            if (budget.reserved.compare_exchange_weak(
+                    current, current + read_length)) {
+                consumed += read_length;
+                return true;
+            }
+        } else if (budget.held.load() == 0) {
+            // this read exceeds the maximum coverage, unless another thread's read
+            // did first
+            if (not budget.exceeded.exchange(true)) {
+                consumed += read_length;
+                BOOST_LOG_TRIVIAL(warning)
+                    << "Stop processing reads as have reached max coverage";
+            }
+            return false;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    return false;
+}
+
+void CoverageBudget::Reservation::give_back()
+{
+    if (available > 0) {
+        budget.reserved.fetch_sub(available);
+        available = 0;
+    }
+    if (granted > 0) {
+        budget.held.fetch_sub(granted);
+        granted = 0;
+    }
+}
+
+void CoverageBudget::Reservation::release()
+{
+    give_back();
+    if (consumed > 0) {
+        budget.consumed.fetch_add(consumed);
+        consumed = 0;
+    }
+}
@@ -255,52 +255,26 @@ PileupConstructionMap Discover::pileup_construction_map(
 
 void Discover::load_candidate_region_pileups(
     const fs::path& reads_filepath, const CandidateRegions& candidate_regions,
-    const PileupConstructionMap& pileup_construction_map, uint32_t threads)
+    const PileupConstructionMap& pileup_construction_map, uint32_t threads,
+    const uint32_t read_batch_size, const uint32_t read_queue_depth)
 {
     if (candidate_regions.empty() or pileup_construction_map.empty())
         return;
 
-    const uint32_t nb_reads_to_map_in_a_batch = 1000; // nb of reads to map in a batch
-
-    // shared variables - controlled by critical(ReadFileMutex)
-    FastaqHandler fh(reads_filepath.string());
-    uint32_t id { 0 };
+    // reads the file in a thread of its own, ahead of the threads building pileups
+    ReadBatchReader reader(reads_filepath.string(), read_batch_size, read_queue_depth);
 
 // parallel region
-// TODO: this is duplicated code with pangraph_from_read_file(), refactor
 #pragma omp parallel num_threads(threads)
     {
         // will hold the reads batch
-        std::vector<std::pair<uint32_t, std::string>> sequencesBuffer(
-            nb_reads_to_map_in_a_batch, make_pair(0, ""));
-        while (true) {
-            // read the next batch of reads
-            uint32_t nbOfReads = 0;
-
-// read the reads in batch
-#pragma omp critical(ReadFileMutex)
-            {
+        ReadBatch batch;
+        while (reader.next_batch(batch)) {
+            // process the reads of the batch
+            for (uint32_t i = 0; i < batch.size; i++) {
                 // TODO: we need to read only until the max read id
-                for (auto& id_and_sequence : sequencesBuffer) {
-                    try {
-                        fh.get_next();
-                    } catch (std::out_of_range& err) {
-                        break;
-                    }
-                    id_and_sequence = make_pair(id, fh.read);
-                    ++nbOfReads;
-                    ++id;
-                }
-            }
-
-            if (nbOfReads == 0)
-                break; // we reached the end of the file, nothing else to map
-
-            // process nbOfReads reads
-            for (uint32_t i = 0; i < nbOfReads; i++) {
-                uint32_t id;
-                std::string sequence;
-                std::tie(id, sequence) = sequencesBuffer[i];
+                const uint32_t id = batch.first_id + i;
+                const std::string& sequence = batch.reads[i];
 
                 auto pileup_construction_map_iterator
                     = pileup_construction_map.find(id);
@@ -94,10 +94,15 @@ PathComponents find_interval_and_flanks_in_localpath(const Interval& interval,
     return found_components;
 }
 
-std::vector<MinimizerHitPtr> find_hits_inside_path(
-    const std::vector<MinimizerHitPtr>& read_hits, const prg::Path& local_path)
+namespace {
+const MinimizerHit& as_hit(const MinimizerHitPtr& hit) { return *hit; }
+const MinimizerHit& as_hit(const MinimizerHit& hit) { return hit; }
+
+template <typename Hit>
+std::vector<Hit> hits_inside_path(
+    const std::vector<Hit>& read_hits, const prg::Path& local_path)
 {
-    std::vector<MinimizerHitPtr> hits_inside_local_path;
+    std::vector<Hit> hits_inside_local_path;
 
     if (local_path.empty()) {
         return hits_inside_local_path;
@@ -105,7 +110,8 @@ std::vector<MinimizerHitPtr> find_hits_inside_path(
 
     for (const auto& current_read_hit : read_hits) {
         for (const auto& interval : local_path) {
-            const auto& prg_path_of_current_read_hit = current_read_hit->get_prg_path();
+            const auto& prg_path_of_current_read_hit
+                = as_hit(current_read_hit).get_prg_path();
             const auto hit_is_to_left_of_path_start { interval.start
                 > prg_path_of_current_read_hit.get_end() };
             const auto hit_is_to_right_of_current_interval { interval.get_end()
@@ -124,6 +130,19 @@ std::vector<MinimizerHitPtr> find_hits_inside_path(
 
     return hits_inside_local_path;
 }
+}
+
+std::vector<MinimizerHitPtr> find_hits_inside_path(
+    const std::vector<MinimizerHitPtr>& read_hits, const prg::Path& local_path)
+{
+    return hits_inside_path(read_hits, local_path);
+}
+
+std::vector<MinimizerHit> find_hits_inside_path(
+    const std::vector<MinimizerHit>& read_hits, const prg::Path& local_path)
+{
+    return hits_inside_path(read_hits, local_path);
+}
 
 ReadCoordinate::ReadCoordinate(
     uint32_t id, uint32_t start, uint32_t end, bool is_forward)
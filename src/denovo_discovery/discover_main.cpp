@@ -51,6 +51,22 @@ void setup_discover_subcommand(CLI::App& app)
         ->capture_default_str()
         ->group("Input/Output");
 
+    discover_subcmd
+        ->add_option("--read-batch-size", opt->read_batch_size,
+            "Number of reads handed to a thread at once")
+        ->type_name("INT")
+        ->capture_default_str()
+        ->check(CLI::PositiveNumber.description(""))
+        ->group("Input/Output");
+
+    discover_subcmd
+        ->add_option("--read-queue-depth", opt->read_queue_depth,
+            "Maximum number of batches of reads read ahead of the threads")
+        ->type_name("INT")
+        ->capture_default_str()
+        ->check(CLI::PositiveNumber.description(""))
+        ->group("Input/Output");
+
     discover_subcmd
         ->add_option(
             "-e,--error-rate", opt->error_rate, "Estimated error rate for reads")
@@ -223,11 +239,13 @@ int pandora_discover(DiscoverOptions& opt)
     }
 
     BOOST_LOG_TRIVIAL(info) << "Loading Index and LocalPRGs from file...";
-    auto index = std::make_shared<Index>();
+    auto index = std::make_shared<FrozenIndex>();
     index->load(opt.prgfile, opt.window_size, opt.kmer_size);
     std::vector<std::shared_ptr<LocalPRG>> prgs;
-    read_prg_file(prgs, opt.prgfile);
-    load_PRG_kmergraphs(prgs, opt.window_size, opt.kmer_size, opt.prgfile);
+    // the graphs of a PRG are only built once reads hit it
+    read_prg_file(prgs, opt.prgfile, 0, 0, true, opt.threads);
+    load_PRG_kmergraphs(
+        prgs, opt.window_size, opt.kmer_size, opt.prgfile, opt.threads);
 
     BOOST_LOG_TRIVIAL(info)
         << "Constructing pangenome::Graph from read file (this will take a while)...";
@@ -235,7 +253,7 @@ int pandora_discover(DiscoverOptions& opt)
     uint32_t covg = pangraph_from_read_file(opt.readsfile.string(), pangraph, index,
         prgs, opt.window_size, opt.kmer_size, opt.max_diff, opt.error_rate,
         opt.min_cluster_size, opt.genome_size, opt.illumina, opt.clean, opt.max_covg,
-        opt.threads);
+        opt.threads, opt.read_batch_size, opt.read_queue_depth);
 
     if (pangraph->nodes.empty()) {
         BOOST_LOG_TRIVIAL(info) << "Found none of the LocalPRGs in the reads.";
@@ -336,8 +354,9 @@ int pandora_discover(DiscoverOptions& opt)
     const auto pileup_construction_map
         = discover.pileup_construction_map(candidate_regions);
 
-    discover.load_candidate_region_pileups(
-        opt.readsfile, candidate_regions, pileup_construction_map, opt.threads);
+    discover.load_candidate_region_pileups(opt.readsfile, candidate_regions,
+        pileup_construction_map, opt.threads, opt.read_batch_size,
+        opt.read_queue_depth);
 
     // remove the nodes marked as to be removed
     for (const auto& node_to_remove : nodes_to_remove) {
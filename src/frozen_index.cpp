@@ -0,0 +1,397 @@
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+
+#include <boost/log/trivial.hpp>
+
+#include "frozen_index.h"
+
+IndexLookupStats& IndexLookupStats::operator+=(const IndexLookupStats& other)
+{
+    lookups += other.lookups;
+    filtered += other.filtered;
+    masked += other.masked;
+    hits += other.hits;
+    return *this;
+}
+
+std::ostream& operator<<(std::ostream& out, const IndexLookupStats& stats)
+{
+    return out << stats.lookups << " minimizer lookups: " << stats.hits << " hits, "
+               << stats.masked << " masked, " << stats.filtered
+               << " rejected by the membership filter and " << stats.false_positives()
+               << " other misses";
+}
+
+FrozenIndex::FrozenIndex()
+    : w { 0 }
+    , k { 0 }
+    , prg_id_offset { 0 }
+    , num_prgs { 0 }
+    , num_keys { 0 }
+    , num_records { 0 }
+    , num_intervals { 0 }
+    , num_masked_keys { 0 }
+    , mask_above { 0 }
+    , mask_top_fraction { 0 }
+    , owned_offsets { 0 }
+    , owned_path_offsets { 0 }
+{
+    point_to_owned_arrays();
+    build_mphf();
+}
+
+FrozenIndex::FrozenIndex(const Index& index)
+    : w { index.w }
+    , k { index.k }
+    , prg_id_offset { index.prg_id_offset }
+    , num_prgs { index.num_prgs }
+    , mask_above { index.mask_above }
+    , mask_top_fraction { index.mask_top_fraction }
+    , owned_path_offsets { 0 }
+{
+    owned_keys.reserve(index.minhash.size());
+    uint64_t number_of_records = 0;
+    for (const auto& entry : index.minhash) {
+        owned_keys.push_back(entry.first);
+        number_of_records += entry.second->size();
+    }
+    std::sort(owned_keys.begin(), owned_keys.end());
+
+    owned_offsets.reserve(owned_keys.size() + 1);
+    owned_records.reserve(number_of_records);
+    std::unordered_map<prg::Path, uint32_t, PathHash> path_ids;
+
+    for (const auto& key : owned_keys) {
+        owned_offsets.push_back(owned_records.size());
+        const auto first_record_of_key = owned_records.size();
+        for (const auto& record : *index.minhash.at(key)) {
+            // intern the path of this record in the path table
+            const auto inserted = path_ids.emplace(record.path, path_ids.size());
+            if (inserted.second) {
+                owned_intervals.insert(
+                    owned_intervals.end(), record.path.begin(), record.path.end());
+                owned_path_offsets.push_back(owned_intervals.size());
+            }
+            owned_records.push_back(IndexFileRecord { record.prg_id, record.knode_id,
+                inserted.first->second, record.strand });
+        }
+        // the order in which records were added depends on thread scheduling
+        std::sort(owned_records.begin() + first_record_of_key, owned_records.end(),
+            [](const IndexFileRecord& lhs, const IndexFileRecord& rhs) {
+                return std::tie(lhs.prg_id, lhs.knode_id, lhs.strand)
+                    < std::tie(rhs.prg_id, rhs.knode_id, rhs.strand);
+            });
+    }
+    owned_offsets.push_back(owned_records.size());
+
+    owned_masked.assign(number_of_mask_words(owned_keys.size()), 0);
+    if (!index.masked_minimizers.empty()) {
+        for (uint64_t i = 0; i < owned_keys.size(); ++i) {
+            if (index.masked_minimizers.count(owned_keys[i])) {
+                owned_masked[i / 64] |= 1ull << (i % 64);
+            }
+        }
+    }
+
+    point_to_owned_arrays();
+    paths.reset(owned_path_offsets.size() - 1);
+    build_mphf();
+    if (index.with_membership_filter) {
+        build_membership_filter();
+    }
+}
+
+void FrozenIndex::point_to_owned_arrays()
+{
+    mapped_file.reset();
+    num_keys = owned_keys.size();
+    num_records = owned_records.size();
+    num_intervals = owned_intervals.size();
+    keys = owned_keys.data();
+    offsets = owned_offsets.data();
+    records = owned_records.data();
+    path_offsets = owned_path_offsets.data();
+    intervals = owned_intervals.data();
+    masked = owned_masked.data();
+    count_masked_keys();
+    check_number_of_records();
+}
+
+void FrozenIndex::count_masked_keys()
+{
+    num_masked_keys = 0;
+    for (uint64_t i = 0; i < num_keys; ++i) {
+        num_masked_keys += is_masked(i);
+    }
+}
+
+void FrozenIndex::check_number_of_records() const
+{
+    if (num_records > MAX_NUMBER_OF_INDEX_RECORDS) {
+        throw std::runtime_error("Too many records to identify in the index");
+    }
+}
+
+FrozenIndex::LazyPaths::LazyPaths(LazyPaths&& other) noexcept
+    : num_paths { other.num_paths }
+    , slots { std::move(other.slots) }
+{
+    other.num_paths = 0;
+}
+
+FrozenIndex::LazyPaths& FrozenIndex::LazyPaths::operator=(LazyPaths&& other) noexcept
+{
+    if (this != &other) {
+        clear();
+        num_paths = other.num_paths;
+        slots = std::move(other.slots);
+        other.num_paths = 0;
+    }
+    return *this;
+}
+
+void FrozenIndex::LazyPaths::reset(const uint64_t& number_of_paths)
+{
+    clear();
+    num_paths = number_of_paths;
+    slots.reset(new std::atomic<const prg::Path*>[num_paths]);
+    for (uint64_t i = 0; i < num_paths; ++i) {
+        slots[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+void FrozenIndex::LazyPaths::clear()
+{
+    for (uint64_t i = 0; i < num_paths; ++i) {
+        delete slots[i].load(std::memory_order_relaxed);
+    }
+    num_paths = 0;
+    slots.reset();
+}
+
+const prg::Path* FrozenIndex::LazyPaths::publish(
+    const uint64_t& i, std::unique_ptr<prg::Path> path) const
+{
+    const prg::Path* published = nullptr;
+    if (slots[i].compare_exchange_strong(published, path.get(),
+            std::memory_order_acq_rel, std::memory_order_acquire)) {
+        return path.release();
+    }
+    return published;
+}
+
+const prg::Path& FrozenIndex::build_path(const uint32_t& path_id) const
+{
+    std::unique_ptr<prg::Path> path(new prg::Path());
+    path->initialize(intervals + path_offsets[path_id],
+        intervals + path_offsets[path_id + 1],
+        path_offsets[path_id + 1] - path_offsets[path_id]);
+    return *paths.publish(path_id, std::move(path));
+}
+
+void FrozenIndex::build_mphf()
+{
+    if (num_keys > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("Too many keys to hash in the index");
+    }
+    mphf = MinimalPerfectHash(keys, num_keys);
+    owned_slots.resize(num_keys);
+    for (uint64_t i = 0; i < num_keys; ++i) {
+        owned_slots[mphf.lookup(keys[i])]
+            = IndexFileSlot { (uint32_t)i, MinimalPerfectHash::fingerprint(keys[i]) };
+    }
+    slots = owned_slots.data();
+}
+
+void FrozenIndex::build_membership_filter()
+{
+    membership_filter = MembershipFilter(num_keys - num_masked_keys,
+        [this](const std::function<void(const uint64_t&)>& callback) {
+            for (uint64_t i = 0; i < num_keys; ++i) {
+                if (!is_masked(i)) {
+                    callback(keys[i]);
+                }
+            }
+        });
+}
+
+FrozenIndex::RecordRange FrozenIndex::find(const uint64_t& key) const
+{
+    IndexLookupStats stats;
+    return find(key, stats);
+}
+
+FrozenIndex::RecordRange FrozenIndex::find(
+    const uint64_t& key, IndexLookupStats& stats) const
+{
+    ++stats.lookups;
+    if (!membership_filter.may_contain(key)) {
+        ++stats.filtered;
+        return RecordRange(records, records);
+    }
+    const uint64_t slot = mphf.lookup(key);
+    if (slot >= num_keys
+        or slots[slot].fingerprint != MinimalPerfectHash::fingerprint(key)) {
+        return RecordRange(records, records);
+    }
+    const uint64_t i = slots[slot].key_index;
+    if (keys[i] != key) {
+        return RecordRange(records, records);
+    }
+    if (is_masked(i)) {
+        ++stats.masked;
+        return RecordRange(records, records);
+    }
+    ++stats.hits;
+    return get_records(i);
+}
+
+void FrozenIndex::load(fs::path prgfile, uint32_t w, uint32_t k)
+{
+    const auto ext { ".k" + std::to_string(k) + ".w" + std::to_string(w) + ".idx" };
+    prgfile += ext;
+    load(prgfile);
+
+    if ((this->w != 0 and this->w != w) or (this->k != 0 and this->k != k)) {
+        BOOST_LOG_TRIVIAL(error) << "Index file " << prgfile << " was built with w="
+                                 << this->w << " and k=" << this->k
+                                 << ", but w=" << w << " and k=" << k << " were asked";
+        exit(1);
+    }
+}
+
+void FrozenIndex::load(const fs::path& indexfile)
+{
+    BOOST_LOG_TRIVIAL(debug) << "Loading index";
+    BOOST_LOG_TRIVIAL(debug) << "File is " << indexfile;
+
+    if (!fs::exists(indexfile)) {
+        BOOST_LOG_TRIVIAL(warning) << "Unable to open index file " << indexfile
+                                   << ". Does it exist? Have you run pandora index?";
+        exit(1);
+    }
+
+    if (is_binary_index_file(indexfile)) {
+        load_binary(indexfile);
+    } else {
+        Index index;
+        index.load(indexfile);
+        *this = FrozenIndex(index);
+    }
+
+    BOOST_LOG_TRIVIAL(debug) << "Finished loading file. Index now contains "
+                             << num_keys << " entries, of which " << num_masked_keys
+                             << " are masked";
+}
+
+void FrozenIndex::load_binary(const fs::path& indexfile)
+{
+    clear();
+    std::unique_ptr<MappedIndexFile> file(new MappedIndexFile(indexfile));
+    const auto& header = file->header();
+    const auto arrays = file->arrays();
+
+    w = header.w;
+    k = header.k;
+    prg_id_offset = header.prg_id_offset;
+    num_prgs = header.num_prgs;
+    mask_above = header.mask_above;
+    mask_top_fraction = header.mask_top_fraction;
+    num_keys = arrays.num_keys;
+    num_records = arrays.num_records;
+    num_intervals = arrays.num_intervals;
+    keys = arrays.keys;
+    offsets = arrays.offsets;
+    records = arrays.records;
+    path_offsets = arrays.path_offsets;
+    intervals = arrays.intervals;
+    if (arrays.masked != nullptr) {
+        masked = arrays.masked;
+    } else {
+        owned_masked.assign(number_of_mask_words(num_keys), 0);
+        masked = owned_masked.data();
+    }
+    count_masked_keys();
+    check_number_of_records();
+    if (arrays.mphf_levels != nullptr) {
+        mphf = MinimalPerfectHash(num_keys, arrays.mphf_levels, arrays.num_mphf_levels,
+            arrays.mphf_blocks, arrays.num_mphf_blocks, arrays.mphf_leftover_keys,
+            arrays.num_mphf_leftover_keys);
+        slots = arrays.mphf_slots;
+    } else {
+        build_mphf();
+    }
+    if (arrays.filter_words != nullptr) {
+        membership_filter
+            = MembershipFilter(arrays.filter_words, arrays.num_filter_words);
+    }
+    mapped_file = std::move(file);
+    paths.reset(arrays.num_paths);
+}
+
+void FrozenIndex::save(const fs::path& indexfile) const
+{
+    IndexFileHeader header;
+    header.w = w;
+    header.k = k;
+    header.num_sections = has_membership_filter() ? 11 : 10;
+    header.prg_id_offset = prg_id_offset;
+    header.num_prgs = num_prgs;
+    header.mask_above = mask_above;
+    header.mask_top_fraction = mask_top_fraction;
+    header.num_keys = num_keys;
+    header.num_records = num_records;
+    header.num_paths = paths.size();
+    header.num_intervals = num_intervals;
+
+    IndexFileWriter writer(indexfile, header);
+    writer.begin_section(IndexSection::Keys, sizeof(uint64_t));
+    writer.append(keys, num_keys * sizeof(uint64_t));
+    writer.end_section();
+    writer.begin_section(IndexSection::Offsets, sizeof(uint64_t));
+    writer.append(offsets, (num_keys + 1) * sizeof(uint64_t));
+    writer.end_section();
+    writer.begin_section(IndexSection::Records, sizeof(IndexFileRecord));
+    writer.append(records, num_records * sizeof(IndexFileRecord));
+    writer.end_section();
+    writer.begin_section(IndexSection::PathOffsets, sizeof(uint64_t));
+    writer.append(path_offsets, (paths.size() + 1) * sizeof(uint64_t));
+    writer.end_section();
+    writer.begin_section(IndexSection::Intervals, sizeof(Interval));
+    writer.append(intervals, num_intervals * sizeof(Interval));
+    writer.end_section();
+    writer.begin_section(IndexSection::MaskedKeys, sizeof(uint64_t));
+    writer.append(masked, number_of_mask_words(num_keys) * sizeof(uint64_t));
+    writer.end_section();
+    write_mphf_sections(writer, mphf, slots);
+    if (has_membership_filter()) {
+        writer.begin_section(IndexSection::MembershipFilter, sizeof(uint64_t));
+        writer.append(membership_filter.get_words(),
+            membership_filter.get_num_words() * sizeof(uint64_t));
+        writer.end_section();
+    }
+    writer.close();
+}
+
+void FrozenIndex::clear()
+{
+    w = 0;
+    k = 0;
+    prg_id_offset = 0;
+    num_prgs = 0;
+    mask_above = 0;
+    mask_top_fraction = 0;
+    owned_keys.clear();
+    owned_offsets.assign(1, 0);
+    owned_records.clear();
+    owned_path_offsets.assign(1, 0);
+    owned_intervals.clear();
+    owned_masked.clear();
+    paths.clear();
+    point_to_owned_arrays();
+    build_mphf();
+    membership_filter = MembershipFilter();
+}
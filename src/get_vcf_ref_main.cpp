@@ -22,6 +22,11 @@ void setup_get_vcf_ref_subcommand(CLI::App& app)
     gvr_subcmd->add_flag(
         "-z,--compress", opt->compress, "Compress the output with gzip");
 
+    gvr_subcmd
+        ->add_option("-t,--threads", opt->threads, "Maximum number of threads to use")
+        ->type_name("INT")
+        ->capture_default_str();
+
     gvr_subcmd->add_flag(
         "-v", opt->verbosity, "Verbosity of logging. Repeat for increased verbosity");
 
@@ -31,7 +36,7 @@ void setup_get_vcf_ref_subcommand(CLI::App& app)
 int pandora_get_vcf_ref(GetVcfRefOptions const& opt)
 {
     std::vector<std::shared_ptr<LocalPRG>> prgs;
-    read_prg_file(prgs, opt.prgfile);
+    read_prg_file(prgs, opt.prgfile, 0, 0, false, opt.threads);
 
     Fastaq output_fasta(opt.compress, false);
 
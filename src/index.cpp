@@ -3,11 +3,17 @@
 #include <unordered_map>
 #include <vector>
 #include <algorithm>
+#include <numeric>
+#include <queue>
+#include <tuple>
 
 #include <boost/log/trivial.hpp>
+#include <omp.h>
 
 #include "minirecord.h"
 #include "index.h"
+#include "index_file.h"
+#include "frozen_index.h"
 #include "localPRG.h"
 
 /**
@@ -41,24 +47,162 @@ void Index::add_record(const uint64_t kmer, const uint32_t prg_id,
     }
 }
 
+bool SketchedMinimizer::operator<(const SketchedMinimizer& other) const
+{
+    return std::tie(kmer_hash, prg_id, knode_id, strand)
+        < std::tie(other.kmer_hash, other.prg_id, other.knode_id, other.strand);
+}
+
+void Index::add_sorted_minimizers(
+    const std::vector<std::vector<SketchedMinimizer>>& runs)
+{
+    // k-way merge of the runs: the heap holds the next minimizer of each run, so
+    // minimizers come out sorted and records of the same key are added together
+    typedef std::pair<const SketchedMinimizer*, const SketchedMinimizer*> RunCursor;
+    const auto next_is_greater = [](const RunCursor& lhs, const RunCursor& rhs) {
+        return *rhs.first < *lhs.first;
+    };
+    std::priority_queue<RunCursor, std::vector<RunCursor>, decltype(next_is_greater)>
+        heap(next_is_greater);
+    for (const auto& run : runs) {
+        if (!run.empty()) {
+            heap.emplace(run.data(), run.data() + run.size());
+        }
+    }
+
+    std::vector<MiniRecord>* records = nullptr;
+    bool key_was_in_index = false;
+    const SketchedMinimizer* previous = nullptr;
+    while (!heap.empty()) {
+        auto cursor = heap.top();
+        heap.pop();
+        const SketchedMinimizer& minimizer = *cursor.first;
+        if (++cursor.first != cursor.second) {
+            heap.push(cursor);
+        }
+
+        if (previous == nullptr or previous->kmer_hash != minimizer.kmer_hash) {
+            auto& vmr = minhash[minimizer.kmer_hash];
+            key_was_in_index = vmr != nullptr;
+            if (!key_was_in_index) {
+                vmr = new std::vector<MiniRecord>;
+            }
+            records = vmr;
+        } else if (!(*previous < minimizer) and *previous->path == *minimizer.path) {
+            continue; // the same PRG was sketched twice
+        }
+        previous = &minimizer;
+
+        MiniRecord record(
+            minimizer.prg_id, *minimizer.path, minimizer.knode_id, minimizer.strand);
+        if (!key_was_in_index
+            or std::find(records->begin(), records->end(), record) == records->end()) {
+            records->push_back(std::move(record));
+        }
+    }
+}
+
 void Index::clear()
 {
     for (auto it = minhash.begin(); it != minhash.end();) {
         delete it->second;
         it = minhash.erase(it);
     }
+    w = 0;
+    k = 0;
+    prg_id_offset = 0;
+    num_prgs = 0;
+    masked_minimizers.clear();
+    mask_above = 0;
+    mask_top_fraction = 0;
+    with_membership_filter = false;
+}
+
+uint64_t Index::mask_frequent_minimizers(
+    const uint32_t max_records, const double top_fraction)
+{
+    if (max_records > 0) {
+        mask_above = mask_above > 0 ? std::min(mask_above, max_records) : max_records;
+    }
+    mask_top_fraction = std::max(mask_top_fraction, top_fraction);
+    if (minhash.empty()) {
+        return 0;
+    }
+
+    std::vector<uint32_t> multiplicities;
+    multiplicities.reserve(minhash.size());
+    uint64_t number_of_records = 0;
+    for (const auto& entry : minhash) {
+        multiplicities.push_back(entry.second->size());
+        number_of_records += entry.second->size();
+    }
+    std::sort(multiplicities.begin(), multiplicities.end());
+    const auto quantile = [&multiplicities](const double fraction) {
+        return multiplicities[(size_t)(fraction * (multiplicities.size() - 1))];
+    };
+    BOOST_LOG_TRIVIAL(info) << "Records per minimizer: mean "
+                            << (double)number_of_records / multiplicities.size()
+                            << ", median " << quantile(0.5) << ", 99th percentile "
+                            << quantile(0.99) << ", 99.9th percentile "
+                            << quantile(0.999) << ", max " << multiplicities.back();
+
+    const uint32_t cutoff
+        = masked_keys_cutoff(multiplicities, max_records, top_fraction);
+    uint64_t number_of_masked_records = 0;
+    const auto number_of_masked_before = masked_minimizers.size();
+    for (const auto& entry : minhash) {
+        if (entry.second->size() > cutoff
+            and masked_minimizers.insert(entry.first).second) {
+            number_of_masked_records += entry.second->size();
+        }
+    }
+    const uint64_t number_of_masked
+        = masked_minimizers.size() - number_of_masked_before;
+    if (number_of_masked > 0) {
+        BOOST_LOG_TRIVIAL(info) << "Masked " << number_of_masked
+                                << " minimizers with more than " << cutoff
+                                << " records, which hold " << number_of_masked_records
+                                << " of the " << number_of_records << " records";
+    }
+    return number_of_masked;
 }
 
-void Index::save(const fs::path& prgfile, uint32_t w, uint32_t k)
+void Index::save(const fs::path& prgfile, uint32_t w, uint32_t k,
+    const IndexFormat& format)
 {
     const fs::path filepath { prgfile.string() + ".k" + std::to_string(k) + ".w"
         + std::to_string(w) + ".idx" };
-    save(filepath);
+    this->w = w;
+    this->k = k;
+    save(filepath, format);
 }
 
-void Index::save(const fs::path& indexfile)
+void Index::save(const fs::path& indexfile, const IndexFormat& format)
 {
     BOOST_LOG_TRIVIAL(debug) << "Saving index to " << indexfile;
+    if (format == IndexFormat::Binary) {
+        save_binary(indexfile);
+    } else {
+        save_text(indexfile);
+    }
+    BOOST_LOG_TRIVIAL(debug) << "Finished saving " << minhash.size()
+                             << " entries to file";
+}
+
+void Index::save_binary(const fs::path& indexfile) const
+{
+    // binary index files are frozen indexes written as they are laid out in memory
+    FrozenIndex(*this).save(indexfile);
+}
+
+void Index::save_text(const fs::path& indexfile) const
+{
+    if (!masked_minimizers.empty()) {
+        BOOST_LOG_TRIVIAL(warning) << "The text index format can't store the "
+                                   << masked_minimizers.size()
+                                   << " masked minimizers, which won't be masked";
+    }
+
     fs::ofstream handle;
     handle.open(indexfile);
 
@@ -72,8 +216,45 @@ void Index::save(const fs::path& indexfile)
         handle << std::endl;
     }
     handle.close();
-    BOOST_LOG_TRIVIAL(debug) << "Finished saving " << minhash.size()
-                             << " entries to file";
+}
+
+void Index::append_to(const fs::path& indexfile) const
+{
+    if (!fs::exists(indexfile) or !is_binary_index_file(indexfile)) {
+        throw std::runtime_error("Can only append to an existing binary index, not to "
+            + indexfile.string());
+    }
+    uint64_t end_of_indexed_prgs;
+    {
+        const MappedIndexFile file(indexfile);
+        const auto& header = file.header();
+        if ((header.w != 0 and header.w != w) or (header.k != 0 and header.k != k)) {
+            throw std::runtime_error("Index " + indexfile.string()
+                + " was built with w=" + std::to_string(header.w)
+                + " and k=" + std::to_string(header.k)
+                + ", not with w=" + std::to_string(w) + " and k=" + std::to_string(k));
+        }
+        end_of_indexed_prgs = (uint64_t)header.prg_id_offset + header.num_prgs;
+    }
+    if (num_prgs > 0 and prg_id_offset != end_of_indexed_prgs) {
+        throw std::runtime_error("The PRGs appended to " + indexfile.string()
+            + " must have ids from " + std::to_string(end_of_indexed_prgs)
+            + ", but they start at " + std::to_string(prg_id_offset));
+    }
+
+    // the index file is mapped while it is merged, so the result is renamed after
+    const fs::path appended_indexfile { indexfile.string() + ".appended.tmp" };
+    const fs::path merged_indexfile { indexfile.string() + ".merged.tmp" };
+    save_binary(appended_indexfile);
+    try {
+        merge_index_files({ indexfile, appended_indexfile }, merged_indexfile);
+    } catch (const std::runtime_error&) {
+        fs::remove(appended_indexfile);
+        fs::remove(merged_indexfile);
+        throw;
+    }
+    fs::remove(appended_indexfile);
+    fs::rename(merged_indexfile, indexfile);
 }
 
 void Index::load(fs::path prgfile, uint32_t w, uint32_t k)
@@ -81,12 +262,101 @@ void Index::load(fs::path prgfile, uint32_t w, uint32_t k)
     const auto ext { ".k" + std::to_string(k) + ".w" + std::to_string(w) + ".idx" };
     prgfile += ext;
     load(prgfile);
+
+    if ((this->w != 0 and this->w != w) or (this->k != 0 and this->k != k)) {
+        BOOST_LOG_TRIVIAL(error) << "Index file " << prgfile << " was built with w="
+                                 << this->w << " and k=" << this->k
+                                 << ", but w=" << w << " and k=" << k << " were asked";
+        exit(1);
+    }
 }
 
 void Index::load(const fs::path& indexfile)
 {
     BOOST_LOG_TRIVIAL(debug) << "Loading index";
     BOOST_LOG_TRIVIAL(debug) << "File is " << indexfile;
+
+    if (!fs::exists(indexfile)) {
+        BOOST_LOG_TRIVIAL(warning) << "Unable to open index file " << indexfile
+                                   << ". Does it exist? Have you run pandora index?";
+        exit(1);
+    }
+
+    if (is_binary_index_file(indexfile)) {
+        load_binary(indexfile);
+    } else {
+        load_text(indexfile);
+    }
+
+    if (minhash.size() <= 1) {
+        BOOST_LOG_TRIVIAL(debug)
+            << "Was this file empty?! Index now contains a trivial " << minhash.size()
+            << " entries";
+    } else {
+        BOOST_LOG_TRIVIAL(debug) << "Finished loading file. Index now contains "
+                                 << minhash.size() << " entries";
+    }
+}
+
+void Index::add_prg_id_range(
+    const uint32_t& first_prg_id, const uint32_t& number_of_prgs)
+{
+    if (number_of_prgs == 0) {
+        return;
+    }
+    if (num_prgs == 0) {
+        prg_id_offset = first_prg_id;
+        num_prgs = number_of_prgs;
+        return;
+    }
+    const auto end = std::max(prg_id_offset + num_prgs, first_prg_id + number_of_prgs);
+    prg_id_offset = std::min(prg_id_offset, first_prg_id);
+    num_prgs = end - prg_id_offset;
+}
+
+void Index::load_binary(const fs::path& indexfile)
+{
+    FrozenIndex frozen_index;
+    frozen_index.load(indexfile);
+    if ((w != 0 and frozen_index.get_w() != 0 and w != frozen_index.get_w())
+        or (k != 0 and frozen_index.get_k() != 0 and k != frozen_index.get_k())) {
+        throw std::runtime_error("Cannot load index file " + indexfile.string()
+            + " built with different w or k into this index");
+    }
+    if (frozen_index.get_w() != 0) {
+        w = frozen_index.get_w();
+        k = frozen_index.get_k();
+    }
+    add_prg_id_range(frozen_index.get_prg_id_offset(), frozen_index.get_num_prgs());
+    with_membership_filter |= frozen_index.has_membership_filter();
+    if (frozen_index.get_mask_above() > 0) {
+        mask_above = mask_above > 0
+            ? std::min(mask_above, frozen_index.get_mask_above())
+            : frozen_index.get_mask_above();
+    }
+    mask_top_fraction
+        = std::max(mask_top_fraction, frozen_index.get_mask_top_fraction());
+
+    minhash.reserve(minhash.size() + frozen_index.number_of_keys());
+    for (uint64_t i = 0; i < frozen_index.number_of_keys(); ++i) {
+        auto& vmr = minhash[frozen_index.get_key(i)];
+        if (vmr == nullptr) {
+            vmr = new std::vector<MiniRecord>;
+        }
+        if (frozen_index.is_masked(i)) {
+            masked_minimizers.insert(frozen_index.get_key(i));
+        }
+        const auto records = frozen_index.get_records(i);
+        vmr->reserve(vmr->size() + records.size());
+        for (const auto& record : records) {
+            vmr->emplace_back(record.prg_id, frozen_index.get_path(record),
+                record.knode_id, record.strand != 0);
+        }
+    }
+}
+
+void Index::load_text(const fs::path& indexfile)
+{
     uint64_t key;
     size_t size;
     int c;
@@ -128,20 +398,12 @@ void Index::load(const fs::path& indexfile)
                                    << ". Does it exist? Have you run pandora index?";
         exit(1);
     }
-
-    if (minhash.size() <= 1) {
-        BOOST_LOG_TRIVIAL(debug)
-            << "Was this file empty?! Index now contains a trivial " << minhash.size()
-            << " entries";
-    } else {
-        BOOST_LOG_TRIVIAL(debug) << "Finished loading file. Index now contains "
-                                 << minhash.size() << " entries";
-    }
 }
 
 bool Index::operator==(const Index& other) const
 {
-    if (this->minhash.size() != other.minhash.size()) {
+    if (this->minhash.size() != other.minhash.size()
+        or this->masked_minimizers != other.masked_minimizers) {
         return false;
     }
 
@@ -175,13 +437,14 @@ bool Index::operator==(const Index& other) const
 
 bool Index::operator!=(const Index& other) const { return !(*this == other); }
 
-void index_prgs(std::vector<std::shared_ptr<LocalPRG>>& prgs,
+std::vector<uint32_t> index_prgs(std::vector<std::shared_ptr<LocalPRG>>& prgs,
     std::shared_ptr<Index>& index, const uint32_t w, const uint32_t k,
-    const fs::path& outdir, uint32_t threads)
+    uint32_t threads, uint64_t max_sketch_paths)
 {
     BOOST_LOG_TRIVIAL(debug) << "Index PRGs";
+    std::vector<uint32_t> prgs_over_budget;
     if (prgs.empty())
-        return;
+        return prgs_over_budget;
 
     // first reserve an estimated index size
     uint32_t r = 0;
@@ -189,26 +452,50 @@ void index_prgs(std::vector<std::shared_ptr<LocalPRG>>& prgs,
         r += prgs[i]->seq.length();
     }
     index->minhash.reserve(r);
+    index->w = w;
+    index->k = k;
+    index->add_prg_id_range(prgs.front()->id, prgs.size());
 
-    // create the dirs for the index
-    const int nbOfGFAsPerDir = 4000;
-    for (uint32_t i = 0; i <= prgs.size() / nbOfGFAsPerDir; ++i)
-        fs::create_directories(outdir / int_to_string(i + 1));
+    // the most costly PRGs are sketched first, so that no thread is left sketching a
+    // large PRG at the end while the others are idle. The index doesn't depend on
+    // this order, as the minimizers are sorted
+    std::vector<uint32_t> order(prgs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::vector<uint64_t> costs(prgs.size());
+    for (uint32_t i = 0; i < prgs.size(); ++i) {
+        costs[i] = prgs[i]->sketch_cost();
+    }
+    std::stable_sort(order.begin(), order.end(),
+        [&costs](const uint32_t& a, const uint32_t& b) { return costs[a] > costs[b]; });
 
-    // now fill index
+    // now fill index: each thread collects the minimizers of the PRGs it sketches and
+    // sorts them, then all of them are merged into the index at once, so threads never
+    // wait for each other
+    std::vector<std::vector<SketchedMinimizer>> minimizers_per_thread(threads);
     std::atomic_uint32_t nbOfPRGsDone { 0 };
-#pragma omp parallel for num_threads(threads) schedule(dynamic, 1)
-    for (uint32_t i = 0; i < prgs.size(); ++i) { // for each prg
-        uint32_t dir = i / nbOfGFAsPerDir + 1;
-        prgs[i]->minimizer_sketch(
-            index, w, k, (((double)(nbOfPRGsDone.load())) / prgs.size()) * 100);
-        const auto gfa_file { outdir / int_to_string(dir)
-            / (prgs[i]->name + ".k" + std::to_string(k) + ".w" + std::to_string(w)
-                + ".gfa") };
-        prgs[i]->kmer_prg.save(gfa_file);
-
-        ++nbOfPRGsDone;
+    std::vector<char> is_over_budget(prgs.size(), false);
+#pragma omp parallel num_threads(threads)
+    {
+        auto& minimizers = minimizers_per_thread[omp_get_thread_num()];
+#pragma omp for schedule(dynamic, 1)
+        for (uint32_t j = 0; j < prgs.size(); ++j) { // for each prg
+            const uint32_t i = order[j];
+            is_over_budget[i] = !prgs[i]->minimizer_sketch(minimizers, w, k,
+                (((double)(nbOfPRGsDone.load())) / prgs.size()) * 100,
+                max_sketch_paths);
+
+            ++nbOfPRGsDone;
+        }
+        std::sort(minimizers.begin(), minimizers.end());
     }
+    index->add_sorted_minimizers(minimizers_per_thread);
     BOOST_LOG_TRIVIAL(debug) << "Finished adding " << prgs.size() << " LocalPRGs";
     BOOST_LOG_TRIVIAL(debug) << "Number of keys in Index: " << index->minhash.size();
+
+    for (uint32_t i = 0; i < prgs.size(); ++i) {
+        if (is_over_budget[i]) {
+            prgs_over_budget.push_back(prgs[i]->id);
+        }
+    }
+    return prgs_over_budget;
 }
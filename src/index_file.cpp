@@ -0,0 +1,592 @@
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+
+#include <boost/log/trivial.hpp>
+
+#include "index_file.h"
+
+IndexFileHeader::IndexFileHeader()
+    : version { INDEX_FILE_VERSION }
+    , byte_order_mark { INDEX_FILE_BYTE_ORDER_MARK }
+    , w { 0 }
+    , k { 0 }
+    , hash_scheme { (uint32_t)IndexHashScheme::Hash64Canonical }
+    , num_sections { 0 }
+    , prg_id_offset { 0 }
+    , num_prgs { 0 }
+    , num_keys { 0 }
+    , num_records { 0 }
+    , num_paths { 0 }
+    , num_intervals { 0 }
+    , mask_top_fraction { 0 }
+    , mask_above { 0 }
+    , reserved { 0 }
+{
+    std::memcpy(magic, INDEX_FILE_MAGIC, sizeof(magic));
+}
+
+uint32_t masked_keys_cutoff(const std::vector<uint32_t>& sorted_numbers_of_records,
+    const uint32_t max_records, const double top_fraction)
+{
+    uint32_t cutoff = max_records > 0 ? max_records
+                                      : std::numeric_limits<uint32_t>::max();
+    if (top_fraction > 0 and !sorted_numbers_of_records.empty()) {
+        const auto quantile = (size_t)(std::max(0.0, 1 - top_fraction)
+            * (sorted_numbers_of_records.size() - 1));
+        cutoff = std::min(cutoff, sorted_numbers_of_records[quantile]);
+    }
+    return cutoff;
+}
+
+bool is_binary_index_file(const fs::path& filepath)
+{
+    fs::ifstream handle(filepath, std::ios::binary);
+    char magic[sizeof(INDEX_FILE_MAGIC)];
+    if (!handle.read(magic, sizeof(magic))) {
+        return false;
+    }
+    return std::memcmp(magic, INDEX_FILE_MAGIC, sizeof(magic)) == 0;
+}
+
+IndexFileWriter::IndexFileWriter(
+    const fs::path& filepath, const IndexFileHeader& header)
+    : filepath(filepath)
+    , header(header)
+    , in_section(false)
+    , closed(false)
+{
+    handle.open(filepath, std::ios::binary | std::ios::trunc);
+    if (!handle.is_open()) {
+        throw std::runtime_error("Unable to open index file " + filepath.string()
+            + " for writing");
+    }
+    // reserve space for the header and the section directory, written on close()
+    const std::vector<char> placeholder(sizeof(IndexFileHeader)
+            + this->header.num_sections * sizeof(IndexSectionEntry),
+        0);
+    handle.write(placeholder.data(), placeholder.size());
+}
+
+IndexFileWriter::~IndexFileWriter()
+{
+    if (!closed and handle.is_open()) {
+        handle.close();
+    }
+}
+
+void IndexFileWriter::pad_to_alignment()
+{
+    const uint64_t position = handle.tellp();
+    const uint64_t remainder = position % INDEX_FILE_SECTION_ALIGNMENT;
+    if (remainder != 0) {
+        const std::vector<char> padding(INDEX_FILE_SECTION_ALIGNMENT - remainder, 0);
+        handle.write(padding.data(), padding.size());
+    }
+}
+
+void IndexFileWriter::begin_section(
+    const IndexSection& id, const uint32_t& element_size)
+{
+    assert(!in_section);
+    if (sections.size() == header.num_sections) {
+        throw std::logic_error("More sections written to " + filepath.string()
+            + " than declared in its header");
+    }
+    pad_to_alignment();
+    IndexSectionEntry entry {};
+    entry.id = (uint32_t)id;
+    entry.element_size = element_size;
+    entry.offset = handle.tellp();
+    entry.size = 0;
+    sections.push_back(entry);
+    in_section = true;
+}
+
+void IndexFileWriter::append(const void* data, const uint64_t& size)
+{
+    assert(in_section);
+    handle.write(reinterpret_cast<const char*>(data), size);
+    sections.back().size += size;
+}
+
+void IndexFileWriter::end_section()
+{
+    assert(in_section);
+    in_section = false;
+}
+
+void IndexFileWriter::set_header(const IndexFileHeader& header)
+{
+    if (header.num_sections != this->header.num_sections) {
+        throw std::logic_error(
+            "The number of sections of " + filepath.string() + " can't change");
+    }
+    this->header = header;
+}
+
+void IndexFileWriter::close()
+{
+    assert(!in_section);
+    if (sections.size() != header.num_sections) {
+        throw std::logic_error("Fewer sections written to " + filepath.string()
+            + " than declared in its header");
+    }
+    handle.seekp(0);
+    handle.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    handle.write(reinterpret_cast<const char*>(sections.data()),
+        sections.size() * sizeof(IndexSectionEntry));
+    handle.close();
+    if (handle.fail()) {
+        throw std::runtime_error("Error writing index file " + filepath.string());
+    }
+    closed = true;
+}
+
+MappedIndexFile::MappedIndexFile(const fs::path& filepath)
+    : filepath(filepath)
+{
+    if (!fs::exists(filepath)) {
+        throw std::runtime_error("Index file " + filepath.string() + " does not exist");
+    }
+    if (fs::file_size(filepath) < sizeof(IndexFileHeader)) {
+        throw std::runtime_error(
+            "Index file " + filepath.string() + " is too small to be an index");
+    }
+    file.open(filepath.string());
+
+    header_ptr = reinterpret_cast<const IndexFileHeader*>(file.data());
+    if (std::memcmp(header_ptr->magic, INDEX_FILE_MAGIC, sizeof(INDEX_FILE_MAGIC))
+        != 0) {
+        throw std::runtime_error(
+            filepath.string() + " is not a binary pandora index file");
+    }
+    if (header_ptr->byte_order_mark != INDEX_FILE_BYTE_ORDER_MARK) {
+        throw std::runtime_error("Index file " + filepath.string()
+            + " was written on a machine with a different byte order");
+    }
+    if (header_ptr->version != INDEX_FILE_VERSION) {
+        throw std::runtime_error("Index file " + filepath.string() + " has version "
+            + std::to_string(header_ptr->version) + ", but this pandora reads version "
+            + std::to_string(INDEX_FILE_VERSION) + ". Please rerun pandora index");
+    }
+    if (header_ptr->hash_scheme != (uint32_t)IndexHashScheme::Hash64Canonical) {
+        throw std::runtime_error("Index file " + filepath.string()
+            + " uses an unknown minimizer hash scheme");
+    }
+
+    const uint64_t directory_end = sizeof(IndexFileHeader)
+        + (uint64_t)header_ptr->num_sections * sizeof(IndexSectionEntry);
+    if (file.size() < directory_end) {
+        throw std::runtime_error("Index file " + filepath.string() + " is truncated");
+    }
+    sections_ptr = reinterpret_cast<const IndexSectionEntry*>(
+        file.data() + sizeof(IndexFileHeader));
+    for (uint32_t i = 0; i < header_ptr->num_sections; ++i) {
+        const auto& entry = sections_ptr[i];
+        if (entry.offset + entry.size > file.size() or entry.element_size == 0
+            or entry.size % entry.element_size != 0) {
+            throw std::runtime_error(
+                "Index file " + filepath.string() + " is truncated or corrupted");
+        }
+    }
+}
+
+bool MappedIndexFile::has_section(const IndexSection& id) const
+{
+    for (uint32_t i = 0; i < header_ptr->num_sections; ++i) {
+        if (sections_ptr[i].id == (uint32_t)id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const IndexSectionEntry& MappedIndexFile::find_section(const IndexSection& id) const
+{
+    for (uint32_t i = 0; i < header_ptr->num_sections; ++i) {
+        if (sections_ptr[i].id == (uint32_t)id) {
+            return sections_ptr[i];
+        }
+    }
+    throw std::runtime_error("Index file " + filepath.string() + " has no section "
+        + std::to_string((uint32_t)id));
+}
+
+void write_mphf_sections(IndexFileWriter& writer, const MinimalPerfectHash& mphf,
+    const IndexFileSlot* slots)
+{
+    writer.begin_section(IndexSection::MphfLevels, sizeof(MphfLevel));
+    writer.append(mphf.get_levels(), mphf.get_num_levels() * sizeof(MphfLevel));
+    writer.end_section();
+    writer.begin_section(IndexSection::MphfBlocks, sizeof(uint64_t));
+    writer.append(mphf.get_blocks(),
+        mphf.get_num_blocks() * MinimalPerfectHash::WORDS_PER_BLOCK * sizeof(uint64_t));
+    writer.end_section();
+    writer.begin_section(IndexSection::MphfLeftoverKeys, sizeof(uint64_t));
+    writer.append(
+        mphf.get_leftover_keys(), mphf.get_num_leftover_keys() * sizeof(uint64_t));
+    writer.end_section();
+    writer.begin_section(IndexSection::MphfSlots, sizeof(IndexFileSlot));
+    writer.append(slots, mphf.size() * sizeof(IndexFileSlot));
+    writer.end_section();
+}
+
+IndexFileArrays MappedIndexFile::arrays() const
+{
+    IndexFileArrays arrays;
+    uint64_t num_offsets, num_path_offsets;
+    arrays.keys = section<uint64_t>(IndexSection::Keys, arrays.num_keys);
+    arrays.offsets = section<uint64_t>(IndexSection::Offsets, num_offsets);
+    arrays.records
+        = section<IndexFileRecord>(IndexSection::Records, arrays.num_records);
+    arrays.path_offsets
+        = section<uint64_t>(IndexSection::PathOffsets, num_path_offsets);
+    arrays.intervals = section<Interval>(IndexSection::Intervals, arrays.num_intervals);
+    arrays.num_paths = num_path_offsets > 0 ? num_path_offsets - 1 : 0;
+    arrays.masked = nullptr;
+    uint64_t num_mask_words = number_of_mask_words(arrays.num_keys);
+    if (has_section(IndexSection::MaskedKeys)) {
+        arrays.masked = section<uint64_t>(IndexSection::MaskedKeys, num_mask_words);
+    }
+
+    arrays.mphf_levels = nullptr;
+    arrays.mphf_blocks = nullptr;
+    arrays.mphf_leftover_keys = nullptr;
+    arrays.mphf_slots = nullptr;
+    arrays.num_mphf_levels = arrays.num_mphf_blocks = arrays.num_mphf_leftover_keys = 0;
+    uint64_t num_mphf_words = 0, num_mphf_slots = arrays.num_keys;
+    const bool hashed = has_section(IndexSection::MphfLevels);
+    if (hashed) {
+        arrays.mphf_levels
+            = section<MphfLevel>(IndexSection::MphfLevels, arrays.num_mphf_levels);
+        arrays.mphf_blocks
+            = section<uint64_t>(IndexSection::MphfBlocks, num_mphf_words);
+        arrays.num_mphf_blocks = num_mphf_words / MinimalPerfectHash::WORDS_PER_BLOCK;
+        arrays.mphf_leftover_keys = section<uint64_t>(
+            IndexSection::MphfLeftoverKeys, arrays.num_mphf_leftover_keys);
+        arrays.mphf_slots
+            = section<IndexFileSlot>(IndexSection::MphfSlots, num_mphf_slots);
+    }
+
+    arrays.filter_words = nullptr;
+    arrays.num_filter_words = 0;
+    if (has_section(IndexSection::MembershipFilter)) {
+        arrays.filter_words = section<uint64_t>(
+            IndexSection::MembershipFilter, arrays.num_filter_words);
+    }
+
+    bool corrupted = num_offsets != arrays.num_keys + 1
+        or arrays.offsets[arrays.num_keys] != arrays.num_records
+        or num_path_offsets == 0 or arrays.path_offsets[0] != 0
+        or arrays.path_offsets[arrays.num_paths] != arrays.num_intervals
+        or !std::is_sorted(arrays.keys, arrays.keys + arrays.num_keys)
+        or num_mask_words != number_of_mask_words(arrays.num_keys)
+        or num_mphf_slots != arrays.num_keys
+        or arrays.num_filter_words % MembershipFilter::WORDS_PER_BLOCK != 0
+        or num_mphf_words % MinimalPerfectHash::WORDS_PER_BLOCK != 0
+        or arrays.num_mphf_leftover_keys > arrays.num_keys
+        or !std::is_sorted(arrays.mphf_leftover_keys,
+            arrays.mphf_leftover_keys + arrays.num_mphf_leftover_keys);
+    for (uint64_t i = 0; i < arrays.num_mphf_levels and !corrupted; ++i) {
+        const auto& level = arrays.mphf_levels[i];
+        corrupted = level.num_bits == 0
+            or level.first_bit + level.num_bits
+                > arrays.num_mphf_blocks * MinimalPerfectHash::BITS_PER_BLOCK;
+    }
+    for (uint64_t i = 0; hashed and i < arrays.num_keys and !corrupted; ++i) {
+        corrupted = arrays.mphf_slots[i].key_index >= arrays.num_keys;
+    }
+    for (uint64_t i = 0; i < arrays.num_records and !corrupted; ++i) {
+        corrupted = arrays.records[i].path_id >= arrays.num_paths;
+    }
+    if (corrupted) {
+        throw std::runtime_error("Index file " + filepath.string() + " is corrupted");
+    }
+    return arrays;
+}
+
+namespace {
+// an index file being merged
+struct MergeInput {
+    fs::path filepath;
+    std::unique_ptr<MappedIndexFile> file;
+    IndexFileArrays arrays;
+    uint64_t first_prg_id;
+    uint64_t end_prg_id; // one past its last PRG id
+    uint64_t first_path_id; // id of its first path in the merged path table
+    uint64_t first_interval; // position of its first interval in the merged table
+    bool has_mask_cutoff; // otherwise, the keys it masks stay masked
+};
+
+// calls callback(key, positions) for each key of the inputs, in increasing order.
+// positions holds the (input, position of the key in the input) of all the inputs
+// having the key, in input order
+template <typename Callback>
+void for_each_merged_key(const std::vector<MergeInput>& inputs, Callback callback)
+{
+    typedef std::pair<uint64_t, size_t> Cursor; // the next key of an input
+    std::priority_queue<Cursor, std::vector<Cursor>, std::greater<Cursor>> cursors;
+    std::vector<uint64_t> next_positions(inputs.size(), 0);
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if (inputs[i].arrays.num_keys > 0) {
+            cursors.emplace(inputs[i].arrays.keys[0], i);
+        }
+    }
+
+    std::vector<std::pair<size_t, uint64_t>> positions;
+    while (!cursors.empty()) {
+        const uint64_t key = cursors.top().first;
+        positions.clear();
+        while (!cursors.empty() and cursors.top().first == key) {
+            const size_t i = cursors.top().second;
+            cursors.pop();
+            positions.emplace_back(i, next_positions[i]);
+            if (++next_positions[i] < inputs[i].arrays.num_keys) {
+                cursors.emplace(inputs[i].arrays.keys[next_positions[i]], i);
+            }
+        }
+        callback(key, positions);
+    }
+}
+}
+
+void merge_index_files(
+    const std::vector<fs::path>& indexfiles, const fs::path& outfile)
+{
+    IndexFileHeader header;
+    header.num_sections = 10;
+    bool with_membership_filter = false;
+
+    std::vector<MergeInput> inputs(indexfiles.size());
+    for (size_t i = 0; i < indexfiles.size(); ++i) {
+        auto& input = inputs[i];
+        input.filepath = indexfiles[i];
+        if (fs::exists(outfile) and fs::equivalent(input.filepath, outfile)) {
+            throw std::runtime_error(
+                "Can't merge index " + outfile.string() + " into itself");
+        }
+        input.file.reset(new MappedIndexFile(input.filepath));
+        input.arrays = input.file->arrays();
+        with_membership_filter |= input.arrays.filter_words != nullptr;
+        const auto& input_header = input.file->header();
+        input.has_mask_cutoff
+            = input_header.mask_above > 0 or input_header.mask_top_fraction > 0;
+        if (input_header.mask_above > 0) {
+            header.mask_above = header.mask_above > 0
+                ? std::min(header.mask_above, input_header.mask_above)
+                : input_header.mask_above;
+        }
+        header.mask_top_fraction
+            = std::max(header.mask_top_fraction, input_header.mask_top_fraction);
+
+        if (input_header.w != 0) {
+            if (header.w != 0
+                and (header.w != input_header.w or header.k != input_header.k)) {
+                throw std::runtime_error("Index " + input.filepath.string()
+                    + " was built with w=" + std::to_string(input_header.w)
+                    + " and k=" + std::to_string(input_header.k)
+                    + ", but the other indexes with w=" + std::to_string(header.w)
+                    + " and k=" + std::to_string(header.k) + ". They can't be merged");
+            }
+            header.w = input_header.w;
+            header.k = input_header.k;
+        } else {
+            BOOST_LOG_TRIVIAL(warning) << "Index " << input.filepath
+                                       << " does not record its w and k, which can't "
+                                          "be checked";
+        }
+
+        input.first_prg_id = input_header.prg_id_offset;
+        input.end_prg_id = (uint64_t)input_header.prg_id_offset + input_header.num_prgs;
+        if (input_header.num_prgs == 0 and input.arrays.num_records > 0) {
+            // the range of PRGs was not recorded, it is the one of the records
+            input.first_prg_id = std::numeric_limits<uint32_t>::max();
+            input.end_prg_id = 0;
+            for (uint64_t j = 0; j < input.arrays.num_records; ++j) {
+                const uint64_t prg_id = input.arrays.records[j].prg_id;
+                input.first_prg_id = std::min(input.first_prg_id, prg_id);
+                input.end_prg_id = std::max(input.end_prg_id, prg_id + 1);
+            }
+        }
+    }
+
+    // the records of a key are sorted by PRG id in each input, so they remain sorted
+    // when the inputs are concatenated in the order of their PRG ids
+    std::stable_sort(inputs.begin(), inputs.end(),
+        [](const MergeInput& lhs, const MergeInput& rhs) {
+            return lhs.first_prg_id < rhs.first_prg_id;
+        });
+    const MergeInput* previous = nullptr;
+    for (auto& input : inputs) {
+        if (input.end_prg_id <= input.first_prg_id) {
+            continue; // no PRG
+        }
+        if (previous != nullptr and input.first_prg_id < previous->end_prg_id) {
+            throw std::runtime_error("Indexes " + previous->filepath.string() + " and "
+                + input.filepath.string() + " have overlapping PRG ids. Index each "
+                + "PRG file with a different --id-offset before merging them");
+        }
+        if (previous == nullptr) {
+            header.prg_id_offset = input.first_prg_id;
+        }
+        header.num_prgs = input.end_prg_id - header.prg_id_offset;
+        previous = &input;
+    }
+
+    header.num_sections += with_membership_filter;
+    for (auto& input : inputs) {
+        input.first_path_id = header.num_paths;
+        input.first_interval = header.num_intervals;
+        header.num_records += input.arrays.num_records;
+        header.num_paths += input.arrays.num_paths;
+        header.num_intervals += input.arrays.num_intervals;
+    }
+    if (header.num_paths > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error(
+            "Too many k-mer paths to merge into " + outfile.string());
+    }
+
+    IndexFileWriter writer(outfile, header);
+    writer.begin_section(IndexSection::Keys, sizeof(uint64_t));
+    for_each_merged_key(inputs,
+        [&](const uint64_t& key, const std::vector<std::pair<size_t, uint64_t>>&) {
+            writer.append(&key, sizeof(key));
+            ++header.num_keys;
+        });
+    writer.end_section();
+
+    // the merged number of records of each key, to mask them
+    const bool with_mask_cutoff = header.mask_above > 0 or header.mask_top_fraction > 0;
+    std::vector<uint32_t> numbers_of_records;
+    if (with_mask_cutoff) {
+        numbers_of_records.reserve(header.num_keys);
+    }
+    uint64_t offset = 0;
+    writer.begin_section(IndexSection::Offsets, sizeof(uint64_t));
+    for_each_merged_key(inputs,
+        [&](const uint64_t&,
+            const std::vector<std::pair<size_t, uint64_t>>& positions) {
+            writer.append(&offset, sizeof(offset));
+            const uint64_t first_record = offset;
+            for (const auto& position : positions) {
+                const auto& offsets = inputs[position.first].arrays.offsets;
+                offset += offsets[position.second + 1] - offsets[position.second];
+            }
+            if (with_mask_cutoff) {
+                numbers_of_records.push_back((uint32_t)std::min<uint64_t>(
+                    offset - first_record, std::numeric_limits<uint32_t>::max()));
+            }
+        });
+    writer.append(&offset, sizeof(offset));
+    writer.end_section();
+
+    std::vector<IndexFileRecord> records;
+    writer.begin_section(IndexSection::Records, sizeof(IndexFileRecord));
+    for_each_merged_key(inputs,
+        [&](const uint64_t&,
+            const std::vector<std::pair<size_t, uint64_t>>& positions) {
+            records.clear();
+            for (const auto& position : positions) {
+                const auto& input = inputs[position.first];
+                const auto& offsets = input.arrays.offsets;
+                for (uint64_t j = offsets[position.second];
+                     j < offsets[position.second + 1]; ++j) {
+                    records.push_back(input.arrays.records[j]);
+                    records.back().path_id += input.first_path_id;
+                }
+            }
+            writer.append(records.data(), records.size() * sizeof(IndexFileRecord));
+        });
+    writer.end_section();
+
+    writer.begin_section(IndexSection::PathOffsets, sizeof(uint64_t));
+    for (const auto& input : inputs) {
+        for (uint64_t j = 0; j < input.arrays.num_paths; ++j) {
+            const uint64_t path_offset
+                = input.first_interval + input.arrays.path_offsets[j];
+            writer.append(&path_offset, sizeof(path_offset));
+        }
+    }
+    writer.append(&header.num_intervals, sizeof(header.num_intervals));
+    writer.end_section();
+
+    writer.begin_section(IndexSection::Intervals, sizeof(Interval));
+    for (const auto& input : inputs) {
+        writer.append(
+            input.arrays.intervals, input.arrays.num_intervals * sizeof(Interval));
+    }
+    writer.end_section();
+
+    uint32_t cutoff = std::numeric_limits<uint32_t>::max();
+    if (with_mask_cutoff) {
+        std::vector<uint32_t> sorted_numbers_of_records(numbers_of_records);
+        std::sort(sorted_numbers_of_records.begin(), sorted_numbers_of_records.end());
+        cutoff = masked_keys_cutoff(
+            sorted_numbers_of_records, header.mask_above, header.mask_top_fraction);
+    }
+    std::vector<uint64_t> masked(number_of_mask_words(header.num_keys), 0);
+    uint64_t key_number = 0, number_of_masked_keys = 0;
+    for_each_merged_key(inputs,
+        [&](const uint64_t&,
+            const std::vector<std::pair<size_t, uint64_t>>& positions) {
+            bool is_masked
+                = with_mask_cutoff and numbers_of_records[key_number] > cutoff;
+            for (const auto& position : positions) {
+                const auto& input = inputs[position.first];
+                is_masked |= !input.has_mask_cutoff and input.arrays.masked != nullptr
+                    and is_masked_key(input.arrays.masked, position.second);
+            }
+            if (is_masked) {
+                masked[key_number / 64] |= 1ull << (key_number % 64);
+            }
+            number_of_masked_keys += is_masked_key(masked.data(), key_number);
+            ++key_number;
+        });
+    writer.write_section(IndexSection::MaskedKeys, masked);
+
+    if (header.num_keys > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("Too many keys to merge into " + outfile.string());
+    }
+    const auto for_each_key
+        = [&inputs](const std::function<void(const uint64_t&)>& callback) {
+              for_each_merged_key(inputs,
+                  [&callback](const uint64_t& key,
+                      const std::vector<std::pair<size_t, uint64_t>>&) {
+                      callback(key);
+                  });
+          };
+    const MinimalPerfectHash mphf(header.num_keys, for_each_key);
+    std::vector<IndexFileSlot> slots(header.num_keys);
+    key_number = 0;
+    for_each_key([&](const uint64_t& key) {
+        slots[mphf.lookup(key)] = IndexFileSlot { (uint32_t)key_number,
+            MinimalPerfectHash::fingerprint(key) };
+        ++key_number;
+    });
+    write_mphf_sections(writer, mphf, slots.data());
+
+    if (with_membership_filter) {
+        const MembershipFilter filter(header.num_keys - number_of_masked_keys,
+            [&](const std::function<void(const uint64_t&)>& callback) {
+                key_number = 0;
+                for_each_key([&](const uint64_t& key) {
+                    if (!is_masked_key(masked.data(), key_number)) {
+                        callback(key);
+                    }
+                    ++key_number;
+                });
+            });
+        writer.begin_section(IndexSection::MembershipFilter, sizeof(uint64_t));
+        writer.append(filter.get_words(), filter.get_num_words() * sizeof(uint64_t));
+        writer.end_section();
+    }
+
+    writer.set_header(header);
+    writer.close();
+}
@@ -26,11 +26,55 @@ void setup_index_subcommand(CLI::App& app)
         ->type_name("INT")
         ->capture_default_str();
 
+    index_subcmd
+        ->add_option("--id-offset", opt->id_offset,
+            "Id of the first PRG, so that the indices of different PRG files can be "
+            "merged")
+        ->type_name("INT")
+        ->capture_default_str();
+
+    index_subcmd
+        ->add_option("--mask-above", opt->max_minimizer_records,
+            "Mask minimizers with more than INT records in the index (e.g. from "
+            "repeats): they are not looked up when mapping reads. 0 to disable")
+        ->type_name("INT")
+        ->capture_default_str();
+
+    index_subcmd
+        ->add_option("--mask-top-fraction", opt->mask_top_fraction,
+            "Mask this fraction of the most frequent minimizers")
+        ->check(CLI::Range(0.0, 1.0))
+        ->type_name("FLOAT")
+        ->capture_default_str();
+
+    index_subcmd
+        ->add_option("--max-sketch-paths", opt->max_sketch_paths,
+            "Budget of each PRG's sketch: PRGs whose k-mer paths exceed INT (e.g. "
+            "with deeply nested sites) are only sketched along representative paths, "
+            "and listed in <INDEX>.over_budget.tsv. 0 for no budget")
+        ->type_name("INT")
+        ->capture_default_str();
+
+    index_subcmd->add_flag("--membership-filter", opt->membership_filter,
+        "Store a Bloom filter of the minimizers in the index, which quickly rejects "
+        "most read minimizers not in the index");
+
     index_subcmd->add_option("-o,--outfile", opt->outfile, "Filename for the index")
         ->type_name("FILE")
         ->transform(make_absolute)
         ->default_str("<PRG>.kXX.wXX.idx");
 
+    index_subcmd->add_flag("--text-index", opt->text_index,
+        "Write the index in the text format, rather than the faster to load binary "
+        "format");
+
+    index_subcmd->add_flag("--append", opt->append,
+        "Only index the PRGs added to the end of <PRG> since it was last indexed, and "
+        "add them to the existing index");
+
+    index_subcmd->add_flag("--kmer-graphs-gfa", opt->kmer_graphs_gfa,
+        "Also write the k-mer graph of each PRG as a GFA file, e.g. for debugging");
+
     index_subcmd->add_flag(
         "-v", opt->verbosity, "Verbosity of logging. Repeat for increased verbosity");
 
@@ -54,28 +98,123 @@ int pandora_index(IndexOptions const& opt)
 
     LocalPRG::do_path_memoization_in_nodes_along_path_method = true;
 
+    fs::path indexfile { opt.outfile };
+    if (indexfile.empty()) {
+        const auto prefix { opt.id_offset > 0
+                ? opt.prgfile.string() + "." + std::to_string(opt.id_offset)
+                : opt.prgfile.string() };
+        indexfile = prefix + ".k" + std::to_string(opt.kmer_size) + ".w"
+            + std::to_string(opt.window_size) + ".idx";
+    }
+
+    // when appending, the PRGs already indexed are the first ones of the file
+    uint32_t number_of_prgs_indexed = 0;
+    if (opt.append) {
+        if (opt.text_index) {
+            fatal_error("--append can't be used with --text-index");
+        }
+        if (!fs::exists(indexfile) or !is_binary_index_file(indexfile)) {
+            fatal_error("--append needs an existing binary index " + indexfile.string()
+                + ", run pandora index without --append first");
+        }
+        const MappedIndexFile file(indexfile);
+        const auto& header = file.header();
+        if (header.num_prgs > 0 and header.prg_id_offset != opt.id_offset) {
+            fatal_error("Index " + indexfile.string() + " starts at PRG "
+                + std::to_string(header.prg_id_offset) + ", not at --id-offset "
+                + std::to_string(opt.id_offset));
+        }
+        number_of_prgs_indexed = header.num_prgs;
+        BOOST_LOG_TRIVIAL(info) << "Index " << indexfile << " has "
+                                << number_of_prgs_indexed << " PRGs";
+    }
+
     // load PRGs from file
     std::vector<std::shared_ptr<LocalPRG>> prgs;
-    read_prg_file(prgs, opt.prgfile, opt.id_offset);
-
-    // get output directory for the gfa
-    const auto kmer_prgs_outdir { opt.prgfile.parent_path() / "kmer_prgs" };
+    std::vector<std::string> indexed_prg_names;
+    read_prg_file(prgs, opt.prgfile, opt.id_offset, number_of_prgs_indexed, false,
+        opt.threads, &indexed_prg_names);
+    if (opt.append) {
+        // the PRGs indexed must not have been edited since, or the new ones would get
+        // the ids of others
+        try {
+            check_archived_prg_names(opt.prgfile, opt.window_size, opt.kmer_size,
+                opt.id_offset, indexed_prg_names);
+        } catch (const std::runtime_error& err) {
+            fatal_error(err.what());
+        }
+    }
+    if (opt.append and prgs.empty()) {
+        BOOST_LOG_TRIVIAL(info) << "No PRG to append, all done!";
+        return 0;
+    }
 
     BOOST_LOG_TRIVIAL(info) << "Indexing PRG...";
     auto index = std::make_shared<Index>();
-    index_prgs(
-        prgs, index, opt.window_size, opt.kmer_size, kmer_prgs_outdir, opt.threads);
+    const auto prgs_over_budget { index_prgs(prgs, index, opt.window_size,
+        opt.kmer_size, opt.threads, opt.max_sketch_paths) };
+
+    // the PRGs sketched along their representative paths only, also those appended
+    const fs::path over_budget_file { indexfile.string() + ".over_budget.tsv" };
+    if (!opt.append) {
+        fs::remove(over_budget_file);
+    }
+    if (!prgs_over_budget.empty()) {
+        BOOST_LOG_TRIVIAL(warning)
+            << prgs_over_budget.size() << " PRGs exceeded the budget of "
+            << opt.max_sketch_paths
+            << " k-mer paths, so only their representative paths are sketched. They "
+               "are listed in "
+            << over_budget_file;
+        std::ofstream handle(over_budget_file.string(), std::ios::app);
+        for (const auto& prg_id : prgs_over_budget) {
+            handle << prg_id << "\t" << prgs[prg_id - prgs.front()->id]->name << "\n";
+        }
+        handle.close();
+        if (handle.fail()) {
+            fatal_error("Unable to write " + over_budget_file.string());
+        }
+    }
+
+    // the PRGs appended get their own archive, so the existing ones are not rewritten.
+    // It is named from the ids, as a PRG file may have no PRG
+    const auto kmer_graph_archive { kmer_graph_archive_file(opt.prgfile,
+        opt.window_size, opt.kmer_size, opt.id_offset + number_of_prgs_indexed) };
+    BOOST_LOG_TRIVIAL(info) << "Saving k-mer graphs to " << kmer_graph_archive;
+    try {
+        fs::create_directories(kmer_graph_archive.parent_path());
+        save_kmer_graph_archive(
+            kmer_graph_archive, prgs, opt.window_size, opt.kmer_size);
+    } catch (const std::runtime_error& err) {
+        fatal_error(err.what());
+    }
+    if (opt.kmer_graphs_gfa) {
+        save_PRG_kmergraphs_as_gfa(prgs, opt.window_size, opt.kmer_size,
+            opt.prgfile.parent_path() / "kmer_prgs", opt.threads);
+    }
+
+    index->with_membership_filter = opt.membership_filter;
+    if (opt.append) {
+        // the minimizers are masked once merged into the index, see append_to()
+        index->mask_above = opt.max_minimizer_records;
+        index->mask_top_fraction = opt.mask_top_fraction;
+    } else {
+        index->mask_frequent_minimizers(
+            opt.max_minimizer_records, opt.mask_top_fraction);
+    }
 
     // save index
-    BOOST_LOG_TRIVIAL(info) << "Saving index...";
-    if (not opt.outfile.empty()) {
-        index->save(opt.outfile);
-    } else if (opt.id_offset > 0) {
-        const fs::path outfile { opt.prgfile.string() + "."
-            + std::to_string(opt.id_offset) };
-        index->save(outfile, opt.window_size, opt.kmer_size);
+    if (opt.append) {
+        BOOST_LOG_TRIVIAL(info) << "Appending " << prgs.size() << " PRGs to index...";
+        try {
+            index->append_to(indexfile);
+        } catch (const std::runtime_error& err) {
+            fatal_error(err.what());
+        }
     } else {
-        index->save(opt.prgfile, opt.window_size, opt.kmer_size);
+        BOOST_LOG_TRIVIAL(info) << "Saving index...";
+        const auto format { opt.text_index ? IndexFormat::Text : IndexFormat::Binary };
+        index->save(indexfile, format);
     }
 
     BOOST_LOG_TRIVIAL(info) << "All done!";
@@ -1,8 +1,14 @@
+#include <algorithm>
 #include <iostream>
 #include <cassert>
 #include <cstring>
 #include "inthash.h"
 
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define PANDORA_X86_KERNELS
+#include <immintrin.h>
+#endif
+
 /* Taken from Heng Li minimap https://github.com/lh3/minimap/blob/master/sketch.c
  *
  * Licence for this repository:
@@ -114,34 +120,287 @@ uint64_t hash64(uint64_t key, const uint64_t& mask)
     return key;
 }
 
-/* Now use these functions in my own code */
+namespace {
+// letters are encoded by blocks of this many, then rolled into k-mers one by one
+constexpr uint32_t ENCODE_BLOCK_SIZE = 32;
 
-std::pair<uint64_t, uint64_t> KmerHash::kmerhash(const std::string& s, const uint32_t k)
+// encodes letters[0, n) into codes, returns the number of letters before the first non
+// ACGT one
+uint32_t encode_scalar(const char* letters, const uint32_t& n, uint8_t* codes)
+{
+    for (uint32_t i = 0; i < n; ++i) {
+        codes[i] = seq_nt4_table[(uint8_t)letters[i]];
+        if (codes[i] > 3) {
+            return i;
+        }
+    }
+    return n;
+}
+
+uint32_t encode_block_scalar(const char* letters, uint8_t* codes)
 {
-    // if we've already worked out the answer, return
-    auto it = lookup.find(s); // checks if this string is already in the hash
-    if (it != lookup.end()) {
-        return it->second;
+    return encode_scalar(letters, ENCODE_BLOCK_SIZE, codes);
+}
+
+void hash_array_scalar(uint64_t* keys, const uint32_t& n, const uint64_t& mask)
+{
+    for (uint32_t i = 0; i < n; ++i) {
+        keys[i] = hash64(keys[i], mask);
     }
+}
+
+#ifdef PANDORA_X86_KERNELS
+// Vector versions of the scalar functions above. A letter is ACGT if it is one of
+// acgt once lowercased (| 0x20), and its code is then the bits 1-2 of its ASCII value
+// (a=0, c=1, g=3, t=2) with bit 0 flipped when bit 1 is set, as in seq_nt4_table.
+__attribute__((target("sse2"))) __m128i encode_sse2(
+    const __m128i& letters, uint32_t& valid_bits)
+{
+    const __m128i lowercase = _mm_or_si128(letters, _mm_set1_epi8(0x20));
+    const __m128i valid = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(lowercase, _mm_set1_epi8('a')),
+            _mm_cmpeq_epi8(lowercase, _mm_set1_epi8('c'))),
+        _mm_or_si128(_mm_cmpeq_epi8(lowercase, _mm_set1_epi8('g')),
+            _mm_cmpeq_epi8(lowercase, _mm_set1_epi8('t'))));
+    valid_bits = _mm_movemask_epi8(valid);
+    const __m128i codes = _mm_and_si128(_mm_srli_epi16(letters, 1), _mm_set1_epi8(3));
+    return _mm_xor_si128(
+        codes, _mm_and_si128(_mm_srli_epi16(codes, 1), _mm_set1_epi8(1)));
+}
+
+__attribute__((target("sse2"))) uint32_t encode_block_sse2(
+    const char* letters, uint8_t* codes)
+{
+    uint32_t valid_bits = 0;
+    for (uint32_t i = 0; i < ENCODE_BLOCK_SIZE; i += 16) {
+        uint32_t block_valid_bits;
+        const __m128i block_codes = encode_sse2(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(letters + i)),
+            block_valid_bits);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(codes + i), block_codes);
+        valid_bits |= block_valid_bits << i;
+    }
+    return valid_bits == 0xFFFFFFFF ? ENCODE_BLOCK_SIZE : __builtin_ctz(~valid_bits);
+}
+
+__attribute__((target("avx2"))) uint32_t encode_block_avx2(
+    const char* letters, uint8_t* codes)
+{
+    const __m256i block
+        = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(letters));
+    const __m256i lowercase = _mm256_or_si256(block, _mm256_set1_epi8(0x20));
+    const __m256i valid = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(lowercase, _mm256_set1_epi8('a')),
+            _mm256_cmpeq_epi8(lowercase, _mm256_set1_epi8('c'))),
+        _mm256_or_si256(_mm256_cmpeq_epi8(lowercase, _mm256_set1_epi8('g')),
+            _mm256_cmpeq_epi8(lowercase, _mm256_set1_epi8('t'))));
+    __m256i block_codes
+        = _mm256_and_si256(_mm256_srli_epi16(block, 1), _mm256_set1_epi8(3));
+    block_codes = _mm256_xor_si256(block_codes,
+        _mm256_and_si256(_mm256_srli_epi16(block_codes, 1), _mm256_set1_epi8(1)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(codes), block_codes);
+    const uint32_t valid_bits = _mm256_movemask_epi8(valid);
+    return valid_bits == 0xFFFFFFFF ? ENCODE_BLOCK_SIZE : __builtin_ctz(~valid_bits);
+}
+
+// hash64() on 2 keys at a time
+__attribute__((target("sse2"))) void hash_array_sse2(
+    uint64_t* keys, const uint32_t& n, const uint64_t& mask)
+{
+    const __m128i vector_mask = _mm_set1_epi64x(mask);
+    const __m128i ones = _mm_set1_epi64x(-1);
+    uint32_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i key = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i));
+        key = _mm_and_si128(
+            _mm_add_epi64(_mm_xor_si128(key, ones), _mm_slli_epi64(key, 21)),
+            vector_mask);
+        key = _mm_xor_si128(key, _mm_srli_epi64(key, 24));
+        key = _mm_and_si128(_mm_add_epi64(_mm_add_epi64(key, _mm_slli_epi64(key, 3)),
+                                _mm_slli_epi64(key, 8)),
+            vector_mask);
+        key = _mm_xor_si128(key, _mm_srli_epi64(key, 14));
+        key = _mm_and_si128(_mm_add_epi64(_mm_add_epi64(key, _mm_slli_epi64(key, 2)),
+                                _mm_slli_epi64(key, 4)),
+            vector_mask);
+        key = _mm_xor_si128(key, _mm_srli_epi64(key, 28));
+        key = _mm_and_si128(_mm_add_epi64(key, _mm_slli_epi64(key, 31)), vector_mask);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(keys + i), key);
+    }
+    hash_array_scalar(keys + i, n - i, mask);
+}
+
+// hash64() on 4 keys at a time
+__attribute__((target("avx2"))) void hash_array_avx2(
+    uint64_t* keys, const uint32_t& n, const uint64_t& mask)
+{
+    const __m256i vector_mask = _mm256_set1_epi64x(mask);
+    const __m256i ones = _mm256_set1_epi64x(-1);
+    uint32_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i key = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+        key = _mm256_and_si256(
+            _mm256_add_epi64(_mm256_xor_si256(key, ones), _mm256_slli_epi64(key, 21)),
+            vector_mask);
+        key = _mm256_xor_si256(key, _mm256_srli_epi64(key, 24));
+        key = _mm256_and_si256(
+            _mm256_add_epi64(_mm256_add_epi64(key, _mm256_slli_epi64(key, 3)),
+                _mm256_slli_epi64(key, 8)),
+            vector_mask);
+        key = _mm256_xor_si256(key, _mm256_srli_epi64(key, 14));
+        key = _mm256_and_si256(
+            _mm256_add_epi64(_mm256_add_epi64(key, _mm256_slli_epi64(key, 2)),
+                _mm256_slli_epi64(key, 4)),
+            vector_mask);
+        key = _mm256_xor_si256(key, _mm256_srli_epi64(key, 28));
+        key = _mm256_and_si256(
+            _mm256_add_epi64(key, _mm256_slli_epi64(key, 31)), vector_mask);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(keys + i), key);
+    }
+    hash_array_scalar(keys + i, n - i, mask);
+}
+#endif
+}
 
+KmerHashKernel best_kmer_hash_kernel()
+{
+#ifdef PANDORA_X86_KERNELS
+    static const KmerHashKernel best = __builtin_cpu_supports("avx2")
+        ? KmerHashKernel::AVX2
+        : (__builtin_cpu_supports("sse2") ? KmerHashKernel::SSE2
+                                          : KmerHashKernel::Scalar);
+    return best;
+#else
+    return KmerHashKernel::Scalar;
+#endif
+}
+
+bool kmer_hash_kernel_supported(const KmerHashKernel& kernel)
+{
+    return kernel <= best_kmer_hash_kernel();
+}
+
+namespace {
+// The k-mers of the given sequence rolled letter by letter, as Seq used to, then
+// hashed all together. K is either the k-mer size, so that the masks and shifts are
+// constants, or 0 for any k-mer size.
+template <uint32_t K>
+uint32_t hash_kmers_of_size(const char* seq, const uint32_t& length,
+    const uint32_t& any_k, uint64_t* forward_hashes, uint64_t* reverse_hashes,
+    uint32_t (*encode_full_block)(const char*, uint8_t*),
+    void (*hash_array)(uint64_t*, const uint32_t&, const uint64_t&))
+{
+    const uint32_t k = K == 0 ? any_k : K;
+    const uint64_t shift1 = 2 * (k - 1), mask = (1ULL << 2 * k) - 1;
+    uint64_t kmer[2] = { 0, 0 };
+    uint8_t codes[ENCODE_BLOCK_SIZE];
+    uint32_t number_encoded = 0;
+    while (number_encoded < length) {
+        const uint32_t block_size
+            = std::min(ENCODE_BLOCK_SIZE, length - number_encoded);
+        const uint32_t number_valid = block_size == ENCODE_BLOCK_SIZE
+            ? encode_full_block(seq + number_encoded, codes)
+            : encode_scalar(seq + number_encoded, block_size, codes);
+        for (uint32_t i = 0; i < number_valid; ++i) {
+            kmer[0] = (kmer[0] << 2 | codes[i]) & mask; // forward k-mer
+            kmer[1] = (kmer[1] >> 2) | (3ULL ^ codes[i]) << shift1; // reverse k-mer
+            const uint32_t kmer_end = number_encoded + i + 1;
+            if (kmer_end >= k) {
+                forward_hashes[kmer_end - k] = kmer[0];
+                reverse_hashes[kmer_end - k] = kmer[1];
+            }
+        }
+        number_encoded += number_valid;
+        if (number_valid < block_size) {
+            break;
+        }
+    }
+    if (number_encoded >= k) {
+        hash_array(forward_hashes, number_encoded - k + 1, mask);
+        hash_array(reverse_hashes, number_encoded - k + 1, mask);
+    }
+    return number_encoded;
+}
+}
+
+uint32_t hash_kmers(const char* seq, const uint32_t& length, const uint32_t& k,
+    uint64_t* forward_hashes, uint64_t* reverse_hashes, const KmerHashKernel& kernel)
+{
+    assert(kmer_hash_kernel_supported(kernel));
+    uint32_t (*encode_full_block)(const char*, uint8_t*) = encode_block_scalar;
+    void (*hash_array)(uint64_t*, const uint32_t&, const uint64_t&) = hash_array_scalar;
+#ifdef PANDORA_X86_KERNELS
+    if (kernel == KmerHashKernel::AVX2) {
+        encode_full_block = encode_block_avx2;
+        hash_array = hash_array_avx2;
+    } else if (kernel == KmerHashKernel::SSE2) {
+        encode_full_block = encode_block_sse2;
+        hash_array = hash_array_sse2;
+    }
+#endif
+
+    // the default k-mer size has its own kernel
+    if (k == 15) {
+        return hash_kmers_of_size<15>(seq, length, k, forward_hashes, reverse_hashes,
+            encode_full_block, hash_array);
+    }
+    return hash_kmers_of_size<0>(seq, length, k, forward_hashes, reverse_hashes,
+        encode_full_block, hash_array);
+}
+
+/* Now use these functions in my own code */
+
+std::pair<uint64_t, uint64_t> KmerHash::kmerhash(const std::string& s, const uint32_t k)
+{
     // this takes the hash of both forwards and reverse complement kmers and returns
     // them as a pair
     assert(s.size() == k);
-    int c;
-    uint64_t shift1 = 2 * (k - 1), mask = (1ULL << 2 * k) - 1, kmer[2] = { 0, 0 };
-    char myArray[s.size() + 1]; // as 1 char space for null is also required
-    strcpy(myArray, s.c_str());
-    for (char i : s) {
-        c = seq_nt4_table[(uint8_t)i];
-        if (c < 4) { // not an ambiguous base
-            kmer[0] = (kmer[0] << 2 | c) & mask; // forward k-mer
-            kmer[1] = (kmer[1] >> 2) | (3ULL ^ c) << shift1; // reverse k-mer
+    uint64_t kmer[2];
+    if (hash_kmers(s.data(), k, k, kmer, kmer + 1) < k) {
+        // ambiguous bases are skipped
+        int c;
+        uint64_t shift1 = 2 * (k - 1), mask = (1ULL << 2 * k) - 1;
+        kmer[0] = kmer[1] = 0;
+        for (char i : s) {
+            c = seq_nt4_table[(uint8_t)i];
+            if (c < 4) { // not an ambiguous base
+                kmer[0] = (kmer[0] << 2 | c) & mask; // forward k-mer
+                kmer[1] = (kmer[1] >> 2) | (3ULL ^ c) << shift1; // reverse k-mer
+            }
         }
+        kmer[0] = hash64(kmer[0], mask);
+        kmer[1] = hash64(kmer[1], mask);
     }
-    kmer[0] = hash64(kmer[0], mask);
-    kmer[1] = hash64(kmer[1], mask);
 
-    auto ret = std::make_pair(kmer[0], kmer[1]);
-    lookup[s] = ret;
-    return ret;
+    return std::make_pair(kmer[0], kmer[1]);
+}
+
+void hash_every_kmer(const std::string& seq, const uint32_t& k,
+    std::vector<uint64_t>& forward_hashes, std::vector<uint64_t>& reverse_hashes)
+{
+    const uint32_t number_kmers = seq.length() < k ? 0 : seq.length() + 1 - k;
+    forward_hashes.resize(seq.length());
+    reverse_hashes.resize(seq.length());
+    KmerHash hash;
+    uint32_t stretch_start = 0;
+    while (stretch_start < number_kmers) {
+        const uint32_t stretch_end = stretch_start
+            + hash_kmers(seq.data() + stretch_start, seq.length() - stretch_start, k,
+                forward_hashes.data() + stretch_start,
+                reverse_hashes.data() + stretch_start);
+        if (stretch_end == seq.length()) {
+            break;
+        }
+        // the k-mers over the non ACGT letter at stretch_end
+        const uint32_t first_kmer
+            = std::max(stretch_start, stretch_end + 1 < k ? 0 : stretch_end + 1 - k);
+        for (uint32_t i = first_kmer; i <= stretch_end and i < number_kmers; ++i) {
+            const auto kh = hash.kmerhash(seq.substr(i, k), k);
+            forward_hashes[i] = kh.first;
+            reverse_hashes[i] = kh.second;
+        }
+        stretch_start = stretch_end + 1;
+    }
+    forward_hashes.resize(number_kmers);
+    reverse_hashes.resize(number_kmers);
 }
@@ -386,6 +386,11 @@ uint32_t KmerGraph::min_path_length()
         return shortest_path_length;
     }
 
+    // a lazy PRG without an archived graph has no nodes, and no path
+    if (sorted_nodes.empty()) {
+        return 0;
+    }
+
 #ifndef NDEBUG
     // TODO: check if tests must be updated or not due to this (I think not -
     // sorted_nodes is always sorted) if this is added, some tests bug, since it was not
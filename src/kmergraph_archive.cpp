@@ -0,0 +1,314 @@
+#include <cstring>
+#include <stdexcept>
+
+#include <boost/filesystem/fstream.hpp>
+
+#include "kmergraph_archive.h"
+#include "kmergraph.h"
+#include "localPRG.h"
+
+KmerGraphArchiveHeader::KmerGraphArchiveHeader()
+    : version { KMERGRAPH_ARCHIVE_VERSION }
+    , byte_order_mark { KMERGRAPH_ARCHIVE_BYTE_ORDER_MARK }
+    , w { 0 }
+    , k { 0 }
+    , prg_id_offset { 0 }
+    , num_prgs { 0 }
+    , num_nodes { 0 }
+    , num_intervals { 0 }
+    , num_edges { 0 }
+    , num_name_chars { 0 }
+    , graphs_offset { 0 }
+    , path_offsets_offset { 0 }
+    , intervals_offset { 0 }
+    , edges_offset { 0 }
+    , names_offset { 0 }
+{
+    std::memcpy(magic, KMERGRAPH_ARCHIVE_MAGIC, sizeof(magic));
+}
+
+namespace {
+uint64_t align(const uint64_t& offset)
+{
+    return (offset + KMERGRAPH_ARCHIVE_ALIGNMENT - 1) / KMERGRAPH_ARCHIVE_ALIGNMENT
+        * KMERGRAPH_ARCHIVE_ALIGNMENT;
+}
+
+void pad_to(fs::ofstream& handle, const uint64_t& offset)
+{
+    const uint64_t position = handle.tellp();
+    const std::vector<char> padding(offset - position, 0);
+    handle.write(padding.data(), padding.size());
+}
+}
+
+fs::path kmer_graph_archive_file(const fs::path& prgfile, const uint32_t& w,
+    const uint32_t& k, const uint32_t& id_offset)
+{
+    auto filename { prgfile.filename().string() };
+    if (id_offset > 0) {
+        filename += "." + std::to_string(id_offset);
+    }
+    filename += ".k" + std::to_string(k) + ".w" + std::to_string(w) + ".kga";
+    return prgfile.parent_path() / "kmer_prgs" / filename;
+}
+
+void save_kmer_graph_archive(const fs::path& filepath,
+    const std::vector<std::shared_ptr<LocalPRG>>& prgs, const uint32_t& w,
+    const uint32_t& k)
+{
+    KmerGraphArchiveHeader header;
+    header.w = w;
+    header.k = k;
+    header.prg_id_offset = prgs.empty() ? 0 : prgs.front()->id;
+    header.num_prgs = prgs.size();
+    for (const auto& prg : prgs) {
+        for (const auto& node : prg->kmer_prg.nodes) {
+            header.num_intervals += node->path.getPath().size();
+            header.num_edges += node->out_nodes.size();
+        }
+        header.num_nodes += prg->kmer_prg.nodes.size();
+        header.num_name_chars += prg->name.size();
+    }
+    header.graphs_offset = align(sizeof(KmerGraphArchiveHeader));
+    header.path_offsets_offset = align(
+        header.graphs_offset + (header.num_prgs + 1) * sizeof(KmerGraphArchiveEntry));
+    header.intervals_offset = align(
+        header.path_offsets_offset + (header.num_nodes + 1) * sizeof(uint64_t));
+    header.edges_offset
+        = align(header.intervals_offset + header.num_intervals * sizeof(Interval));
+    header.names_offset = align(
+        header.edges_offset + header.num_edges * sizeof(KmerGraphArchiveEdge));
+
+    fs::ofstream handle(filepath, std::ios::binary | std::ios::trunc);
+    if (!handle.is_open()) {
+        throw std::runtime_error(
+            "Unable to open k-mer graph archive " + filepath.string() + " for writing");
+    }
+    handle.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    pad_to(handle, header.graphs_offset);
+    KmerGraphArchiveEntry entry { 0, 0, 0 };
+    for (const auto& prg : prgs) {
+        handle.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+        for (const auto& node : prg->kmer_prg.nodes) {
+            entry.first_edge += node->out_nodes.size();
+        }
+        entry.first_node += prg->kmer_prg.nodes.size();
+        entry.first_name_char += prg->name.size();
+    }
+    handle.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+
+    pad_to(handle, header.path_offsets_offset);
+    uint64_t path_offset = 0;
+    for (const auto& prg : prgs) {
+        for (const auto& node : prg->kmer_prg.nodes) {
+            handle.write(reinterpret_cast<const char*>(&path_offset), sizeof(uint64_t));
+            path_offset += node->path.getPath().size();
+        }
+    }
+    handle.write(reinterpret_cast<const char*>(&path_offset), sizeof(uint64_t));
+
+    pad_to(handle, header.intervals_offset);
+    for (const auto& prg : prgs) {
+        for (const auto& node : prg->kmer_prg.nodes) {
+            const auto& intervals = node->path.getPath();
+            handle.write(reinterpret_cast<const char*>(intervals.data()),
+                intervals.size() * sizeof(Interval));
+        }
+    }
+
+    // in the order of KmerGraph::save(), so that the graphs are rebuilt exactly as
+    // from their GFA files
+    pad_to(handle, header.edges_offset);
+    for (const auto& prg : prgs) {
+        for (const auto& node : prg->kmer_prg.nodes) {
+            for (const auto& out_node : node->out_nodes) {
+                const KmerGraphArchiveEdge edge { node->id, out_node.lock()->id };
+                handle.write(reinterpret_cast<const char*>(&edge), sizeof(edge));
+            }
+        }
+    }
+
+    pad_to(handle, header.names_offset);
+    for (const auto& prg : prgs) {
+        handle.write(prg->name.data(), prg->name.size());
+    }
+
+    handle.close();
+    if (handle.fail()) {
+        throw std::runtime_error(
+            "Unable to write k-mer graph archive " + filepath.string());
+    }
+}
+
+void check_archived_prg_names(const fs::path& prgfile, const uint32_t& w,
+    const uint32_t& k, const uint32_t& id_offset,
+    const std::vector<std::string>& prg_names)
+{
+    // the PRGs appended to an index have an archive of their own, after the others
+    uint32_t prg_id = id_offset;
+    const uint64_t end_prg_id = (uint64_t)id_offset + prg_names.size();
+    while (prg_id < end_prg_id) {
+        const auto archive_file { kmer_graph_archive_file(prgfile, w, k, prg_id) };
+        if (!fs::exists(archive_file)) {
+            throw std::runtime_error("No k-mer graph archive " + archive_file.string()
+                + " to check PRG " + std::to_string(prg_id) + " of " + prgfile.string()
+                + " against");
+        }
+        const KmerGraphArchive archive(archive_file);
+        if (!archive.contains(prg_id)) {
+            throw std::runtime_error("K-mer graph archive " + archive_file.string()
+                + " does not have PRG " + std::to_string(prg_id)
+                + ", which was indexed");
+        }
+        for (; prg_id < end_prg_id and archive.contains(prg_id); ++prg_id) {
+            const auto& name = prg_names[prg_id - id_offset];
+            if (archive.prg_name(prg_id) != name) {
+                throw std::runtime_error("PRG " + std::to_string(prg_id) + " of "
+                    + prgfile.string() + " is " + name + ", but "
+                    + archive.prg_name(prg_id)
+                    + " was indexed: only PRGs added to the end of the file can be "
+                      "appended to its index");
+            }
+        }
+    }
+}
+
+template <typename T>
+const T* KmerGraphArchive::array(
+    const uint64_t& offset, const uint64_t& number_of_elements) const
+{
+    if (offset % alignof(T) != 0 or offset > file.size()
+        or number_of_elements > (file.size() - offset) / sizeof(T)) {
+        throw std::runtime_error("K-mer graph archive " + filepath.string()
+            + " is truncated or corrupted");
+    }
+    return reinterpret_cast<const T*>(file.data() + offset);
+}
+
+KmerGraphArchive::KmerGraphArchive(const fs::path& filepath)
+    : filepath(filepath)
+{
+    if (!fs::exists(filepath)) {
+        throw std::runtime_error(
+            "K-mer graph archive " + filepath.string() + " does not exist");
+    }
+    if (fs::file_size(filepath) < sizeof(KmerGraphArchiveHeader)) {
+        throw std::runtime_error(filepath.string() + " is not a k-mer graph archive");
+    }
+    file.open(filepath.string());
+
+    header_ptr = reinterpret_cast<const KmerGraphArchiveHeader*>(file.data());
+    const auto& header = *header_ptr;
+    if (std::memcmp(header.magic, KMERGRAPH_ARCHIVE_MAGIC, sizeof(header.magic))
+        != 0) {
+        throw std::runtime_error(filepath.string() + " is not a k-mer graph archive");
+    }
+    if (header.byte_order_mark != KMERGRAPH_ARCHIVE_BYTE_ORDER_MARK) {
+        throw std::runtime_error("K-mer graph archive " + filepath.string()
+            + " was written on a machine with a different byte order");
+    }
+    if (header.version != KMERGRAPH_ARCHIVE_VERSION) {
+        throw std::runtime_error("K-mer graph archive " + filepath.string()
+            + " has version " + std::to_string(header.version)
+            + ", but this pandora reads version "
+            + std::to_string(KMERGRAPH_ARCHIVE_VERSION)
+            + ". Please rerun pandora index");
+    }
+
+    graphs = array<KmerGraphArchiveEntry>(
+        header.graphs_offset, (uint64_t)header.num_prgs + 1);
+    path_offsets = array<uint64_t>(header.path_offsets_offset, header.num_nodes + 1);
+    intervals = array<Interval>(header.intervals_offset, header.num_intervals);
+    edges = array<KmerGraphArchiveEdge>(header.edges_offset, header.num_edges);
+    names = array<char>(header.names_offset, header.num_name_chars);
+
+    // check all offsets and edges now, so that load() doesn't need to
+    const auto corrupted = [&filepath]() {
+        return std::runtime_error(
+            "K-mer graph archive " + filepath.string() + " is corrupted");
+    };
+    const auto& last = graphs[header.num_prgs];
+    if (graphs[0].first_node != 0 or graphs[0].first_edge != 0
+        or graphs[0].first_name_char != 0 or last.first_node != header.num_nodes
+        or last.first_edge != header.num_edges
+        or last.first_name_char != header.num_name_chars) {
+        throw corrupted();
+    }
+    for (uint32_t i = 0; i < header.num_prgs; ++i) {
+        const auto& graph = graphs[i];
+        const auto& next_graph = graphs[i + 1];
+        if (next_graph.first_node < graph.first_node
+            or next_graph.first_edge < graph.first_edge
+            or next_graph.first_name_char < graph.first_name_char) {
+            throw corrupted();
+        }
+        const uint64_t num_graph_nodes = next_graph.first_node - graph.first_node;
+        for (uint64_t j = graph.first_edge; j < next_graph.first_edge; ++j) {
+            if (edges[j].from >= num_graph_nodes or edges[j].to >= num_graph_nodes) {
+                throw corrupted();
+            }
+        }
+    }
+    if (path_offsets[0] != 0
+        or path_offsets[header.num_nodes] != header.num_intervals) {
+        throw corrupted();
+    }
+    for (uint64_t j = 0; j < header.num_nodes; ++j) {
+        if (path_offsets[j + 1] < path_offsets[j]) {
+            throw corrupted();
+        }
+    }
+}
+
+bool KmerGraphArchive::contains(const uint32_t& prg_id) const
+{
+    return prg_id >= header_ptr->prg_id_offset
+        and prg_id - header_ptr->prg_id_offset < header_ptr->num_prgs;
+}
+
+std::string KmerGraphArchive::prg_name(const uint32_t& prg_id) const
+{
+    const uint32_t i = prg_id - header_ptr->prg_id_offset;
+    return std::string(names + graphs[i].first_name_char,
+        names + graphs[i + 1].first_name_char);
+}
+
+void KmerGraphArchive::load(const uint32_t& prg_id, KmerGraph& kmer_graph) const
+{
+    kmer_graph.clear();
+
+    const uint32_t i = prg_id - header_ptr->prg_id_offset;
+    const auto& graph = graphs[i];
+    const auto& next_graph = graphs[i + 1];
+    const uint64_t num_graph_nodes = next_graph.first_node - graph.first_node;
+
+    kmer_graph.nodes.reserve(num_graph_nodes);
+    prg::Path path;
+    for (uint64_t j = 0; j < num_graph_nodes; ++j) {
+        const uint64_t* path_offset = path_offsets + graph.first_node + j;
+        path.initialize(intervals + path_offset[0], intervals + path_offset[1]);
+        const auto kmer_node = std::make_shared<KmerNode>(j, path);
+        kmer_graph.nodes.push_back(kmer_node);
+        kmer_graph.sorted_nodes.insert(kmer_node);
+        if (kmer_graph.k == 0 and path.length() > 0) {
+            kmer_graph.k = path.length();
+        }
+    }
+
+    std::vector<uint32_t> outnode_counts(num_graph_nodes, 0),
+        innode_counts(num_graph_nodes, 0);
+    for (uint64_t j = graph.first_edge; j < next_graph.first_edge; ++j) {
+        ++outnode_counts[edges[j].from];
+        ++innode_counts[edges[j].to];
+    }
+    for (const auto& kmer_node : kmer_graph.nodes) {
+        kmer_node->out_nodes.reserve(outnode_counts[kmer_node->id]);
+        kmer_node->in_nodes.reserve(innode_counts[kmer_node->id]);
+    }
+    for (uint64_t j = graph.first_edge; j < next_graph.first_edge; ++j) {
+        kmer_graph.add_edge(
+            kmer_graph.nodes[edges[j].from], kmer_graph.nodes[edges[j].to]);
+    }
+}
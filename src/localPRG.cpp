@@ -18,14 +18,24 @@
 
 bool LocalPRG::do_path_memoization_in_nodes_along_path_method = false;
 
-LocalPRG::LocalPRG(uint32_t id, const std::string& name, const std::string& seq)
+LocalPRG::LocalPRG(
+    uint32_t id, const std::string& name, const std::string& seq, bool lazy)
     : next_id(0)
     , buff(" ")
+    , materialized(!lazy)
     , next_site(5)
+    , site_nesting_depth(0)
     , id(id)
     , name(name)
     , seq(seq)
     , num_hits(2, 0)
+{
+    if (!lazy) {
+        build_local_graph();
+    }
+}
+
+void LocalPRG::build_local_graph()
 {
     std::vector<uint32_t>
         v; // TODO: v is not used - safe to delete - but is passed as a parameter...
@@ -40,6 +50,34 @@ LocalPRG::LocalPRG(uint32_t id, const std::string& name, const std::string& seq)
     prg.intervalTree.index();
 }
 
+void LocalPRG::materialize()
+{
+    materialized.call_once([this]() {
+        build_local_graph();
+        if (kmer_graph_loader) {
+            kmer_graph_loader(kmer_prg);
+            kmer_graph_loader = nullptr;
+            // cached now, so that threads only ever read it
+            if (!kmer_prg.nodes.empty()) {
+                kmer_prg.min_path_length();
+            }
+        }
+    });
+}
+
+uint64_t LocalPRG::sketch_cost() const
+{
+    // the k-mer paths through a site multiply with the alleles of its nested sites
+    const uint32_t nesting_factor = 1u << std::min(site_nesting_depth, 16u);
+    return seq.length() + (uint64_t)prg.nodes.size() * nesting_factor;
+}
+
+void LocalPRG::set_kmer_graph_loader(const std::function<void(KmerGraph&)>& loader)
+{
+    assert(!is_materialized());
+    kmer_graph_loader = loader;
+}
+
 bool LocalPRG::isalpha_string(const std::string& s) const
 {
     // Returns if a string s is entirely alphabetic
@@ -73,12 +111,17 @@ std::string LocalPRG::string_along_path(const std::vector<LocalNodePtr>& p)
     return s;
 }
 
-std::vector<LocalNodePtr> LocalPRG::nodes_along_path(prg::Path& p) const
+std::vector<LocalNodePtr> LocalPRG::nodes_along_path(const prg::Path& p) const
 {
-    if (do_path_memoization_in_nodes_along_path_method)
-        return p.nodes_along_path(*this); // memoized version
-    else
+    if (do_path_memoization_in_nodes_along_path_method) { // memoized version
+        auto it = nodes_along_path_memo.find(p);
+        if (it == nodes_along_path_memo.end()) {
+            it = nodes_along_path_memo.emplace(p, nodes_along_path_core(p)).first;
+        }
+        return it->second;
+    } else {
         return nodes_along_path_core(p); // non-memoized version
+    }
 }
 
 std::vector<LocalNodePtr> LocalPRG::nodes_along_path_core(const prg::Path& p) const
@@ -313,6 +356,7 @@ LocalPRG::build_graph(
             std::exit(-1);
         }
         next_site += 2; // update next site
+        site_nesting_depth = std::max(site_nesting_depth, current_level + 1);
         // add first interval (should be the invariable seq, and thus composed only by
         // alpha chars)
         s = seq.substr(
@@ -441,8 +485,95 @@ std::vector<PathPtr> LocalPRG::shift(prg::Path p) const
     return return_paths;
 }
 
+namespace {
+// A k-mer of a PRG, 2-bit encoded as by hash_kmers() so that it can be rolled along the
+// graph one letter at a time. K-mers with non ACGT letters can't be encoded, and are
+// hashed from their string instead.
+struct EncodedKmer {
+    uint64_t forward;
+    uint64_t reverse;
+    bool is_encoded;
+};
+
+EncodedKmer encode_kmer(const std::string& kmer)
+{
+    const uint32_t k = kmer.length();
+    const uint64_t shift1 = 2 * (k - 1), mask = (1ULL << 2 * k) - 1;
+    EncodedKmer encoded { 0, 0, true };
+    for (const char letter : kmer) {
+        const uint32_t c = nt4(letter);
+        if (c > 3) {
+            encoded.is_encoded = false;
+            break;
+        }
+        encoded.forward = (encoded.forward << 2 | c) & mask;
+        encoded.reverse = (encoded.reverse >> 2) | (3ULL ^ c) << shift1;
+    }
+    return encoded;
+}
+
+// the k-mer along a path which is the path of the previous k-mer shifted by one place
+EncodedKmer shift_kmer(const LocalPRG& local_prg, const EncodedKmer& previous,
+    const prg::Path& path, const uint32_t& k)
+{
+    // the letter added is the last one along the path, which may end with null nodes
+    auto interval = path.getPath().rbegin();
+    while (interval->length == 0) {
+        ++interval;
+    }
+    const uint32_t c = nt4(local_prg.seq[interval->get_end() - 1]);
+    if (!previous.is_encoded or c > 3) {
+        return encode_kmer(local_prg.string_along_path(path));
+    }
+    const uint64_t shift1 = 2 * (k - 1), mask = (1ULL << 2 * k) - 1;
+    return EncodedKmer { (previous.forward << 2 | c) & mask,
+        (previous.reverse >> 2) | (3ULL ^ c) << shift1, true };
+}
+
+std::pair<uint64_t, uint64_t> kmer_hashes(const LocalPRG& local_prg,
+    const EncodedKmer& kmer, const prg::Path& path, const uint32_t& k)
+{
+    if (!kmer.is_encoded) {
+        return KmerHash().kmerhash(local_prg.string_along_path(path), k);
+    }
+    const uint64_t mask = (1ULL << 2 * k) - 1;
+    return std::make_pair(hash64(kmer.forward, mask), hash64(kmer.reverse, mask));
+}
+
+// the number of A and T in the k-mer along this path
+size_t count_AT(const std::string& kmer)
+{
+    return std::count(kmer.begin(), kmer.end(), 'A')
+        + std::count(kmer.begin(), kmer.end(), 'T');
+}
+
+// the paths of a k-mer shifted one place at a time along the graph, with the hashes of
+// each shifted k-mer
+struct ShiftedKmers {
+    std::vector<PathPtr> paths;
+    std::vector<std::pair<uint64_t, uint64_t>> hashes;
+    EncodedKmer last_kmer;
+
+    void push_back(const LocalPRG& local_prg, const PathPtr& path, const uint32_t& k)
+    {
+        last_kmer = shift_kmer(local_prg, last_kmer, *path, k);
+        paths.push_back(path);
+        hashes.push_back(kmer_hashes(local_prg, last_kmer, *path, k));
+    }
+};
+}
+
 void LocalPRG::minimizer_sketch(const std::shared_ptr<Index>& index, const uint32_t w,
     const uint32_t k, double percentageDone)
+{
+    std::vector<std::vector<SketchedMinimizer>> minimizers(1);
+    minimizer_sketch(minimizers.front(), w, k, percentageDone);
+    std::sort(minimizers.front().begin(), minimizers.front().end());
+    index->add_sorted_minimizers(minimizers);
+}
+
+bool LocalPRG::minimizer_sketch(std::vector<SketchedMinimizer>& minimizers,
+    const uint32_t w, const uint32_t k, double percentageDone, const uint64_t max_paths)
 {
     if (percentageDone >= 0)
         BOOST_LOG_TRIVIAL(info)
@@ -453,26 +584,30 @@ void LocalPRG::minimizer_sketch(const std::shared_ptr<Index>& index, const uint3
             << "Sketch PRG " << name << " which has " << prg.nodes.size() << " nodes";
 
     // clean up after any previous runs
-    // although note we can't clear the index because it is also added to by other
-    // LocalPRGs
+    // although note we can't clear the minimizers because they are also added to by
+    // other LocalPRGs
     kmer_prg.clear();
+    const size_t num_minimizers_before = minimizers.size();
 
     // declare variables
-    std::vector<PathPtr> walk_paths, shift_paths, v;
-    walk_paths.reserve(100);
+    std::vector<PathPtr> shift_paths;
     shift_paths.reserve(100);
     std::deque<KmerNodePtr> current_leaves, end_leaves;
-    std::deque<std::vector<PathPtr>> shifts;
+    std::deque<ShiftedKmers> shifts;
+    ShiftedKmers v;
     std::deque<Interval> d;
     prg::Path kmer_path;
-    std::string kmer;
+    std::string walk, kmer;
+    std::vector<uint64_t> forward_hashes, reverse_hashes;
     uint64_t smallest;
     std::pair<uint64_t, uint64_t> kh;
-    KmerHash hash; // TODO: replace by GATB's MPHF?
     uint32_t num_kmers_added = 0;
+    uint64_t num_paths_explored = 0; // the walks and shifted paths, for the budget
+    const auto within_budget = [&num_paths_explored, &max_paths]() {
+        return max_paths == 0 or num_paths_explored <= max_paths;
+    };
     KmerNodePtr kn, new_kn;
     std::vector<LocalNodePtr> n;
-    size_t num_AT = 0;
 
     // create a null start node in the kmer graph
     d = { Interval(0, 0) };
@@ -482,51 +617,48 @@ void LocalPRG::minimizer_sketch(const std::shared_ptr<Index>& index, const uint3
 
     // if this is a null prg, return the null kmergraph
     if (prg.nodes.size() == 1 and prg.nodes[0]->pos.length < k) {
-        return;
+        return true;
     }
 
-    // find first w,k minimizers
-    walk_paths = prg.walk(prg.nodes.begin()->second->id, 0,
-        w + k - 1); // get all walks to be checked - all walks from
-                    // prg.nodes.begin()->second->id composed of exactly w+k-1 bases -
-                    // NOTE: WALKS AND PATHS HERE ARE THE SAME, SINCE THIS IS A DAG!!!
-    if (walk_paths.empty()) {
-        return; // also trivially not true
+    // find first w,k minimizers: walks to be checked are all walks from
+    // prg.nodes.begin()->second->id composed of exactly w+k-1 bases -
+    // NOTE: WALKS AND PATHS HERE ARE THE SAME, SINCE THIS IS A DAG!!!
+    // whether walks exist is memoized for all the walks of this graph
+    WalkMemo walk_memo;
+    const uint32_t first_node_id = prg.nodes.begin()->second->id;
+    if (!prg.has_walk(first_node_id, 0, w + k - 1, walk_memo)) {
+        return true; // also trivially not true
     }
 
-    for (uint32_t i = 0; i != walk_paths.size(); ++i) { // goes through all walks
+    const auto sketch_walk = [&](const prg::Path& walk_path) {
+        ++num_paths_explored;
+        if (!within_budget()) {
+            return false;
+        }
+        // the hashes of all k-mers of this window, rolled along the walk's sequence
+        walk = string_along_path(walk_path);
+        assert(walk.length() == w + k - 1);
+        hash_every_kmer(walk, k, forward_hashes, reverse_hashes);
+
         // find minimizer for this walk
         smallest = std::numeric_limits<uint64_t>::max(); // will store the minimizer
-
-        // TODO: this can be optimized by invoking string_along_path() for the whole
-        // walk (only once) and computing the minimizer on that string
-        // TODO: this optimization won't be huge though...
-        for (uint32_t j = 0; j != w;
-             j++) { // goes through all kmer of this window, and find the minimizer
-                    // (which will be the minimizer of this walk)
-            kmer_path = walk_paths[i]->subpath(
-                j, k); // gets the subpath related to this k-mer //TODO: move
-                       // constructor/assignment op in Path?
-            if (!kmer_path.empty()) {
-                kmer = string_along_path(kmer_path); // get the string along the path
-                kh = hash.kmerhash(kmer, k); // TODO: replace by GATB's minimizer?
-                smallest = std::min(smallest, std::min(kh.first, kh.second));
-            }
+        for (uint32_t j = 0; j != w; j++) {
+            smallest
+                = std::min(smallest, std::min(forward_hashes[j], reverse_hashes[j]));
         }
         for (uint32_t j = 0; j != w; j++) { // now re-iterates the k-mers
             kmer_path
-                = walk_paths[i]->subpath(j, k); // gets the subpath related to this kmer
+                = walk_path.subpath(j, k); // gets the subpath related to this kmer
             auto old_kn = kmer_prg.nodes[0]; // old minimizer kmer node starts with the
                                              // virtual start node
             if (!kmer_path.empty()) {
-                kmer = string_along_path(kmer_path); // get the kmer
-                kh = hash.kmerhash(kmer, k); // and the hashes
+                kh = std::make_pair(forward_hashes[j], reverse_hashes[j]);
                 n = nodes_along_path(
                     kmer_path); // and the nodes of the localPRG along this kmer_path
 
-                if (prg.walk(n.back()->id, n.back()->pos.get_end(), w + k - 1)
-                        .empty()) { // if the walk from the last node and last base of
-                                    // the path along this kmer is empty
+                if (!prg.has_walk(n.back()->id, n.back()->pos.get_end(), w + k - 1,
+                        walk_memo)) { // if the walk from the last node and last base
+                                      // of the path along this kmer is empty
                     while (kmer_path.get_end() >= n.back()->pos.get_end()
                         and n.back()->outNodes.size() == 1
                         and n.back()->outNodes[0]->pos.length == 0) {
@@ -544,17 +676,13 @@ void LocalPRG::minimizer_sketch(const std::shared_ptr<Index>& index, const uint3
                                                    // in this kmer graph
                     if (found == kmer_prg.sorted_nodes.end()) { // it is not
                         // add to the KmerGraph (kmer_prg) first
-                        num_AT = std::count(kmer.begin(), kmer.end(), 'A')
-                            + std::count(kmer.begin(), kmer.end(), 'T');
-                        kn = kmer_prg.add_node_with_kh(
-                            kmer_path, std::min(kh.first, kh.second), num_AT);
-
-// TODO: name these criticals
-#pragma omp critical
-                        { // and now to the index
-                            index->add_record(std::min(kh.first, kh.second), id,
-                                kmer_path, kn->id, (kh.first <= kh.second));
-                        }
+                        kn = kmer_prg.add_node_with_kh(kmer_path,
+                            std::min(kh.first, kh.second),
+                            count_AT(walk.substr(j, k)));
+                        // and now to the minimizers to index
+                        minimizers.push_back(
+                            SketchedMinimizer { std::min(kh.first, kh.second), id,
+                                kn->id, (kh.first <= kh.second), &kn->path });
                         num_kmers_added += 1;
                         kmer_prg.add_edge(old_kn, kn); // add an edge from the old
                                                        // minimizer kmer to the current
@@ -565,6 +693,12 @@ void LocalPRG::minimizer_sketch(const std::shared_ptr<Index>& index, const uint3
                 }
             }
         }
+        return true;
+    };
+    prg.walk(first_node_id, 0, w + k - 1, sketch_walk, walk_memo);
+
+    if (!within_budget()) {
+        current_leaves.clear();
     }
 
     // while we have intermediate leaves of the kmergraph, for each in turn, explore the
@@ -575,6 +709,8 @@ void LocalPRG::minimizer_sketch(const std::shared_ptr<Index>& index, const uint3
         kn = current_leaves.front();
         current_leaves.pop_front();
         assert(kn->khash < std::numeric_limits<uint64_t>::max());
+        // the k-mers shifted from this one are rolled from it, a letter at a time
+        const EncodedKmer leaf_kmer = encode_kmer(string_along_path(kn->path));
 
         // find all paths which are this kmer-minimizer shifted by one place along the
         // graph
@@ -586,36 +722,36 @@ void LocalPRG::minimizer_sketch(const std::shared_ptr<Index>& index, const uint3
         }
         for (uint32_t i = 0; i != shift_paths.size();
              ++i) { // add all shift_paths to shifts
-            v = { shift_paths[i] };
-            shifts.push_back(v);
+            shifts.push_back(ShiftedKmers { {}, {}, leaf_kmer });
+            shifts.back().push_back(*this, shift_paths[i], k);
         }
+        num_paths_explored += shift_paths.size();
         shift_paths.clear();
 
         while (!shifts.empty()) { // goes through all shifted paths
-            v = shifts.front(); // get the first shifted path
+            if (!within_budget()) {
+                shifts.clear();
+                current_leaves.clear();
+                break;
+            }
+            v = std::move(shifts.front()); // get the first shifted path
             shifts.pop_front();
-            assert(v.back()->length() == k);
-            kmer = string_along_path(*(v.back()));
-            kh = hash.kmerhash(kmer, k);
+            assert(v.paths.back()->length() == k);
+            kh = v.hashes.back();
             if (std::min(kh.first, kh.second) <= kn->khash) {
                 // found next minimizer
                 KmerNodePtr dummyKmerHoldingKmerPath
-                    = std::make_shared<KmerNode>(KmerNode(0, *(v.back())));
+                    = std::make_shared<KmerNode>(KmerNode(0, *(v.paths.back())));
                 const auto found = kmer_prg.sorted_nodes.find(dummyKmerHoldingKmerPath);
                 if (found == kmer_prg.sorted_nodes.end()) {
-                    num_AT = std::count(kmer.begin(), kmer.end(), 'A')
-                        + std::count(kmer.begin(), kmer.end(), 'T');
-                    new_kn = kmer_prg.add_node_with_kh(
-                        *(v.back()), std::min(kh.first, kh.second), num_AT);
-
-// TODO: name these criticals
-#pragma omp critical
-                    {
-                        index->add_record(std::min(kh.first, kh.second), id,
-                            *(v.back()), new_kn->id, (kh.first <= kh.second));
-                    }
+                    kmer = string_along_path(*(v.paths.back()));
+                    new_kn = kmer_prg.add_node_with_kh(*(v.paths.back()),
+                        std::min(kh.first, kh.second), count_AT(kmer));
+                    minimizers.push_back(
+                        SketchedMinimizer { std::min(kh.first, kh.second), id,
+                            new_kn->id, (kh.first <= kh.second), &new_kn->path });
                     kmer_prg.add_edge(kn, new_kn);
-                    if (v.back()->get_end()
+                    if (v.paths.back()->get_end()
                         == (--(prg.nodes.end()))->second->pos.get_end()) {
                         end_leaves.push_back(new_kn);
                     } else if (find(
@@ -626,7 +762,7 @@ void LocalPRG::minimizer_sketch(const std::shared_ptr<Index>& index, const uint3
                     num_kmers_added += 1;
                 } else {
                     kmer_prg.add_edge(kn, *found);
-                    if (v.back()->get_end()
+                    if (v.paths.back()->get_end()
                         == (--(prg.nodes.end()))->second->pos.get_end()) {
                         end_leaves.push_back(*found);
                     } else if (find(
@@ -635,43 +771,36 @@ void LocalPRG::minimizer_sketch(const std::shared_ptr<Index>& index, const uint3
                         current_leaves.push_back(*found);
                     }
                 }
-            } else if (v.size() == w) {
+            } else if (v.paths.size() == w) {
                 // the old minimizer has dropped out the window, minimizer the w new
                 // kmers
                 smallest = std::numeric_limits<uint64_t>::max();
                 auto old_kn = kn;
                 for (uint32_t j = 0; j != w; j++) {
-                    kmer = string_along_path(*(v[j]));
-                    kh = hash.kmerhash(kmer, k);
+                    kh = v.hashes[j];
                     smallest = std::min(smallest, std::min(kh.first, kh.second));
                 }
                 for (uint32_t j = 0; j != w; j++) {
-                    kmer = string_along_path(*(v[j]));
-                    kh = hash.kmerhash(kmer, k);
+                    kh = v.hashes[j];
                     if (kh.first == smallest or kh.second == smallest) {
                         KmerNodePtr dummyKmerHoldingKmerPath
-                            = std::make_shared<KmerNode>(KmerNode(0, *(v[j])));
+                            = std::make_shared<KmerNode>(KmerNode(0, *(v.paths[j])));
                         const auto found
                             = kmer_prg.sorted_nodes.find(dummyKmerHoldingKmerPath);
                         if (found == kmer_prg.sorted_nodes.end()) {
-                            num_AT = std::count(kmer.begin(), kmer.end(), 'A')
-                                + std::count(kmer.begin(), kmer.end(), 'T');
-                            new_kn = kmer_prg.add_node_with_kh(
-                                *(v[j]), std::min(kh.first, kh.second), num_AT);
-
-// TODO: name these criticals
-#pragma omp critical
-                            {
-                                index->add_record(std::min(kh.first, kh.second), id,
-                                    *(v[j]), new_kn->id, (kh.first <= kh.second));
-                            }
+                            kmer = string_along_path(*(v.paths[j]));
+                            new_kn = kmer_prg.add_node_with_kh(*(v.paths[j]),
+                                std::min(kh.first, kh.second), count_AT(kmer));
+                            minimizers.push_back(SketchedMinimizer {
+                                std::min(kh.first, kh.second), id, new_kn->id,
+                                (kh.first <= kh.second), &new_kn->path });
 
                             // if there is more than one mini in the window, edge should
                             // go to the first, and from the first to the second
                             kmer_prg.add_edge(old_kn, new_kn);
                             old_kn = new_kn;
 
-                            if (v.back()->get_end()
+                            if (v.paths.back()->get_end()
                                 == (--(prg.nodes.end()))->second->pos.get_end()) {
                                 end_leaves.push_back(new_kn);
                             } else if (find(current_leaves.begin(),
@@ -684,7 +813,7 @@ void LocalPRG::minimizer_sketch(const std::shared_ptr<Index>& index, const uint3
                             kmer_prg.add_edge(old_kn, *found);
                             old_kn = *found;
 
-                            if (v.back()->get_end()
+                            if (v.paths.back()->get_end()
                                 == (--(prg.nodes.end()))->second->pos.get_end()) {
                                 end_leaves.push_back(*found);
                             } else if (find(current_leaves.begin(),
@@ -695,24 +824,36 @@ void LocalPRG::minimizer_sketch(const std::shared_ptr<Index>& index, const uint3
                         }
                     }
                 }
-            } else if (v.back()->get_end()
+            } else if (v.paths.back()->get_end()
                 == (--(prg.nodes.end()))
                        ->second->pos
                        .get_end()) { // marginal case - we are in the end of the PRG ->
                                      // current minimizer is a leaf
                 end_leaves.push_back(kn);
             } else {
-                shift_paths = shift(*(v.back())); // shift this path
+                shift_paths = shift(*(v.paths.back())); // shift this path
                 for (uint32_t i = 0; i != shift_paths.size();
                      ++i) { // add it to the shifts
                     shifts.push_back(v);
-                    shifts.back().push_back(shift_paths[i]);
+                    shifts.back().push_back(*this, shift_paths[i], k);
                 }
+                num_paths_explored += shift_paths.size();
                 shift_paths.clear();
             }
         }
     }
 
+    if (!within_budget()) {
+        BOOST_LOG_TRIVIAL(warning)
+            << "Sketching PRG " << name << " explored more than " << max_paths
+            << " k-mer paths, so only the k-mers along its representative paths are "
+               "sketched";
+        minimizers.erase(minimizers.begin() + num_minimizers_before, minimizers.end());
+        nodes_along_path_memo.clear();
+        sketch_representative_paths(minimizers, w, k);
+        return false;
+    }
+
     // create a null end node, and for each end leaf add an edge to this terminus
     assert(!end_leaves.empty());
     d = { Interval((--(prg.nodes.end()))->second->pos.get_end(),
@@ -730,6 +871,96 @@ void LocalPRG::minimizer_sketch(const std::shared_ptr<Index>& index, const uint3
                                        << " and num minikmers: " << num_kmers_added));
     kmer_prg.remove_shortcut_edges();
     kmer_prg.check();
+
+    // the memoized local node paths are only useful while sketching
+    nodes_along_path_memo.clear();
+    return true;
+}
+
+void LocalPRG::sketch_representative_paths(
+    std::vector<SketchedMinimizer>& minimizers, const uint32_t w, const uint32_t k)
+{
+    kmer_prg.clear();
+    std::deque<Interval> intervals = { Interval(0, 0) };
+    prg::Path path, kmer_path;
+    path.initialize(intervals);
+    const auto start_kn = kmer_prg.add_node(path);
+
+    // each path is sketched as a sequence, with the minimizers of each window linked
+    // in order along the path, and the paths share the k-mer nodes they have in common
+    std::vector<KmerNodePtr> end_leaves;
+    std::vector<uint64_t> forward_hashes, reverse_hashes;
+    for (const auto& local_path : prg.representative_paths()) {
+        const std::string sequence = string_along_path(local_path);
+        if (sequence.length() < w + k - 1) {
+            continue;
+        }
+        intervals.clear();
+        for (const auto& node : local_path) {
+            intervals.push_back(node->pos);
+        }
+        path.initialize(intervals);
+        auto null_nodes_at_end = local_path.end();
+        while ((*(null_nodes_at_end - 1))->pos.length == 0) {
+            --null_nodes_at_end;
+        }
+        hash_every_kmer(sequence, k, forward_hashes, reverse_hashes);
+
+        // the minimizers of a window are never before those of the previous windows
+        auto previous_kn = start_kn;
+        uint32_t next_kmer = 0;
+        for (uint32_t window = 0; window + w <= forward_hashes.size(); ++window) {
+            uint64_t smallest = std::numeric_limits<uint64_t>::max();
+            for (uint32_t j = window; j != window + w; ++j) {
+                smallest = std::min(
+                    smallest, std::min(forward_hashes[j], reverse_hashes[j]));
+            }
+            for (uint32_t j = std::max(window, next_kmer); j != window + w; ++j) {
+                const auto& forward_hash = forward_hashes[j];
+                const auto& reverse_hash = reverse_hashes[j];
+                if (forward_hash != smallest and reverse_hash != smallest) {
+                    continue;
+                }
+                next_kmer = j + 1;
+                kmer_path = path.subpath(j, k);
+                if (j + k == sequence.length()) {
+                    // the last k-mer also goes through the null nodes ending the path
+                    for (auto node = null_nodes_at_end; node != local_path.end();
+                         ++node) {
+                        kmer_path.add_end_interval((*node)->pos);
+                    }
+                }
+                KmerNodePtr kn;
+                const auto found = kmer_prg.sorted_nodes.find(
+                    std::make_shared<KmerNode>(KmerNode(0, kmer_path)));
+                if (found == kmer_prg.sorted_nodes.end()) {
+                    kn = kmer_prg.add_node_with_kh(kmer_path, smallest,
+                        count_AT(sequence.substr(j, k)));
+                    minimizers.push_back(SketchedMinimizer { smallest, id, kn->id,
+                        (forward_hash <= reverse_hash), &kn->path });
+                } else {
+                    kn = *found;
+                }
+                kmer_prg.add_edge(previous_kn, kn);
+                previous_kn = kn;
+            }
+        }
+        if (previous_kn != start_kn) {
+            end_leaves.push_back(previous_kn);
+        }
+    }
+
+    if (!end_leaves.empty()) {
+        const auto end = (--(prg.nodes.end()))->second->pos.get_end();
+        intervals = { Interval(end, end) };
+        path.initialize(intervals);
+        const auto end_kn = kmer_prg.add_node(path);
+        for (const auto& end_leaf : end_leaves) {
+            kmer_prg.add_edge(end_leaf, end_kn);
+        }
+    }
+    kmer_prg.remove_shortcut_edges();
+    kmer_prg.check();
 }
 
 bool intervals_overlap(const Interval& first, const Interval& second)
@@ -783,7 +1014,6 @@ std::vector<LocalNodePtr> LocalPRG::localnode_path_from_kmernode_path(
     std::vector<LocalNodePtr> localnode_path, kmernode, walk_path;
     if (kmernode_path.empty())
         return localnode_path;
-    std::vector<PathPtr> walk_paths;
     for (uint32_t i = 0; i != kmernode_path.size(); ++i) {
         if (i != 0
             and kmernode_path[i]->path.length()
@@ -810,9 +1040,8 @@ std::vector<LocalNodePtr> LocalPRG::localnode_path_from_kmernode_path(
     // extend to beginning of graph if possible
     bool overlap;
     if (localnode_path[0]->id != 0) {
-        walk_paths = prg.walk(0, 0, w);
-        for (uint32_t i = 0; i != walk_paths.size(); ++i) {
-            walk_path = nodes_along_path(*(walk_paths[i]));
+        const auto extend_to_start = [&](const prg::Path& path) {
+            walk_path = nodes_along_path(path);
             // does it overlap
             uint32_t n = 0, m = 0;
             overlap = false;
@@ -835,9 +1064,11 @@ std::vector<LocalNodePtr> LocalPRG::localnode_path_from_kmernode_path(
             if (overlap) {
                 localnode_path.insert(
                     localnode_path.begin(), walk_path.begin(), walk_path.begin() + m);
-                break;
+                return false;
             }
-        }
+            return true;
+        };
+        prg.walk(0, 0, w, extend_to_start);
         if (localnode_path[0]->id != 0) {
             // add the first path to start
             LocalNodePtr next = nullptr;
@@ -852,9 +1083,8 @@ std::vector<LocalNodePtr> LocalPRG::localnode_path_from_kmernode_path(
 
     // extend to end of graph if possible
     if (localnode_path.back()->id != prg.nodes.size() - 1) {
-        walk_paths = prg.walk_back(prg.nodes.size() - 1, seq.length(), w);
-        for (uint32_t i = 0; i != walk_paths.size(); ++i) {
-            walk_path = nodes_along_path(*(walk_paths[i]));
+        const auto extend_to_end = [&](const prg::Path& path) {
+            walk_path = nodes_along_path(path);
 
             // does it overlap
             uint32_t n = localnode_path.size();
@@ -879,9 +1109,11 @@ std::vector<LocalNodePtr> LocalPRG::localnode_path_from_kmernode_path(
             if (overlap) {
                 localnode_path.insert(
                     localnode_path.end(), walk_path.begin() + m, walk_path.end());
-                break;
+                return false;
             }
-        }
+            return true;
+        };
+        prg.walk_back(prg.nodes.size() - 1, seq.length(), w, extend_to_end);
         if (localnode_path.back()->id != prg.nodes.size() - 1) {
             // add the first path to end
             while (localnode_path.back()->id != prg.nodes.size() - 1
@@ -1,6 +1,7 @@
 #include <fstream>
 #include <cassert>
 #include <algorithm>
+#include <unordered_set>
 
 #include <boost/log/trivial.hpp>
 
@@ -120,88 +121,189 @@ std::vector<PathPtr> LocalGraph::walk(
     const uint32_t& node_id, const uint32_t& pos, const uint32_t& len) const
 { // node_id: where to start the walk, pos: the position in the node_id, len = k+w-1 ->
   // the length that the walk has to go through - we are sketching kmers in a graph
-    // walks from position pos in node node for length len bases
-    assert(
-        (nodes.at(node_id)->pos.start <= pos && nodes.at(node_id)->pos.get_end() >= pos)
-        || assert_msg(nodes.at(node_id)->pos.start
-            << "<=" << pos << " and " << nodes.at(node_id)->pos.get_end()
-            << ">=" << pos)); // if this fails, pos given lies on a different node
-    std::vector<PathPtr> return_paths, walk_paths;
-    return_paths.reserve(20);
-    walk_paths.reserve(20);
-    prg::Path p, p2;
-    std::deque<Interval> d;
-
-    if (pos + len
-        <= nodes.at(node_id)
-               ->pos.get_end()) { // checks if we can go until the end of the kmer
-        p.initialize(Interval(
-            pos, pos + len)); // create the path containing this interval of the node
-        return_paths.push_back(std::make_shared<prg::Path>(p));
-        return return_paths;
+    std::vector<PathPtr> return_paths;
+    walk(node_id, pos, len, [&return_paths](const prg::Path& path) {
+        return_paths.push_back(std::make_shared<prg::Path>(path));
+        return true;
+    });
+    return return_paths;
+}
+
+bool LocalGraph::walk(const uint32_t& node_id, const uint32_t& pos,
+    const uint32_t& len, const WalkCallback& on_walk) const
+{
+    WalkMemo memo;
+    return walk(node_id, pos, len, on_walk, memo);
+}
+
+bool LocalGraph::walk(const uint32_t& node_id, const uint32_t& pos,
+    const uint32_t& len, const WalkCallback& on_walk, WalkMemo& memo) const
+{
+    std::vector<Interval> intervals;
+    prg::Path path;
+    return walk(node_id, pos, len, intervals, path, on_walk, memo);
+}
+
+namespace {
+uint64_t walk_memo_key(const uint32_t& node_id, const uint32_t& len)
+{
+    return (uint64_t)node_id << 32 | len;
+}
+}
+
+bool LocalGraph::has_walk(const uint32_t& node_id, const uint32_t& pos,
+    const uint32_t& len, WalkMemo& memo) const
+{
+    const auto& node = nodes.at(node_id);
+    if (pos + len <= node->pos.get_end()) {
+        return true;
     }
-    uint32_t len_added = std::min(nodes.at(node_id)->pos.get_end() - pos, len);
-
-    if (len_added < len) {
-        for (auto it = nodes.at(node_id)->outNodes.begin();
-             it != nodes.at(node_id)->outNodes.end(); ++it) {
-            walk_paths = walk((*it)->id, (*it)->pos.start, len - len_added);
-            for (auto& walk_path : walk_paths) {
-                // Note, would have just added start interval to each item in
-                // walk_paths, but can't seem to force result of it2 to be non-const
-                p2.initialize(Interval(pos, nodes.at(node_id)->pos.get_end()));
-                p2.insert_to_the_end(walk_path->begin(), walk_path->end());
-                if (p2.length() == len) {
-                    return_paths.push_back(std::make_shared<prg::Path>(p2));
-                }
-            }
+    const uint32_t len_added = node->pos.get_end() - pos;
+    for (const auto& out_node : node->outNodes) {
+        if (has_walk_from_start(out_node, len - len_added, memo)) {
+            return true;
         }
     }
-    return return_paths;
+    return false;
+}
+
+bool LocalGraph::has_walk_from_start(
+    const LocalNodePtr& node, const uint32_t& len, WalkMemo& memo) const
+{
+    const auto key = walk_memo_key(node->id, len);
+    const auto found = memo.find(key);
+    if (found != memo.end()) {
+        return found->second;
+    }
+    const bool has_walk_from_node = has_walk(node->id, node->pos.start, len, memo);
+    memo[key] = has_walk_from_node;
+    return has_walk_from_node;
+}
+
+bool LocalGraph::walk(const uint32_t& node_id, const uint32_t& pos,
+    const uint32_t& len, std::vector<Interval>& intervals, prg::Path& path,
+    const WalkCallback& on_walk, WalkMemo& memo) const
+{
+    // walks from position pos in node node for length len bases, after the intervals
+    // already walked
+    const auto& node = nodes.at(node_id);
+    assert((node->pos.start <= pos && node->pos.get_end() >= pos)
+        || assert_msg(node->pos.start << "<=" << pos << " and " << node->pos.get_end()
+                                      << ">=" << pos)); // if this fails, pos given lies
+                                                        // on a different node
+
+    if (pos + len <= node->pos.get_end()) { // checks if we can go until the end of the
+                                            // kmer
+        intervals.emplace_back(pos, pos + len);
+        path.initialize(intervals.begin(), intervals.end(), intervals.size());
+        intervals.pop_back();
+        return on_walk(path);
+    }
+
+    const uint32_t len_added = node->pos.get_end() - pos;
+    intervals.emplace_back(pos, node->pos.get_end());
+    bool carry_on = true;
+    for (auto it = node->outNodes.begin(); carry_on and it != node->outNodes.end();
+         ++it) {
+        if (has_walk_from_start(*it, len - len_added, memo)) {
+            carry_on = walk(
+                (*it)->id, (*it)->pos.start, len - len_added, intervals, path, on_walk,
+                memo);
+        }
+    }
+    intervals.pop_back();
+    return carry_on;
 }
 
 std::vector<PathPtr> LocalGraph::walk_back(
     const uint32_t& node_id, const uint32_t& pos, const uint32_t& len) const
 {
-    // walks from position pos in node back through prg for length len bases
-    assert(
-        (nodes.at(node_id)->pos.start <= pos && nodes.at(node_id)->pos.get_end() >= pos)
-        || assert_msg(nodes.at(node_id)->pos.start
-            << "<=" << pos << " and " << nodes.at(node_id)->pos.get_end()
-            << ">=" << pos)); // if this fails, pos given lies on a different node
-    std::vector<PathPtr> return_paths, walk_paths;
-    return_paths.reserve(20);
-    walk_paths.reserve(20);
-    prg::Path p, p2;
-    std::deque<Interval> d;
-
-    if (nodes.at(node_id)->pos.start + len <= pos) {
-        p.initialize(Interval(pos - len, pos));
-        return_paths.push_back(std::make_shared<prg::Path>(p));
-        return return_paths;
+    std::vector<PathPtr> return_paths;
+    walk_back(node_id, pos, len, [&return_paths](const prg::Path& path) {
+        return_paths.push_back(std::make_shared<prg::Path>(path));
+        return true;
+    });
+    return return_paths;
+}
+
+bool LocalGraph::walk_back(const uint32_t& node_id, const uint32_t& pos,
+    const uint32_t& len, const WalkCallback& on_walk) const
+{
+    // memoizes walks back from the end of nodes, unlike the memo of walk()
+    WalkMemo memo;
+    std::vector<Interval> reversed_intervals;
+    prg::Path path;
+    return walk_back(node_id, pos, len, reversed_intervals, path, on_walk, memo);
+}
+
+std::vector<LocalNodePtr> LocalGraph::in_nodes(const uint32_t& node_id) const
+{
+    std::vector<LocalNodePtr> in_nodes;
+    const auto& node = nodes.at(node_id);
+    for (auto it = nodes.begin(); it != nodes.find(node_id); ++it) {
+        if (find(it->second->outNodes.begin(), it->second->outNodes.end(), node)
+            != it->second->outNodes.end()) {
+            in_nodes.push_back(it->second);
+        }
     }
+    return in_nodes;
+}
 
-    uint32_t len_added = std::min(pos - nodes.at(node_id)->pos.start, len);
-
-    std::vector<LocalNodePtr>::iterator innode;
-    if (len_added < len) {
-        for (auto it = nodes.begin(); it != nodes.find(node_id); ++it) {
-            innode = find(it->second->outNodes.begin(), it->second->outNodes.end(),
-                nodes.at(node_id));
-            if (innode != it->second->outNodes.end()) {
-                walk_paths = walk_back(
-                    it->second->id, it->second->pos.get_end(), len - len_added);
-                for (uint32_t i = 0; i != walk_paths.size(); ++i) {
-                    p2.initialize(*(walk_paths[i]));
-                    p2.add_end_interval(Interval(nodes.at(node_id)->pos.start, pos));
-                    if (p2.length() == len) {
-                        return_paths.push_back(std::make_shared<prg::Path>(p2));
-                    }
-                }
+bool LocalGraph::has_walk_back_from_end(
+    const LocalNodePtr& node, const uint32_t& len, WalkMemo& memo) const
+{
+    const auto key = walk_memo_key(node->id, len);
+    const auto found = memo.find(key);
+    if (found != memo.end()) {
+        return found->second;
+    }
+    bool has_walk_back = node->pos.length >= len;
+    if (!has_walk_back) {
+        for (const auto& in_node : in_nodes(node->id)) {
+            if (has_walk_back_from_end(in_node, len - node->pos.length, memo)) {
+                has_walk_back = true;
+                break;
             }
         }
     }
-    return return_paths;
+    memo[key] = has_walk_back;
+    return has_walk_back;
+}
+
+bool LocalGraph::walk_back(const uint32_t& node_id, const uint32_t& pos,
+    const uint32_t& len, std::vector<Interval>& reversed_intervals, prg::Path& path,
+    const WalkCallback& on_walk, WalkMemo& memo) const
+{
+    // walks from position pos in node back through prg for length len bases, before
+    // the intervals already walked
+    const auto& node = nodes.at(node_id);
+    assert((node->pos.start <= pos && node->pos.get_end() >= pos)
+        || assert_msg(node->pos.start << "<=" << pos << " and " << node->pos.get_end()
+                                      << ">=" << pos)); // if this fails, pos given lies
+                                                        // on a different node
+
+    if (node->pos.start + len <= pos) {
+        reversed_intervals.emplace_back(pos - len, pos);
+        path.initialize(reversed_intervals.rbegin(), reversed_intervals.rend(),
+            reversed_intervals.size());
+        reversed_intervals.pop_back();
+        return on_walk(path);
+    }
+
+    const uint32_t len_added = pos - node->pos.start;
+    reversed_intervals.emplace_back(node->pos.start, pos);
+    bool carry_on = true;
+    for (const auto& in_node : in_nodes(node_id)) {
+        if (!carry_on) {
+            break;
+        }
+        if (has_walk_back_from_end(in_node, len - len_added, memo)) {
+            carry_on = walk_back(in_node->id, in_node->pos.get_end(), len - len_added,
+                reversed_intervals, path, on_walk, memo);
+        }
+    }
+    reversed_intervals.pop_back();
+    return carry_on;
 }
 
 LocalNodePtr LocalGraph::get_previous_node(const LocalNodePtr n) const
@@ -353,6 +455,52 @@ std::vector<LocalNodePtr> LocalGraph::bottom_path() const
     return npath;
 }
 
+std::vector<std::vector<LocalNodePtr>> LocalGraph::representative_paths() const
+{
+    assert(!nodes.empty());
+
+    std::unordered_map<uint32_t, std::vector<LocalNodePtr>> in_nodes_of;
+    for (const auto& node : nodes) {
+        for (const auto& out_node : node.second->outNodes) {
+            in_nodes_of[out_node->id].push_back(node.second);
+        }
+    }
+
+    // prefers the nodes not on any path yet
+    std::unordered_set<uint32_t> covered;
+    const auto pick = [&covered](const std::vector<LocalNodePtr>& candidates) {
+        for (const auto& candidate : candidates) {
+            if (covered.find(candidate->id) == covered.end()) {
+                return candidate;
+            }
+        }
+        return candidates.front();
+    };
+
+    std::vector<std::vector<LocalNodePtr>> paths;
+    for (const auto& node : nodes) {
+        if (covered.find(node.first) != covered.end()) {
+            continue;
+        }
+        std::vector<LocalNodePtr> npath { node.second };
+        auto in_nodes = in_nodes_of.find(node.first);
+        while (in_nodes != in_nodes_of.end()) {
+            npath.push_back(pick(in_nodes->second));
+            in_nodes = in_nodes_of.find(npath.back()->id);
+        }
+        std::reverse(npath.begin(), npath.end());
+        while (!npath.back()->outNodes.empty()) {
+            npath.push_back(pick(npath.back()->outNodes));
+        }
+        for (const auto& path_node : npath) {
+            covered.insert(path_node->id);
+        }
+        paths.push_back(std::move(npath));
+    }
+
+    return paths;
+}
+
 bool LocalGraph::operator==(const LocalGraph& y) const
 {
     // false if have different numbers of nodes
@@ -47,6 +47,22 @@ void setup_map_subcommand(CLI::App& app)
         ->capture_default_str()
         ->group("Input/Output");
 
+    map_subcmd
+        ->add_option("--read-batch-size", opt->read_batch_size,
+            "Number of reads handed to a thread at once")
+        ->type_name("INT")
+        ->capture_default_str()
+        ->check(CLI::PositiveNumber.description(""))
+        ->group("Input/Output");
+
+    map_subcmd
+        ->add_option("--read-queue-depth", opt->read_queue_depth,
+            "Maximum number of batches of reads read ahead of the threads")
+        ->type_name("INT")
+        ->capture_default_str()
+        ->check(CLI::PositiveNumber.description(""))
+        ->group("Input/Output");
+
     std::string description = "Fasta file with a reference sequence to use for each "
                               "loci. The sequence MUST have a "
                               "perfect match in <TARGET> and the same name";
@@ -242,11 +258,13 @@ int pandora_map(MapOptions& opt)
     }
 
     BOOST_LOG_TRIVIAL(info) << "Loading Index and LocalPRGs from file...";
-    auto index = std::make_shared<Index>();
+    auto index = std::make_shared<FrozenIndex>();
     index->load(opt.prgfile, opt.window_size, opt.kmer_size);
     std::vector<std::shared_ptr<LocalPRG>> prgs;
-    read_prg_file(prgs, opt.prgfile);
-    load_PRG_kmergraphs(prgs, opt.window_size, opt.kmer_size, opt.prgfile);
+    // the graphs of a PRG are only built once reads hit it
+    read_prg_file(prgs, opt.prgfile, 0, 0, true, opt.threads);
+    load_PRG_kmergraphs(
+        prgs, opt.window_size, opt.kmer_size, opt.prgfile, opt.threads);
 
     BOOST_LOG_TRIVIAL(info)
         << "Constructing pangenome::Graph from read file (this will take a while)...";
@@ -254,7 +272,7 @@ int pandora_map(MapOptions& opt)
     uint32_t covg = pangraph_from_read_file(opt.readsfile.string(), pangraph, index,
         prgs, opt.window_size, opt.kmer_size, opt.max_diff, opt.error_rate,
         opt.min_cluster_size, opt.genome_size, opt.illumina, opt.clean, opt.max_covg,
-        opt.threads);
+        opt.threads, opt.read_batch_size, opt.read_queue_depth);
 
     if (pangraph->nodes.empty()) {
         BOOST_LOG_TRIVIAL(info) << "Found non of the LocalPRGs in the reads.";
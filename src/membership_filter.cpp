@@ -0,0 +1,64 @@
+#include <algorithm>
+
+#include "membership_filter.h"
+
+constexpr uint64_t MembershipFilter::WORDS_PER_BLOCK;
+constexpr uint64_t MembershipFilter::BITS_PER_KEY;
+constexpr uint32_t MembershipFilter::NUM_PROBES;
+
+namespace {
+// murmur3's finalizer: index keys are minimizer hashes restricted to 2k bits, so they
+// are mixed again to spread them over all blocks and probes
+uint64_t mix(uint64_t key)
+{
+    key ^= key >> 33;
+    key *= 0xFF51AFD7ED558CCDull;
+    key ^= key >> 33;
+    key *= 0xC4CEB9FE1A85EC53ull;
+    return key ^ (key >> 33);
+}
+}
+
+MembershipFilter::MembershipFilter()
+    : words { nullptr }
+    , num_blocks { 0 }
+{
+}
+
+MembershipFilter::MembershipFilter(
+    const uint64_t& num_keys, const KeyIterator& for_each_key)
+{
+    num_blocks = std::max((uint64_t)1, (num_keys * BITS_PER_KEY + 511) / 512);
+    owned_words.assign(num_blocks * WORDS_PER_BLOCK, 0);
+    for_each_key([this](const uint64_t& key) {
+        uint64_t hash = mix(key);
+        uint64_t* block = owned_words.data() + hash % num_blocks * WORDS_PER_BLOCK;
+        hash = mix(hash);
+        for (uint32_t i = 0; i < NUM_PROBES; ++i, hash >>= 9) {
+            block[(hash & 511) / 64] |= 1ull << (hash % 64);
+        }
+    });
+    words = owned_words.data();
+}
+
+MembershipFilter::MembershipFilter(const uint64_t* words, const uint64_t& num_words)
+    : words { words }
+    , num_blocks { num_words / WORDS_PER_BLOCK }
+{
+}
+
+bool MembershipFilter::may_contain(const uint64_t& key) const
+{
+    if (num_blocks == 0) {
+        return true;
+    }
+    uint64_t hash = mix(key);
+    const uint64_t* block = words + hash % num_blocks * WORDS_PER_BLOCK;
+    hash = mix(hash);
+    for (uint32_t i = 0; i < NUM_PROBES; ++i, hash >>= 9) {
+        if (!((block[(hash & 511) / 64] >> (hash % 64)) & 1)) {
+            return false;
+        }
+    }
+    return true;
+}
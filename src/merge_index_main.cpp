@@ -5,8 +5,8 @@ void setup_merge_index_subcommand(CLI::App& app)
 
     auto opt = std::make_shared<MergeIndexOptions>();
 
-    std::string description
-        = "Allows multiple indices to be merged (no compatibility check)";
+    std::string description = "Merges the indices of disjoint sets of PRGs, built "
+                              "with the same w and k";
     auto *merge_subcmd = app.add_subcommand("merge_index", description);
 
     merge_subcmd->add_option("<IDX>", opt->indicies, "Indices to merge")
@@ -33,13 +33,39 @@ int pandora_merge_index(MergeIndexOptions const& opt)
     }
     boost::log::core::get()->set_filter(boost::log::trivial::severity >= log_level);
 
-    // merge indexes
-    auto index = std::make_shared<Index>();
+    // text indexes are converted to temporary binary ones, which can be streamed
+    std::vector<fs::path> indexfiles;
+    std::vector<fs::path> converted_indexfiles;
     for (const auto& indexfile : opt.indicies) {
-        index->load(indexfile);
+        if (is_binary_index_file(indexfile)) {
+            indexfiles.push_back(indexfile);
+            continue;
+        }
+        BOOST_LOG_TRIVIAL(info) << "Converting text index " << indexfile
+                                << " to the binary format...";
+        Index index;
+        index.load(indexfile);
+        const fs::path converted_indexfile { opt.outfile.string() + ".tmp"
+            + std::to_string(converted_indexfiles.size()) };
+        index.save(converted_indexfile);
+        indexfiles.push_back(converted_indexfile);
+        converted_indexfiles.push_back(converted_indexfile);
     }
 
-    index->save(opt.outfile.string());
+    BOOST_LOG_TRIVIAL(info) << "Merging " << indexfiles.size() << " indices...";
+    std::string error;
+    try {
+        merge_index_files(indexfiles, opt.outfile);
+    } catch (const std::runtime_error& err) {
+        error = err.what();
+    }
+
+    for (const auto& converted_indexfile : converted_indexfiles) {
+        fs::remove(converted_indexfile);
+    }
+    if (not error.empty()) {
+        fatal_error(error);
+    }
 
     return 0;
 }
@@ -5,26 +5,47 @@
 #include <algorithm>
 #include "minirecord.h"
 #include "minihit.h"
+#include "minihits.h"
 #include "prg/path.h"
 
 #define assert_msg(x) !(std::cerr << "Assertion failed: " << x << std::endl)
 
 MinimizerHit::MinimizerHit(const uint32_t i, const Minimizer& minimizer_from_read,
     const MiniRecord& minimizer_from_PRG)
+    : MinimizerHit(i, minimizer_from_read, minimizer_from_PRG.prg_id,
+        minimizer_from_PRG.path, minimizer_from_PRG.knode_id, minimizer_from_PRG.strand)
+{
+}
+
+MinimizerHit::MinimizerHit(const uint32_t i, const Minimizer& minimizer_from_read,
+    const uint32_t prg_id, const prg::Path& prg_path, const uint32_t knode_id,
+    const bool prg_strand, const uint32_t record_id)
     : read_id { i }
     , read_start_position { minimizer_from_read.pos_of_kmer_in_read.start }
     , read_strand { minimizer_from_read.is_forward_strand }
-    , minimizer_from_PRG { minimizer_from_PRG }
+    , prg_strand { prg_strand }
+    , prg_id { prg_id }
+    , knode_id { knode_id }
+    , record_id { record_id }
+    , prg_path { prg_path }
 {
-
-    assert(minimizer_from_read.pos_of_kmer_in_read.length
-        == minimizer_from_PRG.path.length());
     assert(read_id < std::numeric_limits<uint32_t>::max()
         || assert_msg("Variable sizes too small to handle this number of reads"));
-    assert(minimizer_from_PRG.prg_id < std::numeric_limits<uint32_t>::max()
+    assert(prg_id < std::numeric_limits<uint32_t>::max()
         || assert_msg("Variable sizes too small to handle this number of prgs"));
-    assert(minimizer_from_read.pos_of_kmer_in_read.length
-        == minimizer_from_PRG.path.length());
+    assert(minimizer_from_read.pos_of_kmer_in_read.length == prg_path.length());
+}
+
+MinimizerHit::MinimizerHit(const FlatMinimizerHit& hit)
+    : read_id { hit.read_id }
+    , read_start_position { hit.read_start_position }
+    , read_strand { hit.read_strand }
+    , prg_strand { hit.prg_strand }
+    , prg_id { hit.prg_id }
+    , knode_id { hit.knode_id }
+    , record_id { hit.record_id }
+    , prg_path { *hit.prg_path }
+{
 }
 
 bool MinimizerHit::operator==(const MinimizerHit& y) const
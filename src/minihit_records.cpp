@@ -0,0 +1,104 @@
+#include <cassert>
+#include <utility>
+#include "minihit_records.h"
+#include "minihits.h"
+#include "frozen_index.h"
+
+MinimizerHitRecords::MinimizerHitRecords(std::shared_ptr<const FrozenIndex> index)
+    : index { std::move(index) }
+{
+}
+
+void MinimizerHitRecords::set_index(std::shared_ptr<const FrozenIndex> index)
+{
+    this->index = std::move(index);
+}
+
+CompactMinimizerHit MinimizerHitRecords::compact(const MinimizerHit& hit)
+{
+    uint32_t record_id = hit.get_record_id();
+    if (record_id == NO_RECORD_ID or index == nullptr) {
+        assert(added_records.size() < ADDED_RECORD_BIT);
+        record_id = ADDED_RECORD_BIT | (uint32_t)added_records.size();
+        added_records.push_back(AddedRecord { hit.get_prg_id(),
+            hit.get_kmer_node_id(), hit.get_prg_strand(), hit.get_prg_path() });
+    }
+    return CompactMinimizerHit { hit.get_read_start_position(), record_id,
+        hit.get_read_strand() };
+}
+
+MinimizerHit MinimizerHitRecords::expand(
+    const uint32_t read_id, const CompactMinimizerHit& hit) const
+{
+    if (is_added(hit.record_id)) {
+        const auto& record = added_records[hit.record_id & ~ADDED_RECORD_BIT];
+        return MinimizerHit(FlatMinimizerHit { read_id, hit.read_start_position,
+            record.prg_id, record.knode_id, NO_RECORD_ID, hit.read_strand,
+            record.strand, &record.path });
+    }
+    const auto& record = index->get_record(hit.record_id);
+    return MinimizerHit(FlatMinimizerHit { read_id, hit.read_start_position,
+        record.prg_id, record.knode_id, hit.record_id, hit.read_strand,
+        record.strand != 0, &index->get_path(record) });
+}
+
+uint32_t MinimizerHitRecords::get_prg_id(const CompactMinimizerHit& hit) const
+{
+    if (is_added(hit.record_id)) {
+        return added_records[hit.record_id & ~ADDED_RECORD_BIT].prg_id;
+    }
+    return index->get_record(hit.record_id).prg_id;
+}
+
+bool MinimizerHitRecords::is_forward(const CompactMinimizerHit& hit) const
+{
+    if (is_added(hit.record_id)) {
+        return hit.read_strand == added_records[hit.record_id & ~ADDED_RECORD_BIT].strand;
+    }
+    return hit.read_strand == (index->get_record(hit.record_id).strand != 0);
+}
+
+std::pair<uint32_t, uint64_t> MinimizerHitRecords::sort_key(
+    const CompactMinimizerHit& hit) const
+{
+    // the PRG id, then 0 if forward above the read position, from a single record
+    uint32_t prg_id;
+    bool prg_strand;
+    if (is_added(hit.record_id)) {
+        const auto& record = added_records[hit.record_id & ~ADDED_RECORD_BIT];
+        prg_id = record.prg_id;
+        prg_strand = record.strand;
+    } else {
+        const auto& record = index->get_record(hit.record_id);
+        prg_id = record.prg_id;
+        prg_strand = record.strand != 0;
+    }
+    const bool forward = hit.read_strand == prg_strand;
+    return std::make_pair(prg_id, ((uint64_t)!forward << 32) | hit.read_start_position);
+}
+
+const prg::Path& MinimizerHitRecords::get_path(const CompactMinimizerHit& hit) const
+{
+    if (is_added(hit.record_id)) {
+        return added_records[hit.record_id & ~ADDED_RECORD_BIT].path;
+    }
+    return index->get_path(index->get_record(hit.record_id));
+}
+
+bool MinimizerHitRecords::less(
+    const CompactMinimizerHit& lhs, const CompactMinimizerHit& rhs) const
+{
+    const auto lhs_key = sort_key(lhs);
+    const auto rhs_key = sort_key(rhs);
+    if (lhs_key != rhs_key) {
+        return lhs_key < rhs_key;
+    }
+    return lhs.record_id != rhs.record_id and get_path(lhs) < get_path(rhs);
+}
+
+bool MinimizerHitRecords::equal(
+    const CompactMinimizerHit& lhs, const CompactMinimizerHit& rhs) const
+{
+    return sort_key(lhs) == sort_key(rhs)
+        and (lhs.record_id == rhs.record_id or get_path(lhs) == get_path(rhs));
+}
@@ -3,6 +3,8 @@
 #include <iostream>
 #include <sstream>
 #include <memory>
+#include <array>
+#include <algorithm>
 #include "minihits.h"
 #include "minihit.h"
 #include "minirecord.h"
@@ -14,9 +16,107 @@
 void MinimizerHits::add_hit(const uint32_t i, const Minimizer& minimizer_from_read,
     const MiniRecord& minimizer_from_PRG)
 {
-    MinimizerHitPtr mh(
-        std::make_shared<MinimizerHit>(i, minimizer_from_read, minimizer_from_PRG));
-    hits.insert(mh);
+    add_hit(i, minimizer_from_read, minimizer_from_PRG.prg_id, minimizer_from_PRG.path,
+        minimizer_from_PRG.knode_id, minimizer_from_PRG.strand);
+}
+
+void MinimizerHits::add_hit(const uint32_t i, const Minimizer& minimizer_from_read,
+    const uint32_t prg_id, const prg::Path& prg_path, const uint32_t knode_id,
+    const bool prg_strand, const uint32_t record_id)
+{
+    assert(minimizer_from_read.pos_of_kmer_in_read.length == prg_path.length());
+    hits.push_back(FlatMinimizerHit { i, minimizer_from_read.pos_of_kmer_in_read.start,
+        prg_id, knode_id, record_id, minimizer_from_read.is_forward_strand, prg_strand,
+        &prg_path });
+}
+
+namespace {
+// a stable counting sort of the hits by a byte of their keys, which is skipped when all
+// hits have the same byte, as the high bytes of the read ids and positions often are
+template <typename Digit>
+void counting_sort(std::vector<FlatMinimizerHit>& hits,
+    std::vector<FlatMinimizerHit>& buffer, const Digit& digit)
+{
+    std::array<size_t, 256> starts {};
+    for (const auto& hit : hits) {
+        ++starts[digit(hit)];
+    }
+    if (std::find(starts.begin(), starts.end(), hits.size()) != starts.end()) {
+        return;
+    }
+    size_t start = 0;
+    for (auto& bucket_start : starts) {
+        const size_t count = bucket_start;
+        bucket_start = start;
+        start += count;
+    }
+    buffer.resize(hits.size());
+    for (const auto& hit : hits) {
+        buffer[starts[digit(hit)]++] = hit;
+    }
+    hits.swap(buffer);
+}
+
+bool same_read_position(const FlatMinimizerHit& lhs, const FlatMinimizerHit& rhs)
+{
+    return lhs.read_id == rhs.read_id and lhs.prg_id == rhs.prg_id
+        and lhs.is_forward() == rhs.is_forward()
+        and lhs.read_start_position == rhs.read_start_position;
+}
+}
+
+void MinimizerHits::sort()
+{
+    // least significant key first
+    for (uint32_t shift = 0; shift < 32; shift += 8) {
+        counting_sort(hits, sort_buffer, [shift](const FlatMinimizerHit& hit) {
+            return (hit.read_start_position >> shift) & 255;
+        });
+    }
+    counting_sort(hits, sort_buffer,
+        [](const FlatMinimizerHit& hit) { return hit.is_forward() ? 0 : 1; });
+    for (uint32_t shift = 0; shift < 32; shift += 8) {
+        counting_sort(hits, sort_buffer, [shift](const FlatMinimizerHit& hit) {
+            return (hit.prg_id >> shift) & 255;
+        });
+    }
+    for (uint32_t shift = 0; shift < 32; shift += 8) {
+        counting_sort(hits, sort_buffer, [shift](const FlatMinimizerHit& hit) {
+            return (hit.read_id >> shift) & 255;
+        });
+    }
+
+    // the few hits at the same read position, against several paths of a PRG, are then
+    // sorted by path, and only the first of equal hits is kept
+    const auto path_less
+        = [](const FlatMinimizerHit& lhs, const FlatMinimizerHit& rhs) {
+              return *lhs.prg_path < *rhs.prg_path;
+          };
+    for (auto first = hits.begin(); first != hits.end();) {
+        auto last = first + 1;
+        while (last != hits.end() and same_read_position(*first, *last)) {
+            ++last;
+        }
+        if (last - first > 1) {
+            std::stable_sort(first, last, path_less);
+        }
+        first = last;
+    }
+    hits.erase(std::unique(hits.begin(), hits.end(),
+                   [](const FlatMinimizerHit& lhs, const FlatMinimizerHit& rhs) {
+                       return same_read_position(lhs, rhs)
+                           and *lhs.prg_path == *rhs.prg_path;
+                   }),
+        hits.end());
+}
+
+MinimizerHitCluster MinimizerHits::cluster(const size_t begin, const size_t end) const
+{
+    MinimizerHitCluster cluster;
+    for (size_t i = begin; i < end; ++i) {
+        cluster.insert(cluster.end(), std::make_shared<MinimizerHit>(hits[i]));
+    }
+    return cluster;
 }
 
 /*std::ostream& operator<< (std::ostream & out, MinimizerHits const& m) {
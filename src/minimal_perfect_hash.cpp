@@ -0,0 +1,203 @@
+#include <algorithm>
+
+#include "minimal_perfect_hash.h"
+
+constexpr uint32_t MinimalPerfectHash::MAX_LEVELS;
+constexpr uint64_t MinimalPerfectHash::WORDS_PER_BLOCK;
+constexpr uint64_t MinimalPerfectHash::BITS_PER_BLOCK;
+
+namespace {
+// bits per key in each level: larger levels place more keys in the first levels, and
+// so make lookups of most keys faster, but take more memory
+constexpr double GAMMA = 2.0;
+
+// splitmix64's finalizer of the key, seeded differently for each level
+uint64_t level_hash(const uint64_t& key, const uint64_t& level)
+{
+    uint64_t hash = key + (level + 1) * 0x9E3779B97F4A7C15ull;
+    hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+    hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
+    return hash ^ (hash >> 31);
+}
+
+bool test_bit(const std::vector<uint64_t>& bits, const uint64_t& bit)
+{
+    return (bits[bit / 64] >> (bit % 64)) & 1;
+}
+
+void set_bit(std::vector<uint64_t>& bits, const uint64_t& bit)
+{
+    bits[bit / 64] |= 1ull << (bit % 64);
+}
+}
+
+MinimalPerfectHash::MinimalPerfectHash()
+    : num_keys { 0 }
+    , num_placed_keys { 0 }
+{
+    point_to_owned_arrays();
+}
+
+MinimalPerfectHash::MinimalPerfectHash(const uint64_t* keys, const uint64_t& num_keys)
+    : num_keys { num_keys }
+{
+    build([keys, num_keys](const std::function<void(const uint64_t&)>& callback) {
+        for (uint64_t i = 0; i < num_keys; ++i) {
+            callback(keys[i]);
+        }
+    });
+}
+
+MinimalPerfectHash::MinimalPerfectHash(
+    const uint64_t& num_keys, const KeyIterator& for_each_key)
+    : num_keys { num_keys }
+{
+    build(for_each_key);
+}
+
+MinimalPerfectHash::MinimalPerfectHash(const uint64_t& num_keys,
+    const MphfLevel* levels, const uint64_t& num_levels, const uint64_t* blocks,
+    const uint64_t& num_blocks, const uint64_t* leftover_keys,
+    const uint64_t& num_leftover_keys)
+    : num_keys { num_keys }
+    , levels { levels }
+    , num_levels { num_levels }
+    , blocks { blocks }
+    , num_blocks { num_blocks }
+    , leftover_keys { leftover_keys }
+    , num_leftover_keys { num_leftover_keys }
+    , num_placed_keys { num_keys - num_leftover_keys }
+{
+}
+
+void MinimalPerfectHash::build(const KeyIterator& for_each_key)
+{
+    // the bits of each level, before they are packed in blocks. A key was placed in a
+    // previous level iff its bit is set there: colliding bits are all cleared
+    std::vector<std::vector<uint64_t>> level_bits;
+    const auto is_placed = [&](const uint64_t& key) {
+        for (uint64_t level = 0; level < level_bits.size(); ++level) {
+            const auto& bits = level_bits[level];
+            if (test_bit(bits, level_hash(key, level) % (bits.size() * 64))) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    uint64_t num_remaining_keys = num_keys;
+    num_placed_keys = 0;
+    while (num_remaining_keys > 0 and level_bits.size() < MAX_LEVELS) {
+        const uint64_t level = level_bits.size();
+        const uint64_t num_words = std::max(
+            (uint64_t)1, (uint64_t)(GAMMA * num_remaining_keys + 63) / 64);
+        std::vector<uint64_t> bits(num_words, 0);
+        std::vector<uint64_t> collisions(num_words, 0);
+        for_each_key([&](const uint64_t& key) {
+            if (is_placed(key)) {
+                return;
+            }
+            const uint64_t bit = level_hash(key, level) % (num_words * 64);
+            if (test_bit(bits, bit)) {
+                set_bit(collisions, bit);
+            } else {
+                set_bit(bits, bit);
+            }
+        });
+        uint64_t num_level_keys = 0;
+        for (uint64_t i = 0; i < num_words; ++i) {
+            bits[i] &= ~collisions[i];
+            num_level_keys += __builtin_popcountll(bits[i]);
+        }
+        level_bits.push_back(std::move(bits));
+        num_remaining_keys -= num_level_keys;
+        num_placed_keys += num_level_keys;
+    }
+
+    if (num_remaining_keys > 0) {
+        owned_leftover_keys.reserve(num_remaining_keys);
+        for_each_key([&](const uint64_t& key) {
+            if (!is_placed(key)) {
+                owned_leftover_keys.push_back(key);
+            }
+        });
+        std::sort(owned_leftover_keys.begin(), owned_leftover_keys.end());
+    }
+
+    // pack the levels one after the other, then rank the blocks
+    uint64_t total_bits = 0;
+    for (const auto& bits : level_bits) {
+        owned_levels.push_back(MphfLevel { total_bits, bits.size() * 64 });
+        total_bits += bits.size() * 64;
+    }
+    const uint64_t number_of_blocks
+        = (total_bits + BITS_PER_BLOCK - 1) / BITS_PER_BLOCK;
+    owned_blocks.assign(number_of_blocks * WORDS_PER_BLOCK, 0);
+    for (uint64_t level = 0; level < level_bits.size(); ++level) {
+        const auto& bits = level_bits[level];
+        for (uint64_t i = 0; i < bits.size() * 64; ++i) {
+            if (test_bit(bits, i)) {
+                const uint64_t bit = owned_levels[level].first_bit + i;
+                owned_blocks[bit / BITS_PER_BLOCK * WORDS_PER_BLOCK + 1
+                    + bit % BITS_PER_BLOCK / 64]
+                    |= 1ull << (bit % 64);
+            }
+        }
+    }
+    uint64_t bits_set = 0;
+    for (uint64_t block = 0; block < number_of_blocks; ++block) {
+        owned_blocks[block * WORDS_PER_BLOCK] = bits_set;
+        for (uint64_t i = 1; i < WORDS_PER_BLOCK; ++i) {
+            bits_set += __builtin_popcountll(owned_blocks[block * WORDS_PER_BLOCK + i]);
+        }
+    }
+
+    point_to_owned_arrays();
+}
+
+void MinimalPerfectHash::point_to_owned_arrays()
+{
+    levels = owned_levels.data();
+    num_levels = owned_levels.size();
+    blocks = owned_blocks.data();
+    num_blocks = owned_blocks.size() / WORDS_PER_BLOCK;
+    leftover_keys = owned_leftover_keys.data();
+    num_leftover_keys = owned_leftover_keys.size();
+}
+
+bool MinimalPerfectHash::is_set(const uint64_t& bit) const
+{
+    const uint64_t* block = blocks + bit / BITS_PER_BLOCK * WORDS_PER_BLOCK;
+    return (block[1 + bit % BITS_PER_BLOCK / 64] >> (bit % 64)) & 1;
+}
+
+uint64_t MinimalPerfectHash::rank(const uint64_t& bit) const
+{
+    const uint64_t* block = blocks + bit / BITS_PER_BLOCK * WORDS_PER_BLOCK;
+    const uint64_t word = bit % BITS_PER_BLOCK / 64;
+    uint64_t bits_set = block[0];
+    for (uint64_t i = 0; i < word; ++i) {
+        bits_set += __builtin_popcountll(block[1 + i]);
+    }
+    const uint64_t bits_before = block[1 + word] & ((1ull << (bit % 64)) - 1);
+    return bits_set + __builtin_popcountll(bits_before);
+}
+
+uint64_t MinimalPerfectHash::lookup(const uint64_t& key) const
+{
+    for (uint64_t level = 0; level < num_levels; ++level) {
+        const uint64_t bit
+            = levels[level].first_bit + level_hash(key, level) % levels[level].num_bits;
+        if (is_set(bit)) {
+            return rank(bit);
+        }
+    }
+    const uint64_t* it
+        = std::lower_bound(leftover_keys, leftover_keys + num_leftover_keys, key);
+    return num_placed_keys + (it - leftover_keys);
+}
+
+uint32_t MinimalPerfectHash::fingerprint(const uint64_t& key)
+{
+    return level_hash(key, MAX_LEVELS) >> 32;
+}
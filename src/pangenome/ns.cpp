@@ -11,6 +11,8 @@ struct SamplePtrSorterBySampleId;
 
 class Graph;
 
+class GraphShard;
+
 typedef std::shared_ptr<pangenome::Node> NodePtr;
 typedef std::weak_ptr<pangenome::Node> WeakNodePtr;
 typedef std::shared_ptr<pangenome::Read> ReadPtr;
@@ -21,6 +21,7 @@ using namespace pangenome;
 
 pangenome::Graph::Graph(const std::vector<std::string>& sample_names)
     : next_id { 0 }
+    , hit_records { std::make_shared<MinimizerHitRecords>() }
 {
     nodes.reserve(6000);
 
@@ -37,7 +38,7 @@ void pangenome::Graph::add_read(const uint32_t& read_id)
     auto it = reads.find(read_id);
     bool found = it != reads.end();
     if (not found) {
-        auto read_ptr = std::make_shared<Read>(read_id);
+        auto read_ptr = std::make_shared<Read>(read_id, hit_records);
         assert(read_ptr != nullptr);
         reads[read_id] = read_ptr;
     }
@@ -122,6 +123,27 @@ void pangenome::Graph::add_hits_between_PRG_and_read(
     update_read_info_with_node_and_cluster(read_ptr, node_ptr, cluster);
 }
 
+void pangenome::Graph::add_hits_between_PRG_and_read(
+    const std::shared_ptr<LocalPRG>& prg, const uint32_t read_id,
+    const CompactMinimizerHit* first, const CompactMinimizerHit* last)
+{
+#ifndef NDEBUG
+    for (auto hit = first; hit != last; ++hit) {
+        assert(hit_records->get_prg_id(*hit) == prg->id);
+    }
+#endif
+
+    add_read(read_id);
+    auto read_ptr = get_read(read_id);
+    assert(read_ptr != nullptr);
+
+    add_node(prg);
+    auto node_ptr = get_node(prg);
+
+    update_node_info_with_this_read(node_ptr, read_ptr);
+    read_ptr->add_hits(node_ptr, first, last);
+}
+
 // TODO: this should be a method of class Sample
 void update_sample_info_with_this_node(
     const SamplePtr& sample, const NodePtr& node, const std::vector<KmerNodePtr>& kmp)
@@ -290,10 +312,7 @@ void pangenome::Graph::add_hits_to_kmergraphs(
         for (const auto& read_ptr : pangraph_node.reads) {
             const Read& read = *read_ptr;
 
-            auto hits = read.get_hits_as_unordered_map();
-            for (const auto& minimizer_hit_ptr : hits.at(pangraph_node.prg_id)) {
-                const auto& minimizer_hit = *minimizer_hit_ptr;
-
+            for (const auto& minimizer_hit : read.get_hits(pangraph_node.prg_id)) {
                 assert(minimizer_hit.get_kmer_node_id()
                     < pangraph_node.kmer_prg_with_coverage.kmer_prg->nodes.size());
                 assert(pangraph_node.kmer_prg_with_coverage.kmer_prg
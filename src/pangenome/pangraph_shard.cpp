@@ -0,0 +1,74 @@
+#include <algorithm>
+#include "pangenome/pangraph_shard.h"
+#include "pangenome/pangraph.h"
+#include "minihit.h"
+#include "frozen_index.h"
+#include "localPRG.h"
+
+using namespace pangenome;
+
+GraphShard::GraphShard(std::shared_ptr<const FrozenIndex> index)
+    : hit_records { std::move(index) }
+{
+}
+
+void GraphShard::add_cluster(const MinimizerHitCluster& cluster)
+{
+    if (cluster.empty()) {
+        return;
+    }
+    const auto& first_hit = **cluster.begin();
+    clusters.push_back(
+        Cluster { first_hit.get_read_id(), first_hit.get_prg_id(), hits.size() });
+    for (const auto& hit_ptr : cluster) {
+        hits.push_back(hit_records.compact(*hit_ptr));
+    }
+}
+
+void GraphShard::merge(std::vector<GraphShard>& shards, Graph& graph,
+    const std::vector<std::shared_ptr<LocalPRG>>& prgs)
+{
+    // the clusters of all shards by read id. A read is mapped by a single thread, so
+    // the stable sort keeps its clusters in order
+    std::vector<std::pair<uint32_t, uint32_t>> shard_and_cluster;
+    for (uint32_t s = 0; s < shards.size(); ++s) {
+        for (uint32_t i = 0; i < shards[s].clusters.size(); ++i) {
+            shard_and_cluster.emplace_back(s, i);
+        }
+    }
+    std::stable_sort(shard_and_cluster.begin(), shard_and_cluster.end(),
+        [&shards](const std::pair<uint32_t, uint32_t>& lhs,
+            const std::pair<uint32_t, uint32_t>& rhs) {
+            return shards[lhs.first].clusters[lhs.second].read_id
+                < shards[rhs.first].clusters[rhs.second].read_id;
+        });
+
+    // the hits of records copied by a shard, e.g. without an index, are compacted again
+    // by the graph
+    std::vector<CompactMinimizerHit> copied_hits;
+    for (const auto& s_and_i : shard_and_cluster) {
+        const auto& shard = shards[s_and_i.first];
+        const auto& cluster = shard.clusters[s_and_i.second];
+        const auto end = s_and_i.second + 1 < shard.clusters.size()
+            ? shard.clusters[s_and_i.second + 1].first_hit
+            : shard.hits.size();
+        const CompactMinimizerHit* first = shard.hits.data() + cluster.first_hit;
+        const CompactMinimizerHit* last = shard.hits.data() + end;
+        if (not shard.hit_records.shares_ids_with(*graph.hit_records)) {
+            copied_hits.clear();
+            for (auto hit = first; hit != last; ++hit) {
+                copied_hits.push_back(graph.hit_records->compact(
+                    shard.hit_records.expand(cluster.read_id, *hit)));
+            }
+            first = copied_hits.data();
+            last = copied_hits.data() + copied_hits.size();
+        }
+        graph.add_hits_between_PRG_and_read(
+            prgs[cluster.prg_id], cluster.read_id, first, last);
+    }
+
+    for (auto& shard : shards) {
+        shard.clusters = std::vector<Cluster>();
+        shard.hits = std::vector<CompactMinimizerHit>();
+    }
+}
@@ -15,6 +15,15 @@
 
 using namespace pangenome;
 
+namespace {
+// a node needs the graphs of its PRG, which are only built now if the PRG is lazy
+KmerGraph* materialized_kmer_graph(const std::shared_ptr<LocalPRG>& prg)
+{
+    prg->materialize();
+    return &prg->kmer_prg;
+}
+}
+
 // constructors
 pangenome::Node::Node(const std::shared_ptr<LocalPRG>& prg)
     : Node(prg, prg->id)
@@ -28,11 +37,8 @@ pangenome::Node::Node(const std::shared_ptr<LocalPRG>& prg, uint32_t node_id,
     , node_id(node_id)
     , name(prg->name)
     , covg(0)
-    , kmer_prg_with_coverage(
-          const_cast<KmerGraph*>(
-              &prg->kmer_prg), // TODO: this is very dangerous,
-                               // KmerGraphWithCoverage::kmer_prg must be made const
-          total_number_samples)
+    // TODO: this is very dangerous, KmerGraphWithCoverage::kmer_prg must be made const
+    , kmer_prg_with_coverage(materialized_kmer_graph(prg), total_number_samples)
 {
 }
 
@@ -106,17 +112,17 @@ void pangenome::Node::get_read_overlap_coordinates(
     auto read_count = 0;
     for (const auto& read_ptr : reads) {
         read_count++;
-        auto hits = read_ptr->get_hits_as_unordered_map();
-        if (hits.at(prg_id).size() < 2)
+        const auto hits = read_ptr->get_hits(prg_id);
+        if (hits.size() < 2)
             continue;
 
-        auto hit_ptr_iter = hits.at(prg_id).begin();
-        uint32_t start = (*hit_ptr_iter)->get_read_start_position();
+        auto hit_iter = hits.begin();
+        uint32_t start = hit_iter->get_read_start_position();
         uint32_t end = 0;
-        for (const auto& hit_ptr : hits.at(prg_id)) {
-            start = std::min(start, hit_ptr->get_read_start_position());
-            end = std::max(end,
-                hit_ptr->get_read_start_position() + hit_ptr->get_prg_path().length());
+        for (const auto& hit : hits) {
+            start = std::min(start, hit.get_read_start_position());
+            end = std::max(
+                end, hit.get_read_start_position() + hit.get_prg_path().length());
         }
 
         assert(end > start
@@ -124,7 +130,7 @@ void pangenome::Node::get_read_overlap_coordinates(
                 << name << " and read " << read_ptr->id << " (the " << read_count
                 << "th on this node)" << std::endl
                 << "Found end " << end << " after found start " << start));
-        coordinate = { read_ptr->id, start, end, (*hit_ptr_iter)->is_forward() };
+        coordinate = { read_ptr->id, start, end, hit_iter->is_forward() };
         read_overlap_coordinates.push_back(coordinate);
     }
 
@@ -206,29 +212,27 @@ std::set<ReadCoordinate> pangenome::Node::get_read_overlap_coordinates(
     std::set<ReadCoordinate> read_overlap_coordinates;
 
     for (const auto& current_read : this->reads) {
-        auto hits = current_read->get_hits_as_unordered_map();
         const auto read_hits_inside_path { find_hits_inside_path(
-            hits.at(this->prg_id), local_path) };
+            current_read->get_hits(this->prg_id), local_path) };
 
         if (read_hits_inside_path.size() < min_number_hits) {
             continue;
         }
 
         const auto read_hits_iter { read_hits_inside_path.cbegin() };
-        uint32_t start { (*read_hits_iter)->get_read_start_position() };
+        uint32_t start { read_hits_iter->get_read_start_position() };
         uint32_t end { 0 };
 
         for (const auto& read_hit : read_hits_inside_path) {
-            start = std::min(start, read_hit->get_read_start_position());
+            start = std::min(start, read_hit.get_read_start_position());
             end = std::max(end,
-                read_hit->get_read_start_position()
-                    + read_hit->get_prg_path().length());
+                read_hit.get_read_start_position() + read_hit.get_prg_path().length());
         }
 
         assert(end > start);
 
         read_overlap_coordinates.emplace(
-            current_read->id, start, end, (*read_hits_iter)->is_forward());
+            current_read->id, start, end, read_hits_iter->is_forward());
     }
     return read_overlap_coordinates;
 }
\ No newline at end of file
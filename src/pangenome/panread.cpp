@@ -14,17 +14,17 @@
 using namespace pangenome;
 
 Read::Read(const uint32_t i)
-    : id(i)
-    , hits(0)
-    , node_orientations(0)
-    , nodes(0)
+    : Read(i, std::make_shared<MinimizerHitRecords>())
 {
 }
 
-Read::~Read()
+Read::Read(const uint32_t i, MinimizerHitRecordsPtr hit_records)
+    : hit_records(std::move(hit_records))
+    , id(i)
+    , hits(0)
+    , node_orientations(0)
+    , nodes(0)
 {
-    for (MinimizerHit* minihit : hits)
-        delete minihit;
 }
 
 std::vector<WeakNodePtr>::iterator Read::find_node_by_id(uint32_t node_id)
@@ -38,26 +38,47 @@ std::vector<WeakNodePtr>::iterator Read::find_node_by_id(uint32_t node_id)
 void Read::add_hits(
     const NodePtr& node_ptr, const std::set<MinimizerHitPtr, pComp>& cluster)
 {
-    // TODO: review this method...
-    auto before_size = hits.size();
-
+    const auto before_size = hits.size();
     for (const auto& clusterHitSmrtPointer : cluster)
-        hits.push_back(new MinimizerHit(*clusterHitSmrtPointer));
-    std::sort(hits.begin(), hits.end(),
-        [](const MinimizerHit* const lhs, const MinimizerHit* const rhs) {
-            return (*lhs) < (*rhs);
-        }); // TODO: might not need this...
-    auto last = std::unique(hits.begin(), hits.end(),
-        [](const MinimizerHit* const lhs, const MinimizerHit* const rhs) {
-            return (*lhs) == (*rhs);
-        });
-    hits.erase(last, hits.end());
-    hits.shrink_to_fit();
+        hits.push_back(hit_records->compact(*clusterHitSmrtPointer));
+    merge_added_hits(node_ptr, before_size);
+}
+
+void Read::add_hits(const NodePtr& node_ptr, const CompactMinimizerHit* first,
+    const CompactMinimizerHit* last)
+{
+    const auto before_size = hits.size();
+    hits.insert(hits.end(), first, last);
+    merge_added_hits(node_ptr, before_size);
+}
+
+void Read::merge_added_hits(const NodePtr& node_ptr, const size_t before_size)
+{
+    const auto hit_less = [this](const CompactMinimizerHit& lhs,
+                              const CompactMinimizerHit& rhs) {
+        return hit_records->less(lhs, rhs);
+    };
+    const auto hit_equal = [this](const CompactMinimizerHit& lhs,
+                               const CompactMinimizerHit& rhs) {
+        return hit_records->equal(lhs, rhs);
+    };
+    const auto number_of_added_hits = hits.size() - before_size;
+    bool orientation = number_of_added_hits > 0
+        and hit_records->is_forward(hits[before_size]);
+
+    // the added hits are sorted, so merge them in with the hits already there, unless
+    // they go after all of them
+    const auto first_added = hits.begin() + before_size;
+    if (before_size > 0 and first_added != hits.end()
+        and not hit_less(*(first_added - 1), *first_added)) {
+        std::inplace_merge(hits.begin(), first_added, hits.end(), hit_less);
+        auto last = std::unique(hits.begin(), hits.end(), hit_equal);
+        hits.erase(last, hits.end());
+    }
 
-    assert(hits.size() == before_size + cluster.size());
+    assert(hits.size() == before_size + number_of_added_hits);
 
     // add the orientation/node accordingly
-    bool orientation = !cluster.empty() and (*cluster.begin())->is_forward();
     if (get_nodes().empty() or node_ptr != get_nodes().back().lock()
         or orientation != node_orientations.back()
         // or we think there really are 2 copies of gene
@@ -67,33 +88,32 @@ void Read::add_hits(
     }
 }
 
-std::unordered_map<uint32_t, std::vector<MinimizerHitPtr>>
+std::vector<MinimizerHit> Read::get_hits(const uint32_t prg_id) const
+{
+    std::vector<MinimizerHit> prg_hits;
+    for (const auto& hit : hits) {
+        if (hit_records->get_prg_id(hit) == prg_id) {
+            prg_hits.push_back(hit_records->expand(id, hit));
+        }
+    }
+    return prg_hits;
+}
+
+std::unordered_map<uint32_t, std::vector<MinimizerHit>>
 Read::get_hits_as_unordered_map() const
 {
-    std::unordered_map<uint32_t, std::vector<MinimizerHitPtr>>
+    std::unordered_map<uint32_t, std::vector<MinimizerHit>>
         hitsMap; // this will map node_ids from the pangenome::Graph to their minimizer
                  // hits
-    for (const MinimizerHit* const minihit : hits) {
-        // gets the nodeId
-        uint32_t nodeId = minihit->get_prg_id(); // prg_id == node_id in
-                                                 // pangenome::Graph
-
-        // checks if we have an entry for this nodeId in hitsMap
-        if (hitsMap.find(nodeId) == hitsMap.end())
-            // no, add it
-            hitsMap[nodeId] = std::vector<MinimizerHitPtr>();
-
-        // add this minihit to hitsMap
-        hitsMap[nodeId].push_back(std::make_shared<MinimizerHit>(
-            *minihit)); // TODO: I think here we don't really need to create a shared
-                        // pointer - a raw pointer is fine
+    for (const auto& hit : hits) {
+        // prg_id == node_id in pangenome::Graph
+        hitsMap[hit_records->get_prg_id(hit)].push_back(
+            hit_records->expand(id, hit));
     }
 
     // add empty hits if we have them - for backwards compatibility
     for (const WeakNodePtr& node : nodes) {
-        auto node_id = node.lock()->node_id;
-        if (hitsMap.find(node_id) == hitsMap.end())
-            hitsMap[node_id] = {};
+        hitsMap[node.lock()->node_id];
     }
 
     return hitsMap;
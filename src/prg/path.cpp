@@ -1,5 +1,5 @@
 #include <cassert>
-#include <localPRG.h>
+#include <boost/functional/hash.hpp>
 #include "prg/path.h"
 
 #define assert_msg(x) !(std::cerr << "Assertion failed: " << x << std::endl)
@@ -28,44 +28,12 @@ uint32_t prg::Path::length() const
 
 void prg::Path::add_end_interval(const Interval& i)
 {
-    memoizedDirty = true;
     assert(i.start >= get_end()
         || assert_msg("tried to add interval starting at "
             << i.start << " to end of path finishing at " << get_end()));
     path.push_back(i);
 }
 
-std::vector<LocalNodePtr> prg::Path::nodes_along_path(const LocalPRG& localPrg)
-{
-    // sanity check
-    assert(
-        (isMemoized == false
-            || (isMemoized == true && localPRGIdOfMemoizedLocalNodePath == localPrg.id))
-        || assert_msg("Memoization bug: memoized a local node path for PRG with id"
-            << localPRGIdOfMemoizedLocalNodePath << " but PRG id " << localPrg.id
-            << " is also trying to use this memoized path"));
-
-    if (isMemoized == false
-        || memoizedDirty == true) { // checks if we must do memoization
-        // yes
-        // not memoized, memoize
-        memoizedLocalNodePath = localPrg.nodes_along_path_core(*this);
-
-        // update the memoization control variables
-        localPRGIdOfMemoizedLocalNodePath = localPrg.id;
-        isMemoized = true;
-        memoizedDirty = false;
-
-        // return the local node path
-        return memoizedLocalNodePath;
-    } else if (memoizedDirty == false) {
-        // redudant call, return the memoized local node path
-        return memoizedLocalNodePath;
-    } else {
-        fatal_error("Bug on prg::Path::nodes_along_path()");
-    }
-}
-
 prg::Path prg::Path::subpath(const uint32_t start, const uint32_t len) const
 {
     // function now returns the path starting at position start along the path, rather
@@ -240,6 +208,16 @@ bool equal_except_null_nodes(const prg::Path& x, const prg::Path& y)
     return true;
 }
 
+size_t PathHash::operator()(const prg::Path& path) const
+{
+    size_t hash = 0;
+    for (const auto& interval : path) {
+        boost::hash_combine(hash, interval.start);
+        boost::hash_combine(hash, interval.length);
+    }
+    return hash;
+}
+
 bool prg::Path::operator!=(const prg::Path& y) const { return (!(path == y.path)); }
 
 std::ostream& prg::operator<<(std::ostream& out, const prg::Path& p)
@@ -0,0 +1,112 @@
+#include <stdexcept>
+#include <utility>
+#include "read_batch_reader.h"
+#include "fastaq_handler.h"
+
+ReadBatchReader::ReadBatchReader(
+    const std::string& filepath, const uint32_t batch_size, const uint32_t queue_depth)
+    : batch_size { batch_size }
+    , queue_depth { queue_depth }
+    , fh { new FastaqHandler(filepath) }
+{
+    if (batch_size == 0 or queue_depth == 0) {
+        throw std::invalid_argument("Batches of reads and their queue can't be empty");
+    }
+    reader = std::thread(&ReadBatchReader::read_batches, this);
+}
+
+ReadBatchReader::~ReadBatchReader()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopped = true;
+    }
+    queue_has_room.notify_all();
+    reader.join();
+}
+
+void ReadBatchReader::read_batches()
+{
+    uint32_t id { 0 };
+    try {
+        bool end_of_file { false };
+        while (not end_of_file) {
+            ReadBatch batch;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                queue_has_room.wait(lock,
+                    [this] { return stopped or ready_batches.size() < queue_depth; });
+                if (stopped) {
+                    return;
+                }
+                if (not free_batches.empty()) {
+                    batch = std::move(free_batches.back());
+                    free_batches.pop_back();
+                }
+            }
+
+            // inflate and parse the reads outside of the lock
+            batch.first_id = id;
+            batch.size = 0;
+            batch.names.resize(batch_size);
+            batch.reads.resize(batch_size);
+            while (batch.size < batch_size) {
+                try {
+                    fh->get_next();
+                } catch (std::out_of_range& err) {
+                    end_of_file = true;
+                    break;
+                }
+                batch.names[batch.size].assign(fh->name);
+                batch.reads[batch.size].assign(fh->read);
+                ++batch.size;
+                ++id;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (batch.size > 0) {
+                    ready_batches.push_back(std::move(batch));
+                }
+                finished = end_of_file;
+            }
+            batch_ready.notify_all();
+        }
+    } catch (...) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            error = std::current_exception();
+            finished = true;
+        }
+        batch_ready.notify_all();
+    }
+}
+
+bool ReadBatchReader::next_batch(ReadBatch& batch)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    if (not batch.names.empty()) {
+        free_batches.push_back(std::move(batch));
+    }
+    batch = ReadBatch();
+
+    batch_ready.wait(lock, [this] { return finished or not ready_batches.empty(); });
+    if (not ready_batches.empty()) {
+        batch = std::move(ready_batches.front());
+        ready_batches.pop_front();
+        num_reads_handed_out += batch.size;
+        lock.unlock();
+        queue_has_room.notify_one();
+        return true;
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return false;
+}
+
+uint32_t ReadBatchReader::number_of_reads() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return num_reads_handed_out;
+}
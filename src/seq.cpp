@@ -1,6 +1,6 @@
+#include <algorithm>
 #include <iostream>
 #include <vector>
-#include <cassert>
 #include <zconf.h>
 
 #include <boost/log/trivial.hpp>
@@ -10,14 +10,13 @@
 #include "seq.h"
 #include "utils.h"
 
-#define assert_msg(x) !(std::cerr << "Assertion failed: " << x << std::endl)
-
 using std::vector;
 
 Seq::Seq(uint32_t i, const std::string& n, const std::string& p, uint32_t w, uint32_t k)
     : id(i)
     , name(n)
     , seq(p)
+    , number_ambiguous_bases(0)
 {
     minimizer_sketch(w, k);
 }
@@ -34,109 +33,96 @@ void Seq::initialize(
     minimizer_sketch(w, k);
 }
 
-bool Seq::add_letter_to_get_next_kmer(const char& letter, const uint64_t& shift1,
-    const uint64_t& mask, uint32_t& buff, uint64_t (&kmer)[2], uint64_t (&kh)[2])
+void Seq::minimizer_sketch(const uint32_t w, const uint32_t k)
 {
-    uint32_t c = nt4((uint8_t)letter);
-    if (c < 4) { // not an ambiguous base
-        kmer[0] = (kmer[0] << 2 | c) & mask; // forward k-mer
-        kmer[1] = (kmer[1] >> 2) | (3ULL ^ c) << shift1; // reverse k-mer
-        kh[0] = hash64(kmer[0], mask);
-        kh[1] = hash64(kmer[1], mask);
-        buff++;
-        return true;
+    number_ambiguous_bases = 0;
+    // the defaults have their own kernels, other (w,k) use the generic one
+    if (w == 14 and k == 15) {
+        minimizer_sketch_of_sizes<14, 15>(w, k);
+    } else if (k == 15) {
+        minimizer_sketch_of_sizes<0, 15>(w, k);
     } else {
-        BOOST_LOG_TRIVIAL(debug)
-            << now() << "bad letter - found a non AGCT base in read so skipping read "
-            << name;
-        sketch.clear();
-        return false;
-    }
-}
-
-uint64_t find_smallest_kmer_value(
-    const vector<Minimizer>& window, uint& pos_of_smallest)
-{
-    uint64_t smallest = std::numeric_limits<uint64_t>::max();
-    uint i = 0;
-    for (const auto& minimizer : window) {
-        if (minimizer.canonical_kmer_hash <= smallest) {
-            smallest = minimizer.canonical_kmer_hash;
-            pos_of_smallest = i;
-        }
-        i++;
-    }
-    return smallest;
-}
-
-void Seq::add_minimizing_kmers_to_sketch(
-    const vector<Minimizer>& window, const uint64_t& smallest)
-{
-    for (const auto& minimizer : window) {
-        if (minimizer.canonical_kmer_hash == smallest) {
-            sketch.insert(minimizer);
-        }
+        minimizer_sketch_of_sizes<0, 0>(w, k);
     }
 }
 
-// finds the minimizer in the window, add the minimizer to the sketch set and erase
-// everything until the minimizer
-void Seq::minimize_window(vector<Minimizer>& window, uint64_t& smallest)
-{
-    uint pos_of_smallest;
-    smallest = find_smallest_kmer_value(window, pos_of_smallest);
-    add_minimizing_kmers_to_sketch(window, smallest);
-    window.erase(window.begin(), window.begin() + pos_of_smallest + 1);
-}
-
-// add the last element of the window (a Minimizer) to the sketch, update the smallest
-// and clear the window
-void Seq::add_new_smallest_minimizer(vector<Minimizer>& window, uint64_t& smallest)
-{
-    sketch.insert(window.back());
-    smallest = window.back().canonical_kmer_hash;
-    window.clear();
-}
-
-void Seq::minimizer_sketch(const uint32_t w, const uint32_t k)
+// Sliding window minimizers with a monotone deque: the window holds, in increasing
+// position, the k-mers of the current window of w k-mers which are smaller than all the
+// k-mers after them, so its front is the smallest k-mer of the window, and each k-mer
+// is pushed and popped at most once. Ties are all kept, so that every minimizer of a
+// window is added to the sketch, as they were when rescanning each window.
+// W and K are either the window and k-mer sizes, so that the compiler can fold them,
+// or 0 for any size.
+template <uint32_t W, uint32_t K>
+void Seq::minimizer_sketch_of_sizes(const uint32_t any_w, const uint32_t any_k)
 {
+    const uint32_t w = W == 0 ? any_w : W, k = K == 0 ? any_k : K;
     bool sequence_too_short_to_sketch = seq.length() + 1 < w + k;
     if (sequence_too_short_to_sketch)
         return;
 
-    // initializations
-    uint64_t shift1 = 2 * (k - 1), mask = (1ULL << 2 * k) - 1,
-             smallest = std::numeric_limits<uint64_t>::max(), kmer[2] = { 0, 0 },
-             kh[2] = { 0, 0 };
-    uint32_t buff = 0;
-    vector<Minimizer> window; // will store all k-mers as Minimizer in the window
-    window.reserve(w);
-
-    for (const char letter : seq) {
-        bool added = add_letter_to_get_next_kmer(letter, shift1, mask, buff, kmer,
-            kh); // add the next base and remove the first one to get the next kmer
-        if (not added)
-            return;
-
-        if (buff >= k) {
-            window.push_back(
-                Minimizer(std::min(kh[0], kh[1]), buff - k, buff, (kh[0] <= kh[1])));
+    forward_hashes.resize(seq.length());
+    reverse_hashes.resize(seq.length());
+    window.resize(w);
+    sketch.reserve(2 * (seq.length() + 1 - k) / (w + 1));
+
+    // the k-mers of each stretch of ACGT letters are hashed at once and sketched on
+    // their own: k-mers and windows restart after each non ACGT letter
+    uint32_t stretch_start = 0;
+    while (stretch_start < seq.length()) {
+        const uint32_t stretch_length = hash_kmers(seq.data() + stretch_start,
+            seq.length() - stretch_start, k, forward_hashes.data() + stretch_start,
+            reverse_hashes.data() + stretch_start);
+        const uint32_t stretch_end = stretch_start + stretch_length;
+
+        // the deque is window[(first + i) % w] for i < size, and its first
+        // number_in_sketch k-mers have already been added to the sketch
+        uint32_t first = 0, size = 0, number_in_sketch = 0;
+        const auto deque_at = [&](const uint32_t& i) -> Minimizer& {
+            return window[(first + i) % w];
+        };
+        for (uint32_t kmer_start = stretch_start; kmer_start + k <= stretch_end;
+             ++kmer_start) {
+            const uint64_t forward_hash = forward_hashes[kmer_start],
+                           reverse_hash = reverse_hashes[kmer_start],
+                           kmer_hash = std::min(forward_hash, reverse_hash);
+
+            // the first k-mer leaves the window, it was a minimizer of the previous one
+            if (size > 0 and deque_at(0).pos_of_kmer_in_read.start + w <= kmer_start) {
+                first = (first + 1) % w;
+                --size;
+                if (number_in_sketch > 0)
+                    --number_in_sketch;
+            }
+            // larger k-mers can't minimize any window which contains the new one
+            while (size > 0 and deque_at(size - 1).canonical_kmer_hash > kmer_hash) {
+                --size;
+            }
+            number_in_sketch = std::min(number_in_sketch, size);
+            deque_at(size++) = Minimizer(
+                kmer_hash, kmer_start, kmer_start + k, (forward_hash <= reverse_hash));
+
+            if (kmer_start + 1 >= stretch_start + w) { // the window is full
+                const uint64_t smallest = deque_at(0).canonical_kmer_hash;
+                while (number_in_sketch < size
+                    and deque_at(number_in_sketch).canonical_kmer_hash == smallest) {
+                    sketch.push_back(deque_at(number_in_sketch++));
+                }
+            }
         }
 
-        if (window.size() == w) {
-            minimize_window(window,
-                smallest); // finds the minimizer in the window, add the minimizer to
-                           // the sketch set and erase everything until the minimizer
-        } else if (buff >= w + k and window.back().canonical_kmer_hash <= smallest) {
-            add_new_smallest_minimizer(window,
-                smallest); // add the last element of the window (a Minimizer) to the
-                           // sketch, update the smallest and clear the window
+        stretch_start = stretch_end;
+        if (stretch_start < seq.length()) {
+            ++number_ambiguous_bases;
+            ++stretch_start;
         }
-        assert(window.size() < w
-            || assert_msg("we can't have added a smallest kmer correctly as window "
-                          "still has size "
-                << window.size()));
     }
+    if (number_ambiguous_bases > 0) {
+        BOOST_LOG_TRIVIAL(debug)
+            << now() << "found " << number_ambiguous_bases << " non AGCT bases in read "
+            << name << ", restarting its k-mers after each of them";
+    }
+    std::sort(sketch.begin(), sketch.end());
 }
 
 std::ostream& operator<<(std::ostream& out, Seq const& data)
@@ -37,6 +37,11 @@ void setup_seq2path_subcommand(CLI::App& app)
     auto *check = seq2path_subcmd->add_flag(
         "--flag", opt->flag, "output success/fail rather than the node path");
 
+    seq2path_subcmd
+        ->add_option("-t,--threads", opt->threads, "Maximum number of threads to use")
+        ->type_name("INT")
+        ->capture_default_str();
+
     seq2path_subcmd->add_flag(
         "-v", opt->verbosity, "Verbosity of logging. Repeat for increased verbosity");
 
@@ -64,8 +69,9 @@ int pandora_seq2path(Seq2PathOptions const& opt)
 
     // load prg graphs and kmergraphs, for now assume there is only one PRG in this file
     std::vector<std::shared_ptr<LocalPRG>> prgs;
-    read_prg_file(prgs, opt.prgfile);
-    load_PRG_kmergraphs(prgs, opt.window_size, opt.kmer_size, opt.prgfile);
+    read_prg_file(prgs, opt.prgfile, 0, 0, false, opt.threads);
+    load_PRG_kmergraphs(
+        prgs, opt.window_size, opt.kmer_size, opt.prgfile, opt.threads);
 
     if (prgs.empty()) {
         BOOST_LOG_TRIVIAL(error) << "PRG is empty!";
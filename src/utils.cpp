@@ -12,12 +12,16 @@
 #include <boost/filesystem.hpp>
 
 #include "utils.h"
+#include "frozen_index.h"
 #include "seq.h"
 #include "localPRG.h"
 #include "pangenome/pangraph.h"
+#include "pangenome/pangraph_shard.h"
+#include "coverage_budget.h"
 #include "noise_filtering.h"
 #include "minihit.h"
 #include "fastaq_handler.h"
+#include "kmergraph_archive.h"
 
 #define assert_msg(x) !(std::cerr << "Assertion failed: " << x << std::endl)
 
@@ -108,11 +112,31 @@ float lognchoosek2(uint32_t n, uint32_t k1, uint32_t k2)
     return total;
 }
 
-void read_prg_file(
-    std::vector<std::shared_ptr<LocalPRG>>& prgs, const fs::path& filepath, uint32_t id)
+void read_prg_file(std::vector<std::shared_ptr<LocalPRG>>& prgs,
+    const fs::path& filepath, uint32_t id, uint32_t number_of_prgs_to_skip,
+    bool lazy, uint32_t threads, std::vector<std::string>* skipped_prg_names)
 {
     BOOST_LOG_TRIVIAL(debug) << "Loading PRGs from file " << filepath;
 
+    // the file is read in batches of records, and the LocalPRGs of a batch are built
+    // in parallel into their final places, so ids and order don't depend on threads
+    const uint32_t batch_size = 1024;
+    std::vector<std::pair<std::string, std::string>> batch; // names and sequences
+    batch.reserve(batch_size);
+    const auto build_batch = [&]() {
+        const auto first = prgs.size();
+        prgs.resize(first + batch.size());
+#pragma omp parallel for num_threads(threads) schedule(dynamic, 1)
+        for (uint32_t i = 0; i < batch.size(); ++i) {
+            // build a node in the graph, which will represent a LocalPRG (the graph is
+            // a list of nodes, each representing a LocalPRG)
+            prgs[first + i] = std::make_shared<LocalPRG>(
+                id + i, batch[i].first, batch[i].second, lazy);
+        }
+        id += batch.size();
+        batch.clear();
+    };
+
     FastaqHandler fh(filepath.string());
     while (!fh.eof()) {
         try {
@@ -122,38 +146,123 @@ void read_prg_file(
         }
         if (fh.name.empty() or fh.read.empty())
             continue;
-        auto s = std::make_shared<LocalPRG>(LocalPRG(id, fh.name,
-            fh.read)); // build a node in the graph, which will represent a LocalPRG
-                       // (the graph is a list of nodes, each representing a LocalPRG)
-        if (s != nullptr) {
-            prgs.push_back(s);
+        if (number_of_prgs_to_skip > 0) {
+            --number_of_prgs_to_skip;
             id++;
-        } else {
-            BOOST_LOG_TRIVIAL(error) << "Failed to make LocalPRG for " << fh.name;
-            exit(1);
+            if (skipped_prg_names != nullptr) {
+                skipped_prg_names->push_back(fh.name);
+            }
+            continue;
+        }
+        batch.emplace_back(fh.name, fh.read);
+        if (batch.size() == batch_size) {
+            build_batch();
         }
     }
+    build_batch();
     BOOST_LOG_TRIVIAL(debug) << "Number of LocalPRGs read: " << prgs.size();
 }
 
+namespace {
+const uint32_t nbOfGFAsPerDir = 4000;
+
+fs::path kmer_graph_gfa_file(const fs::path& dir, const LocalPRG& prg,
+    const uint32_t& w, const uint32_t& k)
+{
+    return dir
+        / (prg.name + ".k" + std::to_string(k) + ".w" + std::to_string(w) + ".gfa");
+}
+}
+
+void save_PRG_kmergraphs_as_gfa(const std::vector<std::shared_ptr<LocalPRG>>& prgs,
+    const uint32_t& w, const uint32_t& k, const fs::path& kmer_prgs_dir,
+    uint32_t threads)
+{
+    if (prgs.empty())
+        return;
+
+    // PRGs are put in directories by id, as load_PRG_kmergraphs() expects, so that
+    // PRGs appended to an index go along the ones already indexed
+    for (uint32_t i = prgs.front()->id / nbOfGFAsPerDir;
+         i <= prgs.back()->id / nbOfGFAsPerDir; ++i)
+        fs::create_directories(kmer_prgs_dir / int_to_string(i + 1));
+
+#pragma omp parallel for num_threads(threads) schedule(dynamic, 1)
+    for (uint32_t i = 0; i < prgs.size(); ++i) {
+        const auto dir { kmer_prgs_dir
+            / int_to_string(prgs[i]->id / nbOfGFAsPerDir + 1) };
+        prgs[i]->kmer_prg.save(kmer_graph_gfa_file(dir, *prgs[i], w, k));
+    }
+}
+
 void load_PRG_kmergraphs(std::vector<std::shared_ptr<LocalPRG>>& prgs,
-    const uint32_t& w, const uint32_t& k, const fs::path& prgfile)
+    const uint32_t& w, const uint32_t& k, const fs::path& prgfile,
+    uint32_t threads)
 {
     BOOST_LOG_TRIVIAL(debug) << "Loading kmer_prgs from files";
     const auto kmer_prgs_dir { prgfile.parent_path() / "kmer_prgs" };
 
-    auto dir_num = 0;
-    fs::path dir;
-    for (const auto& prg : prgs) {
-        if (prg->id % 4000 == 0) {
-            dir = kmer_prgs_dir / int_to_string(dir_num + 1);
-            dir_num++;
+    // the archive of the PRG file, then those of pieces of it or appended to it
+    const auto own_archive { kmer_graph_archive_file(prgfile, w, k) };
+    const std::string archive_suffix { ".k" + std::to_string(k) + ".w"
+        + std::to_string(w) + ".kga" };
+    std::vector<fs::path> archive_files;
+    if (fs::is_directory(kmer_prgs_dir)) {
+        for (const auto& entry : fs::directory_iterator(kmer_prgs_dir)) {
+            const auto filename { entry.path().filename().string() };
+            if (entry.path() != own_archive and filename.size() > archive_suffix.size()
+                and filename.compare(filename.size() - archive_suffix.size(),
+                        archive_suffix.size(), archive_suffix)
+                    == 0) {
+                archive_files.push_back(entry.path());
+            }
+        }
+    }
+    std::sort(archive_files.begin(), archive_files.end());
+    if (fs::exists(own_archive)) {
+        archive_files.insert(archive_files.begin(), own_archive);
+    }
+
+    // the archive having the graph of each PRG, if any. Archives of other PRG files in
+    // the same directory may cover the same ids, so the names must match
+    std::vector<std::shared_ptr<const KmerGraphArchive>> archive_of_prg(prgs.size());
+    for (const auto& archive_file : archive_files) {
+        std::shared_ptr<const KmerGraphArchive> archive;
+        try {
+            archive = std::make_shared<const KmerGraphArchive>(archive_file);
+        } catch (const std::runtime_error& err) {
+            fatal_error(err.what());
+        }
+        for (uint32_t i = 0; i < prgs.size(); ++i) {
+            if (archive_of_prg[i] == nullptr and archive->contains(prgs[i]->id)
+                and archive->prg_name(prgs[i]->id) == prgs[i]->name) {
+                archive_of_prg[i] = archive;
+            }
+        }
+    }
+
+    // lazy PRGs keep the archive of their graph mapped until they are materialized
+#pragma omp parallel for num_threads(threads) schedule(dynamic, 10)
+    for (uint32_t i = 0; i < prgs.size(); ++i) {
+        const auto& prg = prgs[i];
+        std::function<void(KmerGraph&)> loader;
+        if (archive_of_prg[i] != nullptr) {
+            const auto archive { archive_of_prg[i] };
+            const auto prg_id { prg->id };
+            loader = [archive, prg_id](
+                         KmerGraph& kmer_graph) { archive->load(prg_id, kmer_graph); };
+        } else {
+            auto dir { kmer_prgs_dir / int_to_string(prg->id / nbOfGFAsPerDir + 1) };
             if (not fs::exists(dir))
                 dir = kmer_prgs_dir;
+            const auto gfa_file { kmer_graph_gfa_file(dir, *prg, w, k) };
+            loader = [gfa_file](KmerGraph& kmer_graph) { kmer_graph.load(gfa_file); };
+        }
+        if (prg->is_materialized()) {
+            loader(prg->kmer_prg);
+        } else {
+            prg->set_kmer_graph_loader(loader);
         }
-        const auto filename { prg->name + ".k" + std::to_string(k) + ".w"
-            + std::to_string(w) + ".gfa" };
-        prg->kmer_prg.load(dir / filename);
     }
 }
 
@@ -175,21 +284,23 @@ void load_vcf_refs_file(const fs::path& filepath, VCFRefs& vcf_refs)
 }
 
 void add_read_hits(const Seq& sequence,
-    const std::shared_ptr<MinimizerHits>& minimizer_hits, const Index& index)
+    const std::shared_ptr<MinimizerHits>& minimizer_hits, const FrozenIndex& index,
+    IndexLookupStats* lookup_stats)
 {
-    // creates Seq object for the read, then looks up minimizers in the Seq sketch and
-    // adds hits to a global MinimizerHits object
-    // Seq s(id, name, seq, w, k);
-    for (auto sequenceSketchIt = sequence.sketch.begin();
-         sequenceSketchIt != sequence.sketch.end(); ++sequenceSketchIt) {
-        auto minhashIt = index.minhash.find((*sequenceSketchIt).canonical_kmer_hash);
-        if (minhashIt != index.minhash.end()) { // checks if the kmer is in the index
-            // yes, add all hits of this minimizer hit to this kmer
-            for (const MiniRecord& miniRecord : *(minhashIt->second)) {
-                minimizer_hits->add_hit(sequence.id, *sequenceSketchIt, miniRecord);
-            }
+    // looks up minimizers in the Seq sketch and adds hits to a global MinimizerHits
+    // object
+    IndexLookupStats stats;
+    for (const auto& minimizer : sequence.sketch) {
+        // all hits of this minimizer, empty if the kmer is not in the index
+        for (const auto& record : index.find(minimizer.canonical_kmer_hash, stats)) {
+            minimizer_hits->add_hit(sequence.id, minimizer, record.prg_id,
+                index.get_path(record), record.knode_id, record.strand != 0,
+                index.get_record_id(record));
         }
     }
+    if (lookup_stats != nullptr) {
+        *lookup_stats += stats;
+    }
 }
 
 void define_clusters(std::set<MinimizerHitCluster, clusterComp>& clusters_of_hits,
@@ -204,64 +315,54 @@ void define_clusters(std::set<MinimizerHitCluster, clusterComp>& clusters_of_hit
     if (minimizer_hits->hits.empty()) {
         return;
     }
+    minimizer_hits->sort();
+    const auto& hits = minimizer_hits->hits;
+
+    // keep clusters which cover at least 1/2 the expected number of minihits. The
+    // graphs of a lazy PRG are built when a cluster which may be kept first hits it,
+    // so clusters of noise don't build them
+    const auto add_cluster_if_large_enough = [&](const size_t begin, const size_t end) {
+        if (end - begin <= min_cluster_size) {
+            BOOST_LOG_TRIVIAL(trace) << "Rejected cluster of size " << end - begin
+                                     << " <= " << min_cluster_size;
+            return;
+        }
+        const auto& prg = prgs[hits[begin].prg_id];
+        prg->materialize();
+        const uint32_t length_based_threshold
+            = std::min(prg->kmer_prg.min_path_length(),
+                  expected_number_kmers_in_short_read_sketch)
+            * fraction_kmers_required_for_cluster;
+        BOOST_LOG_TRIVIAL(trace)
+            << "Length based cluster threshold min(" << prg->kmer_prg.min_path_length()
+            << ", " << expected_number_kmers_in_short_read_sketch << ") * "
+            << fraction_kmers_required_for_cluster << " = " << length_based_threshold;
+
+        if (end - begin > std::max(length_based_threshold, min_cluster_size)) {
+            clusters_of_hits.insert(minimizer_hits->cluster(begin, end));
+        } else {
+            BOOST_LOG_TRIVIAL(trace)
+                << "Rejected cluster of size " << end - begin << " < max("
+                << length_based_threshold << ", " << min_cluster_size << ")";
+        }
+    };
 
     // A cluster of hits should match same localPRG, each hit not more than max_diff
     // read bases from the last hit (this last bit is to handle repeat genes).
-    auto mh_previous = minimizer_hits->hits.begin();
-    MinimizerHitCluster current_cluster;
-    current_cluster.insert(*mh_previous);
-    uint32_t length_based_threshold;
-    for (auto mh_current = ++minimizer_hits->hits.begin();
-         mh_current != minimizer_hits->hits.end(); ++mh_current) {
-        if ((*mh_current)->get_read_id() != (*mh_previous)->get_read_id()
-            or (*mh_current)->get_prg_id() != (*mh_previous)->get_prg_id()
-            or (*mh_current)->is_forward() != (*mh_previous)->is_forward()
-            or (abs((int)(*mh_current)->get_read_start_position()
-                   - (int)(*mh_previous)->get_read_start_position()))
+    size_t cluster_start = 0;
+    for (size_t i = 1; i < hits.size(); ++i) {
+        const auto& previous = hits[i - 1];
+        const auto& current = hits[i];
+        if (current.read_id != previous.read_id or current.prg_id != previous.prg_id
+            or current.is_forward() != previous.is_forward()
+            or (abs((int)current.read_start_position
+                   - (int)previous.read_start_position))
                 > max_diff) {
-            // keep clusters which cover at least 1/2 the expected number of minihits
-            length_based_threshold
-                = std::min(
-                      prgs[(*mh_previous)->get_prg_id()]->kmer_prg.min_path_length(),
-                      expected_number_kmers_in_short_read_sketch)
-                * fraction_kmers_required_for_cluster;
-            BOOST_LOG_TRIVIAL(trace)
-                << "Length based cluster threshold min("
-                << prgs[(*mh_previous)->get_prg_id()]->kmer_prg.min_path_length()
-                << ", " << expected_number_kmers_in_short_read_sketch << ") * "
-                << fraction_kmers_required_for_cluster << " = "
-                << length_based_threshold;
-
-            if (current_cluster.size()
-                > std::max(length_based_threshold, min_cluster_size)) {
-                clusters_of_hits.insert(current_cluster);
-            } else {
-                BOOST_LOG_TRIVIAL(trace)
-                    << "Rejected cluster of size " << current_cluster.size()
-                    << " < max(" << length_based_threshold << ", " << min_cluster_size
-                    << ")";
-            }
-            current_cluster.clear();
+            add_cluster_if_large_enough(cluster_start, i);
+            cluster_start = i;
         }
-        current_cluster.insert(*mh_current);
-        mh_previous = mh_current;
-    }
-    length_based_threshold
-        = std::min(prgs[(*mh_previous)->get_prg_id()]->kmer_prg.min_path_length(),
-              expected_number_kmers_in_short_read_sketch)
-        * fraction_kmers_required_for_cluster;
-    BOOST_LOG_TRIVIAL(trace)
-        << "Length based cluster threshold min("
-        << prgs[(*mh_previous)->get_prg_id()]->kmer_prg.min_path_length() << ", "
-        << expected_number_kmers_in_short_read_sketch << ") * "
-        << fraction_kmers_required_for_cluster << " = " << length_based_threshold;
-    if (current_cluster.size() > std::max(length_based_threshold, min_cluster_size)) {
-        clusters_of_hits.insert(current_cluster);
-    } else {
-        BOOST_LOG_TRIVIAL(trace)
-            << "Rejected cluster of size " << current_cluster.size() << " < max("
-            << length_based_threshold << ", " << min_cluster_size << ")";
     }
+    add_cluster_if_large_enough(cluster_start, hits.size());
 
     BOOST_LOG_TRIVIAL(trace) << "Found " << clusters_of_hits.size()
                              << " clusters of hits";
@@ -374,117 +475,128 @@ void add_clusters_to_pangraph(
     }
 }
 
-void infer_localPRG_order_for_reads(const std::vector<std::shared_ptr<LocalPRG>>& prgs,
-    std::shared_ptr<MinimizerHits> minimizer_hits,
-    std::shared_ptr<pangenome::Graph> pangraph, const int max_diff,
-    const uint32_t& genome_size, const float& fraction_kmers_required_for_cluster,
-    const uint32_t min_cluster_size,
+// this step infers the gene order for a read by defining clusters of hits, keeping
+// those which are not noise
+std::set<MinimizerHitCluster, clusterComp> infer_localPRG_order_for_read(
+    const std::vector<std::shared_ptr<LocalPRG>>& prgs,
+    std::shared_ptr<MinimizerHits> minimizer_hits, const int max_diff,
+    const float& fraction_kmers_required_for_cluster, const uint32_t min_cluster_size,
     const uint32_t expected_number_kmers_in_short_read_sketch)
 {
-    // this step infers the gene order for a read and adds this to the pangraph
-    // by defining clusters of hits, keeping those which are not noise and
-    // then adding the inferred gene ordering
+    std::set<MinimizerHitCluster, clusterComp> clusters_of_hits;
     if (minimizer_hits->hits.empty()) {
-        return;
+        return clusters_of_hits;
     }
 
-    std::set<MinimizerHitCluster, clusterComp> clusters_of_hits;
     define_clusters(clusters_of_hits, prgs, minimizer_hits, max_diff,
         fraction_kmers_required_for_cluster, min_cluster_size,
         expected_number_kmers_in_short_read_sketch);
 
     filter_clusters(clusters_of_hits);
     // filter_clusters2(clusters_of_hits, genome_size);
+    return clusters_of_hits;
+}
 
-#pragma omp critical(pangraph)
-    {
-        add_clusters_to_pangraph(clusters_of_hits, pangraph, prgs);
+void infer_localPRG_order_for_reads(const std::vector<std::shared_ptr<LocalPRG>>& prgs,
+    std::shared_ptr<MinimizerHits> minimizer_hits,
+    std::shared_ptr<pangenome::Graph> pangraph, const int max_diff,
+    const uint32_t& genome_size, const float& fraction_kmers_required_for_cluster,
+    const uint32_t min_cluster_size,
+    const uint32_t expected_number_kmers_in_short_read_sketch)
+{
+    // this step infers the gene order for a read and adds this to the pangraph
+    auto clusters_of_hits = infer_localPRG_order_for_read(prgs, minimizer_hits,
+        max_diff, fraction_kmers_required_for_cluster, min_cluster_size,
+        expected_number_kmers_in_short_read_sketch);
+    add_clusters_to_pangraph(clusters_of_hits, pangraph, prgs);
+}
+
+void infer_localPRG_order_for_reads(const std::vector<std::shared_ptr<LocalPRG>>& prgs,
+    std::shared_ptr<MinimizerHits> minimizer_hits, pangenome::GraphShard& shard,
+    const int max_diff, const float& fraction_kmers_required_for_cluster,
+    const uint32_t min_cluster_size,
+    const uint32_t expected_number_kmers_in_short_read_sketch)
+{
+    // same, keeping the gene order in the shard of this thread until it is added to
+    // the pangraph
+    const auto clusters_of_hits = infer_localPRG_order_for_read(prgs, minimizer_hits,
+        max_diff, fraction_kmers_required_for_cluster, min_cluster_size,
+        expected_number_kmers_in_short_read_sketch);
+    for (const auto& cluster : clusters_of_hits) {
+        shard.add_cluster(cluster);
     }
 }
 
 // TODO: this should be in a constructor of pangenome::Graph or in a factory class
 uint32_t pangraph_from_read_file(const std::string& filepath,
-    std::shared_ptr<pangenome::Graph> pangraph, std::shared_ptr<Index> index,
+    std::shared_ptr<pangenome::Graph> pangraph, std::shared_ptr<FrozenIndex> index,
     const std::vector<std::shared_ptr<LocalPRG>>& prgs, const uint32_t w,
     const uint32_t k, const int max_diff, const float& e_rate,
     const uint32_t min_cluster_size, const uint32_t genome_size, const bool illumina,
-    const bool clean, const uint32_t max_covg, uint32_t threads)
+    const bool clean, const uint32_t max_covg, uint32_t threads,
+    const uint32_t read_batch_size, const uint32_t read_queue_depth)
 {
     // constant variables
     const double fraction_kmers_required_for_cluster = 0.5 / exp(e_rate * k);
-    const uint32_t nb_reads_to_map_in_a_batch = 1000; // nb of reads to map in a batch
 
-    // shared variable - controlled by critical(covg)
-    uint64_t covg { 0 };
+    // shared, without locking: the bases of reads which can be mapped before reaching
+    // max_covg
+    CoverageBudget coverage_budget(genome_size, max_covg);
 
-    // shared variables - controlled by critical(ReadFileMutex)
-    FastaqHandler fh(filepath);
-    uint32_t id { 0 };
+    // shared variables - controlled by critical(lookup_stats)
+    IndexLookupStats lookup_stats;
+    uint32_t number_reads_with_ambiguous_bases { 0 };
+
+    // the reads store their hits as ids of records of the index
+    pangraph->hit_records->set_index(index);
+
+    // reads the file in a thread of its own, ahead of the mapping threads
+    ReadBatchReader reader(filepath, read_batch_size, read_queue_depth);
+
+    // the reads mapped by each thread, added to the pangraph once all are mapped -
+    // controlled by critical(lookup_stats)
+    std::vector<pangenome::GraphShard> shards;
 
 // parallel region
 #pragma omp parallel num_threads(threads)
     {
-        // will hold the reads batch
-        std::vector<Seq> sequencesBuffer(
-            nb_reads_to_map_in_a_batch, Seq(0, "null", "", w, k));
-        while (true) {
-            // read the next batch of reads
-            uint32_t nbOfReads = 0;
-
-// read the reads in batch
-#pragma omp critical(ReadFileMutex)
-            {
-                for (auto& sequence : sequencesBuffer) {
-                    if (id && id % 100000 == 0) {
-                        BOOST_LOG_TRIVIAL(info) << id << " reads processed...";
-                    }
-                    try {
-                        fh.get_next();
-                    } catch (std::out_of_range& err) {
-                        break;
-                    }
-                    sequence.initialize(id, fh.name, fh.read, w, k);
-                    ++nbOfReads;
-                    ++id;
-                }
+        IndexLookupStats thread_lookup_stats;
+        uint32_t thread_reads_with_ambiguous_bases { 0 };
+
+        // the hits of each read, in buffers reused from read to read
+        auto minimizer_hits = std::make_shared<MinimizerHits>();
+        pangenome::GraphShard shard(index);
+
+        // the reads batch and the read being mapped
+        ReadBatch batch;
+        Seq sequence(0, "null", "", w, k);
+        CoverageBudget::Reservation coverage_reservation(coverage_budget);
+        while (not coverage_budget.is_exceeded() and reader.next_batch(batch)) {
+            // reserve the coverage of the batch of reads at once
+            uint64_t batch_length { 0 };
+            for (uint32_t i = 0; i < batch.size; i++) {
+                batch_length += batch.reads[i].length();
             }
-
-            if (nbOfReads == 0)
-                break; // we reached the end of the file, nothing else to map
+            coverage_reservation.reserve(batch_length);
 
             // quasimap the batch of reads
-            bool coverageExceeded = false;
-            for (uint32_t i = 0; i < nbOfReads; i++) {
-                const auto& sequence = sequencesBuffer[i];
+            for (uint32_t i = 0; i < batch.size; i++) {
+                const uint32_t id = batch.first_id + i;
+                if (id && id % 100000 == 0) {
+                    BOOST_LOG_TRIVIAL(info) << id << " reads processed...";
+                }
+                sequence.initialize(id, batch.names[i], batch.reads[i], w, k);
+                if (sequence.number_ambiguous_bases > 0) {
+                    ++thread_reads_with_ambiguous_bases;
+                }
 
                 // checks if we are still good regarding coverage
-                if (!sequence.sketch.empty()) {
-#pragma omp critical(covg)
-                    {
-                        // check if the max_covg was already exceeded
-                        if (covg / genome_size > max_covg) {
-                            // if reached here, it means that another thread realised
-                            // that we went past the max_covg, so we just exit
-                            coverageExceeded = true;
-                        } else {
-                            // no other thread still signalized exceeding max coverage
-                            covg += sequence.seq.length();
-                            if (covg / genome_size > max_covg) {
-                                // oops, we are the first one to see max_covg being
-                                // exceeded, print and exit!
-                                BOOST_LOG_TRIVIAL(warning)
-                                    << "Stop processing reads as have reached max "
-                                       "coverage";
-                                coverageExceeded = true;
-                            }
-                        }
-                    }
-
-                    if (coverageExceeded)
-                        break; // max covg exceeded, get out
-                } else {
+                if (sequence.sketch.empty()) {
                     continue;
                 }
+                if (not coverage_reservation.consume(sequence.seq.length())) {
+                    break; // max covg exceeded, get out
+                }
 
                 uint32_t expected_number_kmers_in_short_read_sketch {
                     std::numeric_limits<uint32_t>::max()
@@ -498,24 +610,35 @@ uint32_t pangraph_from_read_file(const std::string& filepath,
                 }
 
                 // get the minizer hits
-                auto minimizer_hits = std::make_shared<MinimizerHits>(MinimizerHits());
-                add_read_hits(sequence, minimizer_hits, *index);
+                minimizer_hits->clear();
+                add_read_hits(sequence, minimizer_hits, *index, &thread_lookup_stats);
 
                 // infer
-                infer_localPRG_order_for_reads(prgs, minimizer_hits, pangraph, max_diff,
-                    genome_size, fraction_kmers_required_for_cluster, min_cluster_size,
+                infer_localPRG_order_for_reads(prgs, minimizer_hits, shard, max_diff,
+                    fraction_kmers_required_for_cluster, min_cluster_size,
                     expected_number_kmers_in_short_read_sketch);
             }
+            coverage_reservation.release();
+        }
 
-            if (coverageExceeded)
-                break; // max_covg exceeded, get out
+#pragma omp critical(lookup_stats)
+        {
+            lookup_stats += thread_lookup_stats;
+            number_reads_with_ambiguous_bases += thread_reads_with_ambiguous_bases;
+            shards.push_back(std::move(shard));
         }
     }
-    BOOST_LOG_TRIVIAL(info) << "Processed " << id << " reads";
+    pangenome::GraphShard::merge(shards, *pangraph, prgs);
+    BOOST_LOG_TRIVIAL(info) << "Processed " << reader.number_of_reads() << " reads";
+    BOOST_LOG_TRIVIAL(info) << number_reads_with_ambiguous_bases
+                            << " reads had non ACGT bases, which their k-mers skip";
+    BOOST_LOG_TRIVIAL(info) << lookup_stats;
 
     BOOST_LOG_TRIVIAL(debug) << "Pangraph has " << pangraph->nodes.size() << " nodes";
 
-    covg = covg / genome_size;
+    BOOST_LOG_TRIVIAL(debug) << "Reads of " << coverage_budget.bases_consumed()
+                             << " bases count towards the coverage";
+    const uint64_t covg = coverage_budget.bases_consumed() / genome_size;
     BOOST_LOG_TRIVIAL(debug) << "Estimated coverage: " << covg;
 
     if (illumina and clean) {
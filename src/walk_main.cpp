@@ -22,6 +22,11 @@ void setup_walk_subcommand(CLI::App& app)
     auto* bottom = walk_subcmd->add_flag(
         "-B,--bottom", opt->bottom, "Output the bottom path through each local PRG");
 
+    walk_subcmd
+        ->add_option("-t,--threads", opt->threads, "Maximum number of threads to use")
+        ->type_name("INT")
+        ->capture_default_str();
+
     input->excludes(top)->excludes(bottom);
     top->excludes(bottom);
 
@@ -32,7 +37,7 @@ void setup_walk_subcommand(CLI::App& app)
 int pandora_walk(WalkOptions const& opt)
 {
     std::vector<std::shared_ptr<LocalPRG>> prgs;
-    read_prg_file(prgs, opt.prgfile);
+    read_prg_file(prgs, opt.prgfile, 0, 0, false, opt.threads);
 
     std::vector<LocalNodePtr> npath;
 
@@ -0,0 +1,115 @@
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "coverage_budget.h"
+
+using namespace std;
+
+TEST(CoverageBudgetTest, consume_readsWithinMaxCovg)
+{
+    CoverageBudget budget(10, 2);
+    {
+        CoverageBudget::Reservation reservation(budget);
+        reservation.reserve(15);
+        EXPECT_TRUE(reservation.consume(10));
+        EXPECT_TRUE(reservation.consume(10));
+        // up to 29 bases, the coverage is still 2
+        EXPECT_TRUE(reservation.consume(9));
+    }
+    EXPECT_FALSE(budget.is_exceeded());
+    EXPECT_EQ(budget.bases_consumed(), (uint64_t)29);
+}
+
+TEST(CoverageBudgetTest, consume_readExceedingMaxCovgIsCountedButNotMapped)
+{
+    CoverageBudget budget(10, 2);
+    CoverageBudget::Reservation reservation(budget);
+    EXPECT_TRUE(reservation.consume(25));
+    EXPECT_FALSE(reservation.consume(5));
+    EXPECT_TRUE(budget.is_exceeded());
+
+    // nor are the reads after it, which are not counted
+    EXPECT_FALSE(reservation.consume(1));
+    reservation.release();
+    EXPECT_EQ(budget.bases_consumed(), (uint64_t)30);
+}
+
+TEST(CoverageBudgetTest, release_givesBackUnconsumedBases)
+{
+    CoverageBudget budget(10, 2);
+    CoverageBudget::Reservation reservation(budget);
+    reservation.reserve(29);
+    EXPECT_TRUE(reservation.consume(4));
+    reservation.release();
+
+    // so another reservation can consume them
+    CoverageBudget::Reservation other_reservation(budget);
+    EXPECT_TRUE(other_reservation.consume(25));
+    EXPECT_FALSE(reservation.consume(1));
+    EXPECT_TRUE(budget.is_exceeded());
+    other_reservation.release();
+    reservation.release();
+    EXPECT_EQ(budget.bases_consumed(), (uint64_t)30);
+}
+
+TEST(CoverageBudgetTest, consume_readFitsOnceOtherReservationsGiveBack)
+{
+    CoverageBudget budget(10, 2);
+    CoverageBudget::Reservation reservation(budget);
+    reservation.reserve(25);
+    EXPECT_TRUE(reservation.consume(5));
+
+    // this read only fits once the first reservation gives back what it didn't use
+    bool other_read_mapped = false;
+    thread other_thread([&budget, &other_read_mapped] {
+        CoverageBudget::Reservation other_reservation(budget);
+        other_read_mapped = other_reservation.consume(10);
+    });
+    EXPECT_TRUE(reservation.consume(10));
+    reservation.release();
+    other_thread.join();
+
+    EXPECT_TRUE(other_read_mapped);
+    EXPECT_FALSE(budget.is_exceeded());
+    EXPECT_EQ(budget.bases_consumed(), (uint64_t)25);
+}
+
+TEST(CoverageBudgetTest, consume_manyThreadsExceedMaxCovgOnce)
+{
+    const uint32_t number_of_threads = 4;
+    CoverageBudget budget(100, 10);
+    vector<uint64_t> bases_mapped(number_of_threads, 0);
+
+    vector<thread> threads;
+    for (uint32_t t = 0; t < number_of_threads; ++t) {
+        threads.emplace_back([&budget, &bases_mapped, t] {
+            CoverageBudget::Reservation reservation(budget);
+            while (not budget.is_exceeded()) {
+                reservation.reserve(70);
+                for (uint32_t i = 0; i < 10; ++i) {
+                    if (not reservation.consume(7)) {
+                        break;
+                    }
+                    bases_mapped[t] += 7;
+                }
+                reservation.release();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    uint64_t total_bases_mapped = 0;
+    for (const auto& bases : bases_mapped) {
+        total_bases_mapped += bases;
+    }
+    // the reads are mapped up to the maximum coverage whatever the other threads held
+    // when the budget ran out, and the read exceeding it is the only one counted
+    // without being mapped
+    EXPECT_LE(total_bases_mapped, (uint64_t)1099);
+    EXPECT_GE(total_bases_mapped, (uint64_t)1099 - 7);
+    EXPECT_EQ(budget.bases_consumed(), total_bases_mapped + 7);
+    EXPECT_TRUE(budget.is_exceeded());
+}
@@ -4,6 +4,7 @@
 #include "gtest/gtest.h"
 #include "pangenome/pangraph.h"
 #include "estimate_parameters.h"
+#include "frozen_index.h"
 
 using namespace std;
 
@@ -207,7 +208,8 @@ TEST(EstimateParameters_EstimateParameters, PangraphWithNodes_SimpleBinomial)
 
     auto pangraph = std::make_shared<pangenome::Graph>(pangenome::Graph());
     const auto filepath = TEST_CASE_DIR + "estimate_parameters_reads.fa";
-    pangraph_from_read_file(filepath, pangraph, index, prgs, w, k, 1, e_rate,
+    auto frozen_index = std::make_shared<FrozenIndex>(*index);
+    pangraph_from_read_file(filepath, pangraph, frozen_index, prgs, w, k, 1, e_rate,
         min_cluster_size, genome_size, illumina);
     pangraph->add_hits_to_kmergraphs(prgs);
 
@@ -231,7 +233,8 @@ TEST(
 
     auto pangraph = std::make_shared<pangenome::Graph>(pangenome::Graph());
     const auto filepath = TEST_CASE_DIR + "estimate_parameters_reads3.fa";
-    pangraph_from_read_file(filepath, pangraph, index, prgs, w, k, 1, e_rate,
+    auto frozen_index = std::make_shared<FrozenIndex>(*index);
+    pangraph_from_read_file(filepath, pangraph, frozen_index, prgs, w, k, 1, e_rate,
         min_cluster_size, genome_size, illumina);
     pangraph->add_hits_to_kmergraphs(prgs);
 
@@ -254,7 +257,8 @@ TEST(EstimateParameters_EstimateParameters, PangraphWithNodes_SimpleNegativeBino
 
     auto pangraph = std::make_shared<pangenome::Graph>(pangenome::Graph());
     const auto filepath = TEST_CASE_DIR + "estimate_parameters_reads.fa";
-    pangraph_from_read_file(filepath, pangraph, index, prgs, w, k, 1, e_rate,
+    auto frozen_index = std::make_shared<FrozenIndex>(*index);
+    pangraph_from_read_file(filepath, pangraph, frozen_index, prgs, w, k, 1, e_rate,
         min_cluster_size, genome_size, illumina);
     pangraph->add_hits_to_kmergraphs(prgs);
 
@@ -278,7 +282,8 @@ TEST(EstimateParameters_EstimateParameters,
 
     auto pangraph = std::make_shared<pangenome::Graph>(pangenome::Graph());
     const auto filepath = TEST_CASE_DIR + "estimate_parameters_reads4.fa";
-    pangraph_from_read_file(filepath, pangraph, index, prgs, w, k, 1, e_rate,
+    auto frozen_index = std::make_shared<FrozenIndex>(*index);
+    pangraph_from_read_file(filepath, pangraph, frozen_index, prgs, w, k, 1, e_rate,
         min_cluster_size, genome_size, illumina);
     pangraph->add_hits_to_kmergraphs(prgs);
 
@@ -303,7 +308,8 @@ TEST(EstimateParameters_EstimateParameters,
 
     auto pangraph = std::make_shared<pangenome::Graph>(pangenome::Graph());
     const auto filepath = TEST_CASE_DIR + "estimate_parameters_reads4.fa";
-    pangraph_from_read_file(filepath, pangraph, index, prgs, w, k, 1, e_rate,
+    auto frozen_index = std::make_shared<FrozenIndex>(*index);
+    pangraph_from_read_file(filepath, pangraph, frozen_index, prgs, w, k, 1, e_rate,
         min_cluster_size, genome_size, illumina);
     pangraph->add_hits_to_kmergraphs(prgs);
 
@@ -327,7 +333,8 @@ TEST(EstimateParameters_EstimateParameters, PangraphWithNodes_NoiseReads)
 
     auto pangraph = std::make_shared<pangenome::Graph>(pangenome::Graph());
     const auto filepath = TEST_CASE_DIR + "estimate_parameters_reads2.fa";
-    pangraph_from_read_file(filepath, pangraph, index, prgs, w, k, 1, e_rate,
+    auto frozen_index = std::make_shared<FrozenIndex>(*index);
+    pangraph_from_read_file(filepath, pangraph, frozen_index, prgs, w, k, 1, e_rate,
         min_cluster_size, genome_size, illumina);
     pangraph->add_hits_to_kmergraphs(prgs);
 
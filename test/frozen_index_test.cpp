@@ -0,0 +1,225 @@
+#include "gtest/gtest.h"
+#include "frozen_index.h"
+#include "index.h"
+#include "index_file.h"
+#include "prg/path.h"
+#include "interval.h"
+#include "inthash.h"
+#include <vector>
+#include <stdint.h>
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+using namespace std;
+
+class FrozenIndexTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        KmerHash hash;
+        p1.initialize(deque<Interval> { Interval(3, 5), Interval(9, 12) });
+        p2.initialize(Interval(0, 5));
+        auto kh = hash.kmerhash("ACGTA", 5);
+        key1 = min(kh.first, kh.second);
+        kh = hash.kmerhash("ACTGA", 5);
+        key2 = min(kh.first, kh.second);
+        kh = hash.kmerhash("TTTTT", 5);
+        absent_key = min(kh.first, kh.second);
+
+        // added out of order, as threads would
+        index.add_record(key1, 4, p2, 1, 1);
+        index.add_record(key1, 1, p1, 3, 0);
+        index.add_record(key2, 2, p2, 2, 0);
+        index.w = 1;
+        index.k = 5;
+        index.add_prg_id_range(1, 4);
+    }
+
+    Index index;
+    prg::Path p1, p2;
+    uint64_t key1, key2, absent_key;
+};
+
+TEST_F(FrozenIndexTest, emptyIndex_findsNothing)
+{
+    FrozenIndex frozen_index;
+    EXPECT_EQ(frozen_index.number_of_keys(), (uint64_t)0);
+    EXPECT_TRUE(frozen_index.find(key1).empty());
+    EXPECT_TRUE(frozen_index.find(0).empty());
+    EXPECT_TRUE(frozen_index.find(std::numeric_limits<uint64_t>::max()).empty());
+}
+
+TEST_F(FrozenIndexTest, freeze_keysSortedAndPathsInterned)
+{
+    const FrozenIndex frozen_index(index);
+
+    EXPECT_EQ(frozen_index.get_w(), (uint32_t)1);
+    EXPECT_EQ(frozen_index.get_k(), (uint32_t)5);
+    EXPECT_EQ(frozen_index.get_prg_id_offset(), (uint32_t)1);
+    EXPECT_EQ(frozen_index.get_num_prgs(), (uint32_t)4);
+    EXPECT_EQ(frozen_index.number_of_keys(), (uint64_t)2);
+    EXPECT_EQ(frozen_index.number_of_records(), (uint64_t)3);
+    EXPECT_EQ(frozen_index.number_of_paths(), (uint64_t)2);
+    EXPECT_LT(frozen_index.get_key(0), frozen_index.get_key(1));
+}
+
+TEST_F(FrozenIndexTest, find_recordsSortedByPrgId)
+{
+    const FrozenIndex frozen_index(index);
+
+    const auto records = frozen_index.find(key1);
+    ASSERT_EQ(records.size(), (size_t)2);
+    const auto& first = *records.begin();
+    const auto& second = *(records.begin() + 1);
+    EXPECT_EQ(first.prg_id, (uint32_t)1);
+    EXPECT_EQ(first.knode_id, (uint32_t)3);
+    EXPECT_EQ(first.strand, (uint32_t)0);
+    EXPECT_EQ(frozen_index.get_path(first), p1);
+    EXPECT_EQ(second.prg_id, (uint32_t)4);
+    EXPECT_EQ(second.knode_id, (uint32_t)1);
+    EXPECT_EQ(second.strand, (uint32_t)1);
+    EXPECT_EQ(frozen_index.get_path(second), p2);
+
+    // the same path is shared by records of different keys
+    const auto other_records = frozen_index.find(key2);
+    ASSERT_EQ(other_records.size(), (size_t)1);
+    EXPECT_EQ(&frozen_index.get_path(*other_records.begin()),
+        &frozen_index.get_path(second));
+}
+
+TEST_F(FrozenIndexTest, getPath_builtOnceByManyThreads)
+{
+    FrozenIndex(index).save("frozen_index_test.idx");
+    FrozenIndex loaded;
+    loaded.load("frozen_index_test.idx");
+    const auto& record = *loaded.find(key2).begin();
+
+    vector<const prg::Path*> paths(4, nullptr);
+    vector<thread> threads;
+    for (uint32_t t = 0; t < paths.size(); ++t) {
+        threads.emplace_back(
+            [&loaded, &record, &paths, t] { paths[t] = &loaded.get_path(record); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(*paths[0], p2);
+    for (const auto& path : paths) {
+        EXPECT_EQ(path, paths[0]);
+    }
+}
+
+TEST_F(FrozenIndexTest, find_absentKey_empty)
+{
+    const FrozenIndex frozen_index(index);
+    EXPECT_TRUE(frozen_index.find(absent_key).empty());
+}
+
+TEST_F(FrozenIndexTest, find_manyKeys_allFound)
+{
+    Index big_index;
+    prg::Path p;
+    p.initialize(Interval(0, 15));
+    std::vector<uint64_t> keys;
+    for (uint64_t i = 0; i < 1000; ++i) {
+        keys.push_back(hash64(i * 7919, (1ull << 30) - 1));
+        big_index.add_record(keys.back(), i, p, 0, 0);
+    }
+    const FrozenIndex frozen_index(big_index);
+    for (uint64_t i = 0; i < keys.size(); ++i) {
+        const auto records = frozen_index.find(keys[i]);
+        ASSERT_FALSE(records.empty());
+        EXPECT_EQ(records.begin()->prg_id, (uint32_t)i);
+        EXPECT_TRUE(frozen_index.find(keys[i] + (1ull << 30)).empty());
+    }
+}
+
+TEST_F(FrozenIndexTest, saveThenLoad_mappedIndexEqualsFrozenOne)
+{
+    FrozenIndex(index).save("frozen_index_test.idx");
+    EXPECT_TRUE(is_binary_index_file("frozen_index_test.idx"));
+
+    FrozenIndex loaded;
+    loaded.load("frozen_index_test.idx");
+    EXPECT_EQ(loaded.get_w(), (uint32_t)1);
+    EXPECT_EQ(loaded.get_k(), (uint32_t)5);
+    EXPECT_EQ(loaded.number_of_keys(), (uint64_t)2);
+    EXPECT_EQ(loaded.number_of_records(), (uint64_t)3);
+    EXPECT_EQ(loaded.number_of_paths(), (uint64_t)2);
+    const auto records = loaded.find(key1);
+    ASSERT_EQ(records.size(), (size_t)2);
+    EXPECT_EQ(loaded.get_path(*records.begin()), p1);
+    EXPECT_EQ(loaded.find(key2).size(), (size_t)1);
+    EXPECT_TRUE(loaded.find(absent_key).empty());
+
+    Index index_from_file;
+    index_from_file.load("frozen_index_test.idx");
+    EXPECT_EQ(index, index_from_file);
+}
+
+TEST_F(FrozenIndexTest, loadTextIndex_frozenAfterLoading)
+{
+    index.save("frozen_index_test.text.idx", IndexFormat::Text);
+
+    FrozenIndex loaded;
+    loaded.load("frozen_index_test.text.idx");
+    EXPECT_EQ(loaded.number_of_keys(), (uint64_t)2);
+    EXPECT_EQ(loaded.number_of_records(), (uint64_t)3);
+    EXPECT_EQ(loaded.find(key1).size(), (size_t)2);
+}
+
+TEST_F(FrozenIndexTest, find_maskedKey_emptyButRecordsKept)
+{
+    index.masked_minimizers.insert(key1);
+    const FrozenIndex frozen_index(index);
+    EXPECT_EQ(frozen_index.number_of_masked_keys(), (uint64_t)1);
+    EXPECT_TRUE(frozen_index.find(key1).empty());
+    EXPECT_EQ(frozen_index.find(key2).size(), (size_t)1);
+    EXPECT_EQ(frozen_index.number_of_records(), (uint64_t)3);
+
+    frozen_index.save("frozen_index_test.masked.idx");
+    FrozenIndex loaded;
+    loaded.load("frozen_index_test.masked.idx");
+    EXPECT_EQ(loaded.number_of_masked_keys(), (uint64_t)1);
+    EXPECT_TRUE(loaded.find(key1).empty());
+    EXPECT_EQ(loaded.find(key2).size(), (size_t)1);
+}
+
+TEST_F(FrozenIndexTest, findWithStats_countsOutcomes)
+{
+    index.masked_minimizers.insert(key2);
+    const FrozenIndex frozen_index(index);
+    IndexLookupStats stats;
+    frozen_index.find(key1, stats);
+    frozen_index.find(key2, stats);
+    frozen_index.find(absent_key, stats);
+
+    EXPECT_EQ(stats.lookups, (uint64_t)3);
+    EXPECT_EQ(stats.hits, (uint64_t)1);
+    EXPECT_EQ(stats.masked, (uint64_t)1);
+    EXPECT_EQ(stats.filtered, (uint64_t)0);
+    EXPECT_EQ(stats.false_positives(), (uint64_t)1);
+}
+
+TEST_F(FrozenIndexTest, membershipFilter_savedAndRejectsAbsentAndMaskedKeys)
+{
+    index.masked_minimizers.insert(key2);
+    index.with_membership_filter = true;
+    FrozenIndex(index).save("frozen_index_test.filter.idx");
+
+    FrozenIndex loaded;
+    loaded.load("frozen_index_test.filter.idx");
+    EXPECT_TRUE(loaded.has_membership_filter());
+    IndexLookupStats stats;
+    EXPECT_EQ(loaded.find(key1, stats).size(), (size_t)2);
+    EXPECT_TRUE(loaded.find(key2, stats).empty());
+    EXPECT_TRUE(loaded.find(absent_key, stats).empty());
+    EXPECT_EQ(stats.hits, (uint64_t)1);
+    EXPECT_EQ(stats.filtered, (uint64_t)2);
+
+    Index index_from_file;
+    index_from_file.load("frozen_index_test.filter.idx");
+    EXPECT_TRUE(index_from_file.with_membership_filter);
+}
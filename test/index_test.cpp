@@ -2,6 +2,10 @@
 #include "minirecord.h"
 #include "prg/path.h"
 #include "index.h"
+#include "localPRG.h"
+#include "index_file.h"
+#include "index_main.h"
+#include "frozen_index.h"
 #include "interval.h"
 #include "inthash.h"
 #include "utils.h"
@@ -9,6 +13,8 @@
 #include <stdint.h>
 #include <iostream>
 #include <algorithm>
+#include <fstream>
+#include <iterator>
 
 using namespace std;
 
@@ -43,6 +49,37 @@ TEST(IndexTest, add_record)
     EXPECT_EQ(j, idx.minhash[min(kh.first, kh.second)]->size());
 }
 
+TEST(IndexTest, add_sorted_minimizers)
+{
+    Index idx;
+    KmerHash hash;
+    prg::Path p1, p2;
+    p1.initialize(deque<Interval> { Interval(3, 5), Interval(9, 12) });
+    p2.initialize(Interval(0, 5));
+    pair<uint64_t, uint64_t> kh1 = hash.kmerhash("ACGTA", 5);
+    pair<uint64_t, uint64_t> kh2 = hash.kmerhash("ACTGA", 5);
+    const uint64_t key1 = min(kh1.first, kh1.second);
+    const uint64_t key2 = min(kh2.first, kh2.second);
+    idx.add_record(key1, 1, p1, 0, 0);
+
+    vector<vector<SketchedMinimizer>> runs(2);
+    runs[0] = { SketchedMinimizer { key1, 1, 0, 0, &p1 },
+        SketchedMinimizer { key2, 2, 1, 1, &p2 } };
+    runs[1] = { SketchedMinimizer { key1, 4, 2, 0, &p2 },
+        SketchedMinimizer { key2, 2, 1, 1, &p2 } };
+    for (auto& run : runs) {
+        sort(run.begin(), run.end());
+    }
+    idx.add_sorted_minimizers(runs);
+
+    // the record already in the index and the one in both runs are added once
+    EXPECT_EQ(idx.minhash.size(), (size_t)2);
+    EXPECT_EQ(idx.minhash[key1]->size(), (size_t)2);
+    EXPECT_EQ(idx.minhash[key2]->size(), (size_t)1);
+    EXPECT_EQ(idx.minhash[key1]->at(1), MiniRecord(4, p2, 2, 0));
+    EXPECT_EQ(idx.minhash[key2]->at(0), MiniRecord(2, p2, 1, 1));
+}
+
 TEST(IndexTest, clear)
 {
     Index idx;
@@ -105,6 +142,130 @@ TEST(IndexTest, load)
         idx2.minhash[min(kh2.first, kh2.second)]->at(0));
 }
 
+TEST(IndexTest, save_binaryStoresMetadataInHeader)
+{
+    Index idx;
+    KmerHash hash;
+    deque<Interval> d = { Interval(3, 5), Interval(9, 12) };
+    prg::Path p;
+    p.initialize(d);
+    pair<uint64_t, uint64_t> kh = hash.kmerhash("ACGTA", 5);
+    idx.add_record(min(kh.first, kh.second), 1, p, 0, 0);
+    idx.add_record(min(kh.first, kh.second), 4, p, 0, 0);
+    idx.add_prg_id_range(1, 4);
+    idx.save("indexbinary", 1, 5);
+
+    MappedIndexFile file("indexbinary.k5.w1.idx");
+    EXPECT_EQ(file.header().w, (uint32_t)1);
+    EXPECT_EQ(file.header().k, (uint32_t)5);
+    EXPECT_EQ(file.header().prg_id_offset, (uint32_t)1);
+    EXPECT_EQ(file.header().num_prgs, (uint32_t)4);
+    EXPECT_EQ(file.header().num_keys, (uint64_t)1);
+    EXPECT_EQ(file.header().num_records, (uint64_t)2);
+    // both records share the same path, which is interned once
+    EXPECT_EQ(file.header().num_paths, (uint64_t)1);
+    EXPECT_EQ(file.header().num_intervals, (uint64_t)2);
+}
+
+TEST(IndexTest, save_binaryAndTextLoadToEqualIndexes)
+{
+    Index idx, idx_from_binary, idx_from_text;
+    KmerHash hash;
+    deque<Interval> d = { Interval(3, 5), Interval(9, 12) };
+    prg::Path p1, p2;
+    p1.initialize(d);
+    p2.initialize(Interval(0, 5));
+    pair<uint64_t, uint64_t> kh1 = hash.kmerhash("ACGTA", 5);
+    pair<uint64_t, uint64_t> kh2 = hash.kmerhash("ACTGA", 5);
+    idx.add_record(min(kh1.first, kh1.second), 1, p1, 3, 0);
+    idx.add_record(min(kh1.first, kh1.second), 4, p2, 1, 1);
+    idx.add_record(min(kh2.first, kh2.second), 2, p2, 2, 0);
+    idx.save("indexroundtrip.binary.idx");
+    idx.save("indexroundtrip.text.idx", IndexFormat::Text);
+
+    EXPECT_TRUE(is_binary_index_file("indexroundtrip.binary.idx"));
+    EXPECT_FALSE(is_binary_index_file("indexroundtrip.text.idx"));
+    idx_from_binary.load("indexroundtrip.binary.idx");
+    idx_from_text.load("indexroundtrip.text.idx");
+    EXPECT_EQ(idx, idx_from_binary);
+    EXPECT_EQ(idx_from_text, idx_from_binary);
+    EXPECT_EQ(
+        idx_from_binary.minhash[min(kh1.first, kh1.second)]->at(1).knode_id, (uint32_t)1);
+}
+
+TEST(IndexTest, load_binaryTruncatedFileThrows)
+{
+    Index idx;
+    KmerHash hash;
+    prg::Path p;
+    p.initialize(Interval(0, 5));
+    pair<uint64_t, uint64_t> kh = hash.kmerhash("ACGTA", 5);
+    idx.add_record(min(kh.first, kh.second), 1, p, 0, 0);
+    idx.save("indextruncated.idx");
+    fs::resize_file("indextruncated.idx", fs::file_size("indextruncated.idx") - 8);
+
+    Index truncated;
+    EXPECT_THROW(truncated.load("indextruncated.idx"), std::runtime_error);
+}
+
+TEST(IndexTest, mask_frequent_minimizers_maxRecords)
+{
+    Index idx;
+    KmerHash hash;
+    prg::Path p;
+    p.initialize(Interval(0, 5));
+    pair<uint64_t, uint64_t> kh1 = hash.kmerhash("ACGTA", 5);
+    pair<uint64_t, uint64_t> kh2 = hash.kmerhash("ACTGA", 5);
+    const uint64_t key1 = min(kh1.first, kh1.second);
+    const uint64_t key2 = min(kh2.first, kh2.second);
+    for (uint32_t prg_id = 0; prg_id < 3; ++prg_id) {
+        idx.add_record(key1, prg_id, p, 0, 0);
+    }
+    idx.add_record(key2, 0, p, 0, 0);
+
+    EXPECT_EQ(idx.mask_frequent_minimizers(0, 0), (uint64_t)0);
+    EXPECT_EQ(idx.mask_frequent_minimizers(3, 0), (uint64_t)0);
+    EXPECT_EQ(idx.mask_frequent_minimizers(2, 0), (uint64_t)1);
+    EXPECT_EQ(idx.masked_minimizers, unordered_set<uint64_t> { key1 });
+    // records of masked minimizers are kept
+    EXPECT_EQ(idx.minhash[key1]->size(), (size_t)3);
+}
+
+TEST(IndexTest, mask_frequent_minimizers_topFraction)
+{
+    Index idx;
+    prg::Path p;
+    p.initialize(Interval(0, 5));
+    // minimizer i has i + 1 records
+    for (uint64_t key = 0; key < 100; ++key) {
+        for (uint32_t prg_id = 0; prg_id <= key; ++prg_id) {
+            idx.add_record(key, prg_id, p, 0, 0);
+        }
+    }
+
+    EXPECT_EQ(idx.mask_frequent_minimizers(0, 0.05), (uint64_t)5);
+    for (uint64_t key = 95; key < 100; ++key) {
+        EXPECT_EQ(idx.masked_minimizers.count(key), (size_t)1);
+    }
+    EXPECT_EQ(idx.masked_minimizers.count(94), (size_t)0);
+}
+
+TEST(IndexTest, save_binaryStoresMaskedMinimizers)
+{
+    Index idx, idx_from_file;
+    prg::Path p;
+    p.initialize(Interval(0, 5));
+    idx.add_record(1, 0, p, 0, 0);
+    idx.add_record(1, 1, p, 0, 0);
+    idx.add_record(2, 0, p, 0, 0);
+    idx.mask_frequent_minimizers(1, 0);
+    idx.save("indexmasked.idx");
+
+    idx_from_file.load("indexmasked.idx");
+    EXPECT_EQ(idx_from_file.masked_minimizers, unordered_set<uint64_t> { 1 });
+    EXPECT_EQ(idx_from_file, idx);
+}
+
 TEST(IndexTest, equals)
 {
     Index idx1, idx2;
@@ -149,27 +310,70 @@ TEST(IndexTest, equals_fails)
     EXPECT_NE(idx2, idx1);
 }
 
+TEST(IndexTest, index_prgs_overBudget_returnsPRGIds)
+{
+    const uint32_t w = 1, k = 3;
+    std::vector<std::shared_ptr<LocalPRG>> prgs;
+    read_prg_file(prgs, TEST_CASE_DIR + "prg0123.fa", 5);
+    auto index = std::make_shared<Index>();
+    EXPECT_TRUE(index_prgs(prgs, index, w, k).empty());
+
+    // only the nested PRG explores more than 3 k-mer paths
+    index->clear();
+    const auto over_budget = index_prgs(prgs, index, w, k, 2, 3);
+    ASSERT_EQ(over_budget.size(), (size_t)1);
+    EXPECT_EQ(prgs[over_budget[0] - 5]->name, "prg3");
+}
+
+TEST(IndexTest, index_prgs_sameIndexWithAnyNumberOfThreads)
+{
+    const uint32_t w = 1, k = 3;
+    std::vector<std::shared_ptr<LocalPRG>> prgs;
+    read_prg_file(prgs, TEST_CASE_DIR + "prg0123.fa");
+    auto index = std::make_shared<Index>();
+    index_prgs(prgs, index, w, k);
+    index->save("index_test_1_thread.idx");
+
+    // the PRGs are sketched in another order, and by several threads
+    std::vector<std::shared_ptr<LocalPRG>> other_prgs;
+    read_prg_file(other_prgs, TEST_CASE_DIR + "prg0123.fa");
+    auto other_index = std::make_shared<Index>();
+    index_prgs(other_prgs, other_index, w, k, 3);
+    other_index->save("index_test_3_threads.idx");
+
+    EXPECT_EQ(*index, *other_index);
+    for (uint32_t i = 0; i < prgs.size(); ++i) {
+        EXPECT_EQ(prgs[i]->kmer_prg, other_prgs[i]->kmer_prg);
+    }
+    std::ifstream file("index_test_1_thread.idx", std::ios::binary),
+        other_file("index_test_3_threads.idx", std::ios::binary);
+    const std::string bytes((std::istreambuf_iterator<char>(file)),
+        std::istreambuf_iterator<char>());
+    const std::string other_bytes((std::istreambuf_iterator<char>(other_file)),
+        std::istreambuf_iterator<char>());
+    EXPECT_EQ(bytes, other_bytes);
+}
+
 TEST(IndexTest, merging_indexes)
 {
     uint32_t w = 2, k = 3;
     std::vector<std::shared_ptr<LocalPRG>> prgs;
     auto index = std::make_shared<Index>();
-    auto outdir = TEST_CASE_DIR + "kgs/";
 
     read_prg_file(prgs, TEST_CASE_DIR + "prg1.fa", 1);
-    index_prgs(prgs, index, w, k, outdir);
+    index_prgs(prgs, index, w, k);
     index->save(TEST_CASE_DIR + "prg1.fa.idx");
 
     prgs.clear();
     index->clear();
     read_prg_file(prgs, TEST_CASE_DIR + "prg2.fa", 2);
-    index_prgs(prgs, index, w, k, outdir);
+    index_prgs(prgs, index, w, k);
     index->save(TEST_CASE_DIR + "prg2.fa.idx");
 
     prgs.clear();
     index->clear();
     read_prg_file(prgs, TEST_CASE_DIR + "prg3.fa", 3);
-    index_prgs(prgs, index, w, k, outdir);
+    index_prgs(prgs, index, w, k);
     index->save(TEST_CASE_DIR + "prg3.fa.idx");
 
     // merge
@@ -182,5 +386,232 @@ TEST(IndexTest, merging_indexes)
     prgs.clear();
     auto index_all = std::make_shared<Index>();
     read_prg_file(prgs, TEST_CASE_DIR + "prg0123.fa");
-    index_prgs(prgs, index_all, w, k, outdir);
+    index_prgs(prgs, index_all, w, k);
+}
+
+TEST(IndexTest, merge_index_files_equalsIndexLoadingAllFiles)
+{
+    uint32_t w = 2, k = 3;
+    std::vector<std::shared_ptr<LocalPRG>> prgs;
+    auto index = std::make_shared<Index>();
+    Index index_loaded;
+    std::vector<fs::path> indexfiles;
+
+    // in a different order than their PRG ids
+    for (const auto& prg_number : { 2, 3, 1 }) {
+        const auto name { "prg" + std::to_string(prg_number) };
+        prgs.clear();
+        index->clear();
+        read_prg_file(prgs, TEST_CASE_DIR + name + ".fa", prg_number);
+        index_prgs(prgs, index, w, k);
+        indexfiles.push_back("merge_" + name + ".idx");
+        index->save(indexfiles.back());
+        index_loaded.load(indexfiles.back());
+    }
+
+    merge_index_files(indexfiles, "merged.idx");
+
+    MappedIndexFile file("merged.idx");
+    EXPECT_EQ(file.header().w, w);
+    EXPECT_EQ(file.header().k, k);
+    EXPECT_EQ(file.header().prg_id_offset, (uint32_t)1);
+    EXPECT_EQ(file.header().num_prgs, (uint32_t)3);
+    EXPECT_EQ(file.header().num_keys, index_loaded.minhash.size());
+
+    Index index_merged;
+    index_merged.load("merged.idx");
+    EXPECT_EQ(index_merged, index_loaded);
+
+    // the keys were hashed while merging
+    FrozenIndex frozen_index;
+    frozen_index.load("merged.idx");
+    for (const auto& entry : index_loaded.minhash) {
+        EXPECT_EQ(frozen_index.find(entry.first).size(), entry.second->size());
+    }
+}
+
+TEST(IndexTest, merge_index_files_differentKThrows)
+{
+    Index idx;
+    KmerHash hash;
+    prg::Path p;
+    p.initialize(Interval(0, 5));
+    pair<uint64_t, uint64_t> kh = hash.kmerhash("ACGTA", 5);
+    idx.add_record(min(kh.first, kh.second), 0, p, 0, 0);
+    idx.add_prg_id_range(0, 1);
+    idx.save("merge_k5", 1, 5);
+
+    idx.clear();
+    kh = hash.kmerhash("ACGTAC", 6);
+    idx.add_record(min(kh.first, kh.second), 1, p, 0, 0);
+    idx.add_prg_id_range(1, 1);
+    idx.save("merge_k6", 1, 6);
+
+    EXPECT_THROW(merge_index_files({ "merge_k5.k5.w1.idx", "merge_k6.k6.w1.idx" },
+                     "merged_k.idx"),
+        std::runtime_error);
+}
+
+TEST(IndexTest, merge_index_files_overlappingPrgIdsThrows)
+{
+    Index idx;
+    KmerHash hash;
+    prg::Path p;
+    p.initialize(Interval(0, 5));
+    pair<uint64_t, uint64_t> kh = hash.kmerhash("ACGTA", 5);
+    idx.add_record(min(kh.first, kh.second), 0, p, 0, 0);
+    idx.add_prg_id_range(0, 2);
+    idx.save("merge_first", 1, 5);
+
+    idx.clear();
+    idx.add_record(min(kh.first, kh.second), 1, p, 0, 0);
+    idx.add_prg_id_range(1, 2);
+    idx.save("merge_second", 1, 5);
+
+    EXPECT_THROW(merge_index_files({ "merge_first.k5.w1.idx", "merge_second.k5.w1.idx" },
+                     "merged_overlapping.idx"),
+        std::runtime_error);
+}
+
+TEST(IndexTest, merge_index_files_masksMergedNumbersOfRecords)
+{
+    prg::Path p, other_p;
+    p.initialize(Interval(0, 5));
+    other_p.initialize(Interval(5, 10));
+    // key 1 has 2 records in each index, key i > 1 has 1 record in one of them
+    Index idx;
+    for (uint32_t prg_id = 0; prg_id < 4; ++prg_id) {
+        idx.clear();
+        idx.add_record(1, prg_id, p, 0, 0);
+        idx.add_record(1, prg_id, other_p, 1, 0);
+        idx.add_record(2 + prg_id, prg_id, p, 0, 0);
+        idx.add_prg_id_range(prg_id, 1);
+        ASSERT_EQ(idx.minhash[1]->size(), (size_t)2);
+        EXPECT_EQ(idx.mask_frequent_minimizers(3, 0), (uint64_t)0);
+        idx.save("merge_masked" + std::to_string(prg_id) + ".idx");
+    }
+
+    merge_index_files({ "merge_masked0.idx", "merge_masked1.idx", "merge_masked2.idx",
+                          "merge_masked3.idx" },
+        "merged_masked.idx");
+
+    FrozenIndex frozen_index;
+    frozen_index.load("merged_masked.idx");
+    EXPECT_EQ(frozen_index.get_mask_above(), (uint32_t)3);
+    EXPECT_EQ(frozen_index.get_mask_top_fraction(), 0.0);
+    EXPECT_EQ(frozen_index.number_of_masked_keys(), (uint64_t)1);
+    EXPECT_TRUE(frozen_index.find(1).empty());
+    EXPECT_EQ(frozen_index.find(2).size(), (size_t)1);
+}
+
+TEST(IndexTest, merge_index_files_keysMaskedWithoutCutoffStayMasked)
+{
+    prg::Path p;
+    p.initialize(Interval(0, 5));
+    Index idx;
+    idx.add_record(1, 0, p, 0, 0);
+    idx.add_record(2, 0, p, 0, 0);
+    idx.add_prg_id_range(0, 1);
+    idx.masked_minimizers.insert(1);
+    idx.save("merge_masked_by_hand.idx");
+    idx.clear();
+    idx.add_record(1, 1, p, 0, 0);
+    idx.add_record(2, 1, p, 0, 0);
+    idx.add_prg_id_range(1, 1);
+    idx.mask_frequent_minimizers(1, 0);
+    idx.save("merge_masked_above_1.idx");
+
+    merge_index_files({ "merge_masked_by_hand.idx", "merge_masked_above_1.idx" },
+        "merged_masked_by_hand.idx");
+
+    // both keys have 2 records once merged, but only key 1 was masked by hand
+    Index index_merged;
+    index_merged.load("merged_masked_by_hand.idx");
+    EXPECT_EQ(index_merged.masked_minimizers, unordered_set<uint64_t>({ 1, 2 }));
+
+    idx.clear();
+    idx.add_record(2, 2, p, 0, 0);
+    idx.add_prg_id_range(2, 1);
+    idx.save("merge_unmasked.idx");
+    merge_index_files({ "merge_masked_by_hand.idx", "merge_unmasked.idx" },
+        "merged_masked_by_hand.idx");
+    index_merged.clear();
+    index_merged.load("merged_masked_by_hand.idx");
+    EXPECT_EQ(index_merged.masked_minimizers, unordered_set<uint64_t>({ 1 }));
+}
+
+TEST(IndexTest, append_to_equalsIndexOfAllPrgs)
+{
+    uint32_t w = 2, k = 3;
+    std::vector<std::shared_ptr<LocalPRG>> prgs;
+    read_prg_file(prgs, TEST_CASE_DIR + "prg0123.fa");
+    auto index_all = std::make_shared<Index>();
+    index_prgs(prgs, index_all, w, k);
+
+    // index the first PRGs, then append the last one
+    prgs.resize(2);
+    auto index = std::make_shared<Index>();
+    index_prgs(prgs, index, w, k);
+    index->save("append.idx");
+    prgs.clear();
+    read_prg_file(prgs, TEST_CASE_DIR + "prg0123.fa", 0, 2);
+    auto appended_index = std::make_shared<Index>();
+    index_prgs(prgs, appended_index, w, k);
+    appended_index->append_to("append.idx");
+
+    MappedIndexFile file("append.idx");
+    EXPECT_EQ(file.header().prg_id_offset, (uint32_t)0);
+    EXPECT_EQ(file.header().num_prgs, (uint32_t)3);
+    Index index_from_file;
+    index_from_file.load("append.idx");
+    EXPECT_EQ(index_from_file, *index_all);
+
+    // the same PRGs can't be appended twice
+    EXPECT_THROW(appended_index->append_to("append.idx"), std::runtime_error);
+}
+
+TEST(IndexTest, append_to_masksMinimizersOfAllPrgs)
+{
+    prg::Path p;
+    p.initialize(Interval(0, 5));
+    Index idx;
+    idx.add_record(1, 0, p, 0, 0);
+    idx.add_record(2, 0, p, 0, 0);
+    idx.add_prg_id_range(0, 1);
+    EXPECT_EQ(idx.mask_frequent_minimizers(1, 0), (uint64_t)0);
+    idx.save("append_masked.idx");
+
+    // key 1 has a record in each
+    Index appended_idx;
+    appended_idx.add_record(1, 1, p, 0, 0);
+    appended_idx.add_record(3, 1, p, 0, 0);
+    appended_idx.add_prg_id_range(1, 1);
+    EXPECT_EQ(appended_idx.mask_frequent_minimizers(1, 0), (uint64_t)0);
+    appended_idx.append_to("append_masked.idx");
+
+    Index index_from_file;
+    index_from_file.load("append_masked.idx");
+    EXPECT_EQ(index_from_file.masked_minimizers, unordered_set<uint64_t> { 1 });
+    EXPECT_EQ(index_from_file.mask_above, (uint32_t)1);
+}
+
+TEST(IndexTest, pandora_index_emptyPrgFileGivesEmptyIndex)
+{
+    fs::create_directories("index_empty");
+    std::ofstream("index_empty/empty.fa").close();
+    IndexOptions opt;
+    opt.prgfile = "index_empty/empty.fa";
+    opt.window_size = 1;
+    opt.kmer_size = 3;
+    EXPECT_EQ(pandora_index(opt), 0);
+    LocalPRG::do_path_memoization_in_nodes_along_path_method = false;
+
+    MappedIndexFile file("index_empty/empty.fa.k3.w1.idx");
+    EXPECT_EQ(file.header().num_prgs, (uint32_t)0);
+    Index index;
+    index.load("index_empty/empty.fa.k3.w1.idx");
+    EXPECT_TRUE(index.minhash.empty());
+    const KmerGraphArchive archive(
+        kmer_graph_archive_file(opt.prgfile, opt.window_size, opt.kmer_size));
+    EXPECT_FALSE(archive.contains(0));
 }
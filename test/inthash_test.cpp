@@ -8,6 +8,7 @@
 #include <cmath>
 #include <algorithm>
 #include <stdint.h>
+#include <random>
 #include <iostream>
 
 using namespace std;
@@ -74,3 +75,85 @@ TEST(InthashTest, check1to1)
         }
     }
 }
+
+TEST(InthashTest, hash_kmers_everyKernelSameAsHash64OfEachKmer)
+{
+    std::mt19937 generator(0);
+    const string letters = "ACGTacgt";
+    for (uint32_t test = 0; test < 300; ++test) {
+        const uint32_t k = 1 + generator() % 31;
+        string seq;
+        const uint32_t length = generator() % 150;
+        for (uint32_t i = 0; i < length; ++i) {
+            seq += letters[generator() % letters.size()];
+        }
+        uint32_t number_letters = length;
+        if (length > 0 and generator() % 3 == 0) {
+            number_letters = generator() % length;
+            seq[number_letters] = "NnRX-"[generator() % 5];
+        }
+
+        // each k-mer encoded and hashed on its own
+        const uint64_t mask = (1ULL << 2 * k) - 1;
+        vector<uint64_t> expected_forward, expected_reverse;
+        for (uint32_t i = 0; i + k <= number_letters; ++i) {
+            uint64_t forward_kmer = 0, reverse_kmer = 0;
+            for (uint32_t j = 0; j < k; ++j) {
+                forward_kmer = forward_kmer << 2 | nt4(seq[i + j]);
+                reverse_kmer = reverse_kmer << 2 | (3 - nt4(seq[i + k - 1 - j]));
+            }
+            expected_forward.push_back(hash64(forward_kmer, mask));
+            expected_reverse.push_back(hash64(reverse_kmer, mask));
+        }
+
+        for (const auto& kernel : { KmerHashKernel::Scalar, KmerHashKernel::SSE2,
+                 KmerHashKernel::AVX2 }) {
+            if (!kmer_hash_kernel_supported(kernel)) {
+                continue;
+            }
+            vector<uint64_t> forward(length + 1), reverse(length + 1);
+            EXPECT_EQ(hash_kmers(seq.data(), length, k, forward.data(), reverse.data(),
+                          kernel),
+                number_letters);
+            forward.resize(expected_forward.size());
+            reverse.resize(expected_reverse.size());
+            EXPECT_EQ(forward, expected_forward) << seq << " k=" << k;
+            EXPECT_EQ(reverse, expected_reverse) << seq << " k=" << k;
+        }
+    }
+}
+
+TEST(InthashTest, kmerhash_ambiguousBasesSkipped)
+{
+    // ACGT in the lowest 8 bits, and its reverse complement ACGT in the highest 8
+    KmerHash hash;
+    const uint64_t mask = (1ULL << 10) - 1;
+    EXPECT_EQ(hash.kmerhash("ANCGT", 5),
+        make_pair(hash64(0x1B, mask), hash64(0x6C, mask)));
+    EXPECT_EQ(hash.kmerhash("ACGTA", 5).first, hash64(0x6C, mask));
+}
+
+TEST(InthashTest, hash_every_kmer_sameAsKmerHash)
+{
+    std::mt19937 generator(0);
+    const string letters = "ACGTacgtN";
+    KmerHash hash;
+    vector<uint64_t> forward, reverse;
+    for (uint32_t test = 0; test < 300; ++test) {
+        const uint32_t k = 1 + generator() % 15;
+        string seq;
+        const uint32_t length = generator() % 100;
+        for (uint32_t i = 0; i < length; ++i) {
+            seq += letters[generator() % letters.size()];
+        }
+
+        hash_every_kmer(seq, k, forward, reverse);
+        ASSERT_EQ(forward.size(), length < k ? 0 : length + 1 - k);
+        ASSERT_EQ(reverse.size(), forward.size());
+        for (uint32_t i = 0; i < forward.size(); ++i) {
+            const auto kh = hash.kmerhash(seq.substr(i, k), k);
+            EXPECT_EQ(forward[i], kh.first) << seq << " k=" << k << " i=" << i;
+            EXPECT_EQ(reverse[i], kh.second) << seq << " k=" << k << " i=" << i;
+        }
+    }
+}
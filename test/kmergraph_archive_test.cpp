@@ -0,0 +1,137 @@
+#include "gtest/gtest.h"
+#include "kmergraph_archive.h"
+#include "kmergraph.h"
+#include "localPRG.h"
+#include "index.h"
+#include "utils.h"
+#include <vector>
+#include <stdint.h>
+
+const std::string TEST_CASE_DIR = "../../test/test_cases/";
+
+namespace {
+// the out node ids of each node, in order
+std::vector<std::vector<uint32_t>> out_node_ids(const KmerGraph& kmer_graph)
+{
+    std::vector<std::vector<uint32_t>> ids;
+    for (const auto& node : kmer_graph.nodes) {
+        ids.emplace_back();
+        for (const auto& out_node : node->out_nodes) {
+            ids.back().push_back(out_node.lock()->id);
+        }
+    }
+    return ids;
+}
+}
+
+TEST(KmerGraphArchiveTest, kmer_graph_archive_file)
+{
+    EXPECT_EQ(kmer_graph_archive_file("dir/prgs.fa", 14, 15),
+        fs::path("dir/kmer_prgs/prgs.fa.k15.w14.kga"));
+    EXPECT_EQ(kmer_graph_archive_file("dir/prgs.fa", 14, 15, 750),
+        fs::path("dir/kmer_prgs/prgs.fa.750.k15.w14.kga"));
+}
+
+TEST(KmerGraphArchiveTest, load_sameGraphsAsFromGfa)
+{
+    const uint32_t w = 1, k = 3;
+    std::vector<std::shared_ptr<LocalPRG>> prgs;
+    read_prg_file(prgs, TEST_CASE_DIR + "prg0123.fa", 5);
+    auto index = std::make_shared<Index>();
+    index_prgs(prgs, index, w, k);
+    save_kmer_graph_archive("kmergraph_archive_test.kga", prgs, w, k);
+
+    const KmerGraphArchive archive("kmergraph_archive_test.kga");
+    EXPECT_EQ(archive.header().prg_id_offset, (uint32_t)5);
+    EXPECT_EQ(archive.header().num_prgs, prgs.size());
+    EXPECT_FALSE(archive.contains(4));
+    EXPECT_FALSE(archive.contains(5 + prgs.size()));
+    for (const auto& prg : prgs) {
+        ASSERT_TRUE(archive.contains(prg->id));
+        EXPECT_EQ(archive.prg_name(prg->id), prg->name);
+
+        KmerGraph from_archive, from_gfa;
+        archive.load(prg->id, from_archive);
+        prg->kmer_prg.save("kmergraph_archive_test.gfa");
+        from_gfa.load("kmergraph_archive_test.gfa");
+        EXPECT_EQ(from_archive, prg->kmer_prg);
+        EXPECT_EQ(from_archive, from_gfa);
+        EXPECT_EQ(out_node_ids(from_archive), out_node_ids(from_gfa));
+        EXPECT_EQ(from_archive.min_path_length(), from_gfa.min_path_length());
+    }
+}
+
+TEST(KmerGraphArchiveTest, load_PRG_kmergraphs_fromArchives)
+{
+    const uint32_t w = 1, k = 3;
+    const fs::path prgfile { "kmergraph_archive_test/prgs.fa" };
+    fs::remove_all(prgfile.parent_path());
+    fs::create_directories(prgfile.parent_path() / "kmer_prgs");
+
+    // the first PRGs in the archive of the PRG file, the others appended to it
+    std::vector<std::shared_ptr<LocalPRG>> prgs;
+    read_prg_file(prgs, TEST_CASE_DIR + "prg0123.fa");
+    auto index = std::make_shared<Index>();
+    index_prgs(prgs, index, w, k);
+    const std::vector<std::shared_ptr<LocalPRG>> first_prgs(
+        prgs.begin(), prgs.begin() + 2);
+    const std::vector<std::shared_ptr<LocalPRG>> appended_prgs(
+        prgs.begin() + 2, prgs.end());
+    save_kmer_graph_archive(kmer_graph_archive_file(prgfile, w, k), first_prgs, w, k);
+    save_kmer_graph_archive(
+        kmer_graph_archive_file(prgfile, w, k, 2), appended_prgs, w, k);
+
+    std::vector<std::shared_ptr<LocalPRG>> loaded_prgs;
+    read_prg_file(loaded_prgs, TEST_CASE_DIR + "prg0123.fa");
+    load_PRG_kmergraphs(loaded_prgs, w, k, prgfile, 2);
+    ASSERT_EQ(loaded_prgs.size(), prgs.size());
+    for (uint32_t i = 0; i < prgs.size(); ++i) {
+        EXPECT_EQ(loaded_prgs[i]->kmer_prg, prgs[i]->kmer_prg);
+    }
+}
+
+TEST(KmerGraphArchiveTest, check_archived_prg_names)
+{
+    const uint32_t w = 1, k = 3;
+    const fs::path prgfile { "kmergraph_archive_test_names/prgs.fa" };
+    fs::remove_all(prgfile.parent_path());
+    fs::create_directories(prgfile.parent_path() / "kmer_prgs");
+
+    std::vector<std::shared_ptr<LocalPRG>> prgs;
+    read_prg_file(prgs, TEST_CASE_DIR + "prg0123.fa");
+    ASSERT_EQ(prgs.size(), (size_t)3);
+    const std::vector<std::shared_ptr<LocalPRG>> first_prgs(
+        prgs.begin(), prgs.begin() + 1);
+    const std::vector<std::shared_ptr<LocalPRG>> appended_prgs(
+        prgs.begin() + 1, prgs.begin() + 2);
+    save_kmer_graph_archive(kmer_graph_archive_file(prgfile, w, k), first_prgs, w, k);
+    save_kmer_graph_archive(
+        kmer_graph_archive_file(prgfile, w, k, 1), appended_prgs, w, k);
+
+    // the PRGs skipped when appending the last one
+    std::vector<std::shared_ptr<LocalPRG>> last_prgs;
+    std::vector<std::string> names;
+    read_prg_file(last_prgs, TEST_CASE_DIR + "prg0123.fa", 0, 2, false, 1, &names);
+    ASSERT_EQ(last_prgs.size(), (size_t)1);
+    ASSERT_EQ(names.size(), (size_t)2);
+    EXPECT_NO_THROW(check_archived_prg_names(prgfile, w, k, 0, names));
+
+    // reordered
+    std::swap(names[0], names[1]);
+    EXPECT_THROW(check_archived_prg_names(prgfile, w, k, 0, names), std::runtime_error);
+    std::swap(names[0], names[1]);
+    // inserted
+    names.insert(names.begin() + 1, "inserted");
+    EXPECT_THROW(check_archived_prg_names(prgfile, w, k, 0, names), std::runtime_error);
+    names.erase(names.begin() + 1);
+    // not archived
+    names.push_back(prgs[2]->name);
+    EXPECT_THROW(check_archived_prg_names(prgfile, w, k, 0, names), std::runtime_error);
+}
+
+TEST(KmerGraphArchiveTest, notAnArchive_throws)
+{
+    EXPECT_THROW(KmerGraphArchive(TEST_CASE_DIR + "prg0123.fa"), std::runtime_error);
+    EXPECT_THROW(KmerGraphArchive("kmergraph_archive_test_missing.kga"),
+        std::runtime_error);
+}
@@ -517,6 +517,37 @@ TEST(LocalPRGTest, build_graph)
     EXPECT_EQ(lg3, l3.prg);
 }
 
+TEST(LocalPRGTest, materialize_lazyPrgBuildsGraphsOnce)
+{
+    const std::string seq { "A 5 G 7 C 8 T 7  6 G 5 T" };
+    auto eager = std::make_shared<LocalPRG>(3, "nested varsite", seq);
+    auto index = std::make_shared<Index>();
+    eager->minimizer_sketch(index, 1, 3);
+
+    LocalPRG lazy(3, "nested varsite", seq, true);
+    EXPECT_FALSE(lazy.is_materialized());
+    EXPECT_TRUE(lazy.prg.nodes.empty());
+    uint32_t number_of_loads = 0;
+    lazy.set_kmer_graph_loader([&](KmerGraph& kmer_graph) {
+        ++number_of_loads;
+        kmer_graph = eager->kmer_prg;
+    });
+
+#pragma omp parallel for num_threads(4)
+    for (uint32_t i = 0; i < 100; ++i) {
+        lazy.materialize();
+    }
+    EXPECT_TRUE(lazy.is_materialized());
+    EXPECT_EQ(number_of_loads, (uint32_t)1);
+    EXPECT_EQ(lazy.prg, eager->prg);
+    EXPECT_EQ(lazy.kmer_prg, eager->kmer_prg);
+    EXPECT_EQ(lazy.string_along_path(lazy.prg.top_path()),
+        eager->string_along_path(eager->prg.top_path()));
+
+    // eager PRGs are materialized from the start
+    EXPECT_TRUE(eager->is_materialized());
+}
+
 TEST(LocalPRGTest, shift)
 {
     LocalPRG l1(1, "simple", "AGCT");
@@ -897,6 +928,49 @@ TEST(LocalPRGTest, minimizer_sketch_SameAsSeqw15)
     }
 }
 
+TEST(LocalPRGTest, sketch_cost)
+{
+    LocalPRG linear(0, "linear", "ACGTACGTACGT");
+    LocalPRG one_site(1, "one site", "A 5 G 6 C 5 T");
+    LocalPRG nested(2, "nested", "A 5 G 7 C 8 T 7  6 G 5 T");
+    EXPECT_EQ(linear.site_nesting_depth, (uint32_t)0);
+    EXPECT_EQ(one_site.site_nesting_depth, (uint32_t)1);
+    EXPECT_EQ(nested.site_nesting_depth, (uint32_t)2);
+
+    EXPECT_EQ(linear.sketch_cost(), (uint64_t)12 + 1);
+    EXPECT_EQ(one_site.sketch_cost(), (uint64_t)13 + 4 * 2);
+    EXPECT_EQ(nested.sketch_cost(), (uint64_t)24 + 7 * 4);
+}
+
+TEST(LocalPRGTest, minimizer_sketch_overBudget_sketchesRepresentativePaths)
+{
+    const uint32_t w = 2, k = 3;
+    LocalPRG linear(0, "linear", "ATGGCAATCCGAATCTTCGCGATACTTTTCTCCATTT");
+    std::vector<SketchedMinimizer> minimizers;
+    EXPECT_TRUE(linear.minimizer_sketch(minimizers, w, k));
+    const KmerGraph full_sketch = linear.kmer_prg;
+    const auto num_minimizers = minimizers.size();
+
+    // a linear PRG is its only representative path, so the sketch is the same
+    EXPECT_FALSE(linear.minimizer_sketch(minimizers, w, k, -1, 1));
+    EXPECT_EQ(linear.kmer_prg, full_sketch);
+    EXPECT_EQ(minimizers.size(), 2 * num_minimizers);
+
+    // otherwise the sketch only has minimizers along the representative paths, and
+    // the minimizers of the abandoned sketch are dropped
+    LocalPRG nested(1, "nested", "TC 5 ACTC 7 TAGTCA 8 TTGTGA 7  6 AACTAG 5 AGCTTAC");
+    EXPECT_TRUE(nested.minimizer_sketch(minimizers, w, k));
+    KmerGraph nested_full_sketch = nested.kmer_prg;
+    minimizers.resize(2 * num_minimizers);
+    EXPECT_FALSE(nested.minimizer_sketch(minimizers, w, k, -1, 10));
+    EXPECT_EQ(minimizers.size(), 2 * num_minimizers + nested.kmer_prg.nodes.size() - 2);
+    for (const auto& node : nested.kmer_prg.nodes) {
+        EXPECT_NE(nested_full_sketch.sorted_nodes.find(node),
+            nested_full_sketch.sorted_nodes.end());
+    }
+    nested.kmer_prg.check();
+}
+
 TEST(LocalPRGTest, localnode_path_from_kmernode_path)
 {
     LocalPRG l3(3, "nested varsite", "A 5 G 7 C 8 T 7  6 G 5 T");
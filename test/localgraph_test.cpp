@@ -296,6 +296,45 @@ TEST(LocalGraphTest, walk)
     EXPECT_EQ(equal, true);
 }
 
+TEST(LocalGraphTest, walk_streamed)
+{
+    LocalGraph lg2;
+    lg2.add_node(0, "A", Interval(0, 1));
+    lg2.add_node(1, "GC", Interval(4, 6));
+    lg2.add_node(2, "G", Interval(7, 8));
+    lg2.add_node(3, "T", Interval(13, 14));
+    lg2.add_edge(0, 1);
+    lg2.add_edge(0, 2);
+    lg2.add_edge(1, 3);
+    lg2.add_edge(2, 3);
+
+    // the same walks, in the same order, as the ones returned
+    for (uint32_t len = 1; len != 6; ++len) {
+        vector<prg::Path> streamed;
+        WalkMemo memo;
+        EXPECT_TRUE(lg2.walk(0, 0, len,
+            [&streamed](const prg::Path& path) {
+                streamed.push_back(path);
+                return true;
+            },
+            memo));
+        const vector<PathPtr> returned = lg2.walk(0, 0, len);
+        ASSERT_EQ(streamed.size(), returned.size());
+        for (uint32_t i = 0; i != returned.size(); ++i) {
+            EXPECT_EQ(streamed[i], *returned[i]);
+        }
+        EXPECT_EQ(lg2.has_walk(0, 0, len, memo), !returned.empty());
+    }
+
+    // and stops when asked to
+    uint32_t number_walks = 0;
+    EXPECT_FALSE(lg2.walk(0, 0, 3, [&number_walks](const prg::Path&) {
+        ++number_walks;
+        return false;
+    }));
+    EXPECT_EQ(number_walks, (uint32_t)1);
+}
+
 TEST(LocalGraphTest, walk_back)
 {
     LocalGraph lg2;
@@ -398,6 +437,32 @@ TEST(LocalGraphTest, walk_back)
     EXPECT_EQ(equal, true);
 }
 
+TEST(LocalGraphTest, walk_back_streamed)
+{
+    LocalGraph lg2;
+    lg2.add_node(0, "A", Interval(0, 1));
+    lg2.add_node(1, "GC", Interval(4, 6));
+    lg2.add_node(2, "G", Interval(7, 8));
+    lg2.add_node(3, "T", Interval(13, 14));
+    lg2.add_edge(0, 1);
+    lg2.add_edge(0, 2);
+    lg2.add_edge(1, 3);
+    lg2.add_edge(2, 3);
+
+    for (uint32_t len = 1; len != 6; ++len) {
+        vector<prg::Path> streamed;
+        EXPECT_TRUE(lg2.walk_back(3, 14, len, [&streamed](const prg::Path& path) {
+            streamed.push_back(path);
+            return true;
+        }));
+        const vector<PathPtr> returned = lg2.walk_back(3, 14, len);
+        ASSERT_EQ(streamed.size(), returned.size());
+        for (uint32_t i = 0; i != returned.size(); ++i) {
+            EXPECT_EQ(streamed[i], *returned[i]);
+        }
+    }
+}
+
 TEST(LocalGraphTest, nodes_along_string)
 {
     LocalGraph lg2, read_lg2;
@@ -504,3 +569,17 @@ TEST(LocalGraphTest, bottom_path)
     v = lp3.prg.bottom_path();
     EXPECT_ITERABLE_EQ(vector<LocalNodePtr>, v_exp, v);
 }
+
+TEST(LocalGraphTest, representative_paths)
+{
+    LocalPRG lp3 = LocalPRG(3, "3", "T 5 G 7 C 8 T 7  6 G 5 TATG");
+    const vector<vector<LocalNodePtr>> paths_exp = { lp3.prg.top_path(),
+        { lp3.prg.nodes[0], lp3.prg.nodes[1], lp3.prg.nodes[3], lp3.prg.nodes[4],
+            lp3.prg.nodes[6] },
+        lp3.prg.bottom_path() };
+    EXPECT_EQ(lp3.prg.representative_paths(), paths_exp);
+
+    LocalPRG lp1 = LocalPRG(1, "1", "ACGT");
+    EXPECT_EQ(lp1.prg.representative_paths(),
+        vector<vector<LocalNodePtr>> { lp1.prg.top_path() });
+}
@@ -0,0 +1,68 @@
+#include "gtest/gtest.h"
+#include "membership_filter.h"
+#include "inthash.h"
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+namespace {
+MembershipFilter::KeyIterator iterate_over(const vector<uint64_t>& keys)
+{
+    return [&keys](const std::function<void(const uint64_t&)>& callback) {
+        for (const auto& key : keys) {
+            callback(key);
+        }
+    };
+}
+}
+
+TEST(MembershipFilterTest, noBlocks_everyKeyPasses)
+{
+    const MembershipFilter filter;
+    EXPECT_TRUE(filter.empty());
+    EXPECT_TRUE(filter.may_contain(0));
+    EXPECT_TRUE(filter.may_contain(42));
+}
+
+TEST(MembershipFilterTest, noKeys_noKeyPasses)
+{
+    const vector<uint64_t> keys;
+    const MembershipFilter filter(keys.size(), iterate_over(keys));
+    EXPECT_FALSE(filter.empty());
+    EXPECT_FALSE(filter.may_contain(0));
+    EXPECT_FALSE(filter.may_contain(42));
+}
+
+TEST(MembershipFilterTest, keysPassAndFewOtherKeysDo)
+{
+    const uint64_t mask = (1ull << 30) - 1;
+    vector<uint64_t> keys;
+    for (uint64_t i = 0; i < 10000; ++i) {
+        keys.push_back(hash64(2 * i, mask));
+    }
+    const MembershipFilter filter(keys.size(), iterate_over(keys));
+
+    for (const auto& key : keys) {
+        EXPECT_TRUE(filter.may_contain(key));
+    }
+    uint32_t false_positives = 0;
+    for (uint64_t i = 0; i < 10000; ++i) {
+        false_positives += filter.may_contain(hash64(2 * i + 1, mask));
+    }
+    EXPECT_LT(false_positives, (uint32_t)300);
+}
+
+TEST(MembershipFilterTest, fromWords_sameAsBuilt)
+{
+    vector<uint64_t> keys;
+    for (uint64_t i = 0; i < 1000; ++i) {
+        keys.push_back(i * 3);
+    }
+    const MembershipFilter built(keys.size(), iterate_over(keys));
+    const MembershipFilter view(built.get_words(), built.get_num_words());
+
+    for (uint64_t key = 0; key < 3000; ++key) {
+        EXPECT_EQ(view.may_contain(key), built.may_contain(key));
+    }
+}
@@ -0,0 +1,113 @@
+#include "gtest/gtest.h"
+#include "minihit_records.h"
+#include "minihit.h"
+#include "minimizer.h"
+#include "minirecord.h"
+#include "frozen_index.h"
+#include "index.h"
+#include "prg/path.h"
+#include "interval.h"
+#include <memory>
+#include <stdint.h>
+
+using namespace std;
+
+TEST(MinimizerHitRecordsTest, compactHit_twelveBytes)
+{
+    EXPECT_EQ(sizeof(CompactMinimizerHit), (size_t)12);
+}
+
+TEST(MinimizerHitRecordsTest, compactAndExpand_hitOfFrozenIndex)
+{
+    prg::Path p;
+    p.initialize(deque<Interval> { Interval(3, 5), Interval(9, 10) });
+    Index index;
+    index.add_record(7, 2, p, 5, 1);
+    index.add_record(8, 4, p, 6, 0);
+    auto frozen_index = make_shared<FrozenIndex>(index);
+    const auto& record = *frozen_index->find(8).begin();
+    const auto record_id = frozen_index->get_record_id(record);
+
+    Minimizer m(8, 1, 4, 1);
+    MinimizerHit hit(3, m, record.prg_id, frozen_index->get_path(record),
+        record.knode_id, record.strand != 0, record_id);
+    MinimizerHitRecords hit_records(frozen_index);
+    const auto compact_hit = hit_records.compact(hit);
+
+    EXPECT_EQ(compact_hit.record_id, record_id);
+    EXPECT_EQ(compact_hit.read_start_position, (uint32_t)1);
+    EXPECT_EQ(hit_records.get_prg_id(compact_hit), (uint32_t)4);
+    EXPECT_EQ(hit_records.number_of_added_records(), (uint64_t)0);
+    const auto expanded_hit = hit_records.expand(3, compact_hit);
+    EXPECT_EQ(expanded_hit, hit);
+    EXPECT_EQ(expanded_hit.get_kmer_node_id(), (uint32_t)6);
+    EXPECT_FALSE(expanded_hit.is_forward());
+    EXPECT_EQ(&expanded_hit.get_prg_path(), &frozen_index->get_path(record));
+}
+
+TEST(MinimizerHitRecordsTest, compactAndExpand_hitOfMiniRecordIsCopied)
+{
+    prg::Path p;
+    p.initialize(deque<Interval> { Interval(3, 5), Interval(9, 10) });
+    Minimizer m(8, 1, 4, 0);
+    MinimizerHitRecords hit_records;
+    uint32_t prg_id, knode_id;
+    CompactMinimizerHit compact_hit;
+    {
+        MiniRecord mr(4, p, 6, 0);
+        MinimizerHit hit(3, m, mr);
+        prg_id = hit.get_prg_id();
+        knode_id = hit.get_kmer_node_id();
+        compact_hit = hit_records.compact(hit);
+    }
+    EXPECT_EQ(hit_records.number_of_added_records(), (uint64_t)1);
+
+    // the record was copied
+    const auto expanded_hit = hit_records.expand(3, compact_hit);
+    EXPECT_EQ(expanded_hit.get_prg_id(), prg_id);
+    EXPECT_EQ(expanded_hit.get_kmer_node_id(), knode_id);
+    EXPECT_EQ(expanded_hit.get_prg_path(), p);
+    EXPECT_TRUE(expanded_hit.is_forward());
+    EXPECT_EQ(expanded_hit.get_record_id(), NO_RECORD_ID);
+
+    // and copied again by other records
+    MinimizerHitRecords other_hit_records;
+    other_hit_records.compact(hit_records.expand(0, compact_hit));
+    const auto other_compact_hit = other_hit_records.compact(expanded_hit);
+    EXPECT_EQ(other_hit_records.number_of_added_records(), (uint64_t)2);
+    EXPECT_EQ(other_hit_records.expand(3, other_compact_hit), expanded_hit);
+}
+
+TEST(MinimizerHitRecordsTest, lessAndEqual_orderAsExpandedHits)
+{
+    prg::Path p1, p2;
+    p1.initialize(Interval(3, 6));
+    p2.initialize(Interval(4, 7));
+    MinimizerHitRecords hit_records;
+    vector<MinimizerHit> hits;
+    vector<CompactMinimizerHit> compact_hits;
+    for (const auto& prg_id : vector<uint32_t> { 2, 1 }) {
+        for (const auto& strand : vector<bool> { false, true }) {
+            for (const auto& read_position : vector<uint32_t> { 5, 0 }) {
+                for (const auto* path : vector<const prg::Path*> { &p2, &p1 }) {
+                    Minimizer m(0, read_position, read_position + 3, 0);
+                    hits.emplace_back(0, m, prg_id, *path, 0, strand);
+                    compact_hits.push_back(hit_records.compact(hits.back()));
+                }
+            }
+        }
+    }
+    // a copy of a hit with a record of its own
+    hits.push_back(hits.front());
+    compact_hits.push_back(hit_records.compact(hits.back()));
+
+    for (size_t i = 0; i < hits.size(); ++i) {
+        for (size_t j = 0; j < hits.size(); ++j) {
+            EXPECT_EQ(hit_records.less(compact_hits[i], compact_hits[j]),
+                hits[i] < hits[j]);
+            EXPECT_EQ(hit_records.equal(compact_hits[i], compact_hits[j]),
+                hits[i] == hits[j]);
+        }
+        EXPECT_EQ(hit_records.is_forward(compact_hits[i]), hits[i].is_forward());
+    }
+}
@@ -85,13 +85,53 @@ TEST(MinimizerHitsTest, pComp)
     mhits.add_hit(1, m3, mr3);
     expected.push_back(MinimizerHit(1, m3, mr3));
 
+    const auto hits = mhits.cluster();
     uint32_t j(1);
-    for (set<MinimizerHitPtr, pComp>::iterator it = mhits.hits.begin();
-         it != --mhits.hits.end(); ++it) {
+    for (set<MinimizerHitPtr, pComp>::iterator it = hits.begin(); it != --hits.end();
+         ++it) {
         EXPECT_EQ(expected[j], **it);
         j++;
     }
-    EXPECT_EQ(expected[0], **(--mhits.hits.end()));
+    EXPECT_EQ(expected[0], **(--hits.end()));
+}
+
+TEST(MinimizerHitsTest, sort_sameOrderAsPComp)
+{
+    MinimizerHits mhits;
+    KmerHash hash;
+    pair<uint64_t, uint64_t> kh = hash.kmerhash("ACGTA", 5);
+    const vector<deque<Interval>> paths_intervals
+        = { { Interval(7, 8), Interval(10, 14) }, { Interval(6, 10), Interval(11, 12) },
+              { Interval(6, 10), Interval(12, 13) } };
+    vector<MiniRecord> records;
+    for (uint32_t prg_id = 0; prg_id < 300; prg_id += 100) {
+        for (const auto& intervals : paths_intervals) {
+            prg::Path p;
+            p.initialize(intervals);
+            records.emplace_back(prg_id, p, 0, prg_id % 2);
+        }
+    }
+
+    // hits of several reads, strands and positions against each record, in a scrambled
+    // order and some of them twice
+    for (uint32_t i = 0; i < 2000; ++i) {
+        const uint32_t read_id = (i * 7919) % 3;
+        const uint32_t position = (i * 104729) % 70000;
+        const Minimizer m(min(kh.first, kh.second), position, position + 5, i % 5 == 0);
+        mhits.add_hit(read_id, m, records[(i * 31) % records.size()]);
+    }
+    set<MinimizerHitPtr, pComp> expected;
+    for (const auto& hit : mhits.hits) {
+        expected.insert(make_shared<MinimizerHit>(hit));
+    }
+
+    mhits.sort();
+    ASSERT_EQ(mhits.hits.size(), expected.size());
+    auto it = expected.begin();
+    for (const auto& hit : mhits.hits) {
+        EXPECT_EQ(MinimizerHit(hit), **it);
+        ++it;
+    }
 }
 
 TEST(MinimizerHitsTest, pComp_path)
@@ -131,8 +171,9 @@ TEST(MinimizerHitsTest, pComp_path)
     mhits.add_hit(1, m4, mr4);
     expected.push_front(MinimizerHit(1, m4, mr4));
 
-    for (set<MinimizerHitPtr, pComp>::iterator it = mhits.hits.begin();
-         it != --mhits.hits.end(); ++it) {
+    const auto hits = mhits.cluster();
+    for (set<MinimizerHitPtr, pComp>::iterator it = hits.begin(); it != --hits.end();
+         ++it) {
         mhitspath.insert(*it);
     }
     uint32_t j(0);
@@ -0,0 +1,105 @@
+#include "gtest/gtest.h"
+#include "minimal_perfect_hash.h"
+#include "inthash.h"
+#include <vector>
+#include <set>
+#include <stdint.h>
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+vector<uint64_t> random_keys(const uint64_t& number_of_keys)
+{
+    vector<uint64_t> keys;
+    for (uint64_t i = 0; i < number_of_keys; ++i) {
+        keys.push_back(hash64(i * 7919 + 1, (1ull << 30) - 1));
+    }
+    sort(keys.begin(), keys.end());
+    keys.erase(unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
+
+// checks that the keys are mapped to distinct values in [0, number of keys)
+void expect_minimal_perfect(
+    const MinimalPerfectHash& mphf, const vector<uint64_t>& keys)
+{
+    EXPECT_EQ(mphf.size(), keys.size());
+    vector<bool> used(keys.size(), false);
+    for (const auto& key : keys) {
+        const auto value = mphf.lookup(key);
+        ASSERT_LT(value, keys.size());
+        EXPECT_FALSE(used[value]);
+        used[value] = true;
+    }
+}
+}
+
+TEST(MinimalPerfectHashTest, noKeys_lookupOutOfRange)
+{
+    const MinimalPerfectHash mphf;
+    EXPECT_EQ(mphf.size(), (uint64_t)0);
+    EXPECT_GE(mphf.lookup(42), mphf.size());
+
+    const MinimalPerfectHash built(nullptr, 0);
+    EXPECT_EQ(built.get_num_levels(), (uint64_t)0);
+    EXPECT_GE(built.lookup(42), built.size());
+}
+
+TEST(MinimalPerfectHashTest, fewKeys_minimalPerfect)
+{
+    for (uint64_t number_of_keys = 1; number_of_keys < 70; ++number_of_keys) {
+        const auto keys = random_keys(number_of_keys);
+        expect_minimal_perfect(MinimalPerfectHash(keys.data(), keys.size()), keys);
+    }
+}
+
+TEST(MinimalPerfectHashTest, manyKeys_minimalPerfectAndSmall)
+{
+    const auto keys = random_keys(100000);
+    const MinimalPerfectHash mphf(keys.data(), keys.size());
+    expect_minimal_perfect(mphf, keys);
+    // about 4 bits per key
+    EXPECT_LT(mphf.get_num_blocks() * MinimalPerfectHash::WORDS_PER_BLOCK * 64,
+        6 * keys.size());
+}
+
+TEST(MinimalPerfectHashTest, builtFromKeyIterator_sameAsFromArray)
+{
+    const auto keys = random_keys(5000);
+    const MinimalPerfectHash from_array(keys.data(), keys.size());
+    uint32_t number_of_iterations = 0;
+    const MinimalPerfectHash from_iterator(
+        keys.size(), [&](const std::function<void(const uint64_t&)>& callback) {
+            ++number_of_iterations;
+            for (const auto& key : keys) {
+                callback(key);
+            }
+        });
+
+    EXPECT_GT(number_of_iterations, (uint32_t)1);
+    for (const auto& key : keys) {
+        EXPECT_EQ(from_iterator.lookup(key), from_array.lookup(key));
+    }
+}
+
+TEST(MinimalPerfectHashTest, fromArrays_sameAsBuilt)
+{
+    const auto keys = random_keys(5000);
+    const MinimalPerfectHash built(keys.data(), keys.size());
+    const MinimalPerfectHash view(built.size(), built.get_levels(),
+        built.get_num_levels(), built.get_blocks(), built.get_num_blocks(),
+        built.get_leftover_keys(), built.get_num_leftover_keys());
+
+    for (const auto& key : keys) {
+        EXPECT_EQ(view.lookup(key), built.lookup(key));
+    }
+}
+
+TEST(MinimalPerfectHashTest, movedFunction_stillWorks)
+{
+    const auto keys = random_keys(1000);
+    MinimalPerfectHash built(keys.data(), keys.size());
+    const MinimalPerfectHash moved(std::move(built));
+    expect_minimal_perfect(moved, keys);
+}
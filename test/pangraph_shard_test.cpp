@@ -0,0 +1,151 @@
+#include "gtest/gtest.h"
+#include "pangenome/ns.cpp"
+#include "pangenome/pangraph.h"
+#include "pangenome/pangraph_shard.h"
+#include "pangenome/pannode.h"
+#include "pangenome/panread.h"
+#include "minihit.h"
+#include "localPRG.h"
+#include "index.h"
+#include "frozen_index.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace pangenome;
+
+namespace {
+// a cluster of hits of the read on the prg, at the given read positions
+MinimizerHitCluster make_cluster(const uint32_t read_id, const uint32_t prg_id,
+    const std::vector<uint32_t>& positions, const prg::Path& path)
+{
+    MinimizerHitCluster cluster;
+    for (const auto& position : positions) {
+        Minimizer m(0, position, position + 3, 0);
+        cluster.insert(
+            std::make_shared<MinimizerHit>(read_id, m, prg_id, path, position, false));
+    }
+    return cluster;
+}
+
+std::vector<uint32_t> node_ids_in_order(const pangenome::Graph& graph)
+{
+    std::vector<uint32_t> node_ids;
+    for (const auto& node : graph.nodes) {
+        node_ids.push_back(node.first);
+    }
+    return node_ids;
+}
+}
+
+TEST(PangenomeGraphShardTest, merge_sameGraphAsAddingClustersInReadOrder)
+{
+    prg::Path path;
+    path.initialize(Interval(0, 3));
+    std::vector<std::shared_ptr<LocalPRG>> prgs;
+    for (uint32_t i = 0; i < 4; ++i) {
+        prgs.push_back(std::make_shared<LocalPRG>(i, "prg" + std::to_string(i), ""));
+    }
+
+    // reads 0 and 2 are mapped by a thread, reads 1 and 3 by another
+    const std::vector<MinimizerHitCluster> clusters {
+        make_cluster(0, 3, { 0, 1 }, path), make_cluster(0, 1, { 5 }, path),
+        make_cluster(1, 2, { 0, 2 }, path), make_cluster(2, 0, { 1 }, path),
+        make_cluster(2, 3, { 4, 6 }, path), make_cluster(3, 1, { 2 }, path)
+    };
+    std::vector<GraphShard> shards(2);
+    shards[1].add_cluster(clusters[2]);
+    shards[0].add_cluster(clusters[0]);
+    shards[0].add_cluster(clusters[1]);
+    shards[1].add_cluster(clusters[5]);
+    shards[0].add_cluster(clusters[3]);
+    shards[0].add_cluster(clusters[4]);
+
+    pangenome::Graph merged;
+    GraphShard::merge(shards, merged, prgs);
+    EXPECT_EQ(shards[0].number_of_clusters(), (size_t)0);
+    EXPECT_EQ(shards[1].number_of_clusters(), (size_t)0);
+
+    pangenome::Graph expected;
+    for (auto cluster : clusters) {
+        const auto& hit = **cluster.begin();
+        expected.add_hits_between_PRG_and_read(
+            prgs[hit.get_prg_id()], hit.get_read_id(), cluster);
+    }
+
+    EXPECT_EQ(merged, expected);
+    EXPECT_EQ(node_ids_in_order(merged), node_ids_in_order(expected));
+    for (const auto& read : expected.reads) {
+        const auto& merged_read = *merged.get_read(read.first);
+        EXPECT_EQ(merged_read.get_hits_as_unordered_map(),
+            read.second->get_hits_as_unordered_map());
+        EXPECT_EQ(merged_read.node_orientations, read.second->node_orientations);
+        ASSERT_EQ(merged_read.get_nodes().size(), read.second->get_nodes().size());
+        for (uint32_t i = 0; i < merged_read.get_nodes().size(); ++i) {
+            EXPECT_EQ(merged_read.get_nodes()[i].lock()->node_id,
+                read.second->get_nodes()[i].lock()->node_id);
+        }
+    }
+}
+
+TEST(PangenomeGraphShardTest, merge_hitsOfTheGraphIndexAreNotCopied)
+{
+    prg::Path path;
+    path.initialize(Interval(0, 3));
+    std::vector<std::shared_ptr<LocalPRG>> prgs;
+    Index index;
+    for (uint32_t i = 0; i < 2; ++i) {
+        prgs.push_back(std::make_shared<LocalPRG>(i, "prg" + std::to_string(i), ""));
+        index.add_record(i, i, path, 0, 0);
+    }
+    auto frozen_index = std::make_shared<FrozenIndex>(index);
+
+    // hits of records of the index, on both strands of the reads
+    const auto make_indexed_cluster = [&](const uint32_t read_id,
+                                          const uint32_t prg_id,
+                                          const std::vector<uint32_t>& positions,
+                                          const bool read_strand) {
+        const auto& record = *frozen_index->find(prg_id).begin();
+        MinimizerHitCluster cluster;
+        for (const auto& position : positions) {
+            Minimizer m(0, position, position + 3, read_strand);
+            cluster.insert(std::make_shared<MinimizerHit>(read_id, m, record.prg_id,
+                frozen_index->get_path(record), record.knode_id, record.strand != 0,
+                frozen_index->get_record_id(record)));
+        }
+        return cluster;
+    };
+    const std::vector<MinimizerHitCluster> clusters { make_indexed_cluster(
+                                                          0, 1, { 0, 4 }, true),
+        make_indexed_cluster(0, 0, { 6 }, false),
+        make_indexed_cluster(0, 1, { 1, 9 }, true),
+        make_indexed_cluster(1, 0, { 2, 3 }, false) };
+    std::vector<GraphShard> shards;
+    shards.emplace_back(frozen_index);
+    shards.emplace_back(frozen_index);
+    shards[0].add_cluster(clusters[0]);
+    shards[0].add_cluster(clusters[1]);
+    shards[0].add_cluster(clusters[2]);
+    shards[1].add_cluster(clusters[3]);
+
+    pangenome::Graph merged;
+    merged.hit_records->set_index(frozen_index);
+    GraphShard::merge(shards, merged, prgs);
+    EXPECT_EQ(merged.hit_records->number_of_added_records(), (uint64_t)0);
+
+    pangenome::Graph expected;
+    expected.hit_records->set_index(frozen_index);
+    for (auto cluster : clusters) {
+        const auto& hit = **cluster.begin();
+        expected.add_hits_between_PRG_and_read(
+            prgs[hit.get_prg_id()], hit.get_read_id(), cluster);
+    }
+
+    EXPECT_EQ(merged, expected);
+    for (const auto& read : expected.reads) {
+        const auto& merged_read = *merged.get_read(read.first);
+        EXPECT_EQ(merged_read.get_hits_as_unordered_map(),
+            read.second->get_hits_as_unordered_map());
+        EXPECT_EQ(merged_read.node_orientations, read.second->node_orientations);
+    }
+}
@@ -214,11 +214,11 @@ TEST(PangenomeGraph_add_hits_between_PRG_and_read, AddClusters)
                                                           // inserted?
         EXPECT_EQ(pg.get_read(read_id_1)->get_hits_as_unordered_map().size(),
             1); // is the hit really inserted?
-        EXPECT_EQ(*pg.get_read(read_id_1)->get_hits_as_unordered_map()[prg_id_1][0],
+        EXPECT_EQ(pg.get_read(read_id_1)->get_hits_as_unordered_map()[prg_id_1][0],
             *minimizer_hit_1); // is the hit really inserted?
         EXPECT_EQ(pg.get_read(read_id_1)
                       ->get_hits_as_unordered_map()[prg_id_1][0]
-                      ->get_kmer_node_id(),
+                      .get_kmer_node_id(),
             prg_id_1); // is the node really inserted in the read?
         EXPECT_EQ(pg.get_read(read_id_1)->node_orientations.size(),
             1); // is the node_orientation was inserted in the read?
@@ -257,9 +257,9 @@ TEST(PangenomeGraph_add_hits_between_PRG_and_read, AddClusters)
                                                           // inserted?
         EXPECT_EQ(pg.get_read(read_id_1)->get_hits_as_unordered_map().size(),
             2); // we should have another hit here
-        EXPECT_EQ(*pg.get_read(read_id_1)->get_hits_as_unordered_map()[prg_id_1][0],
+        EXPECT_EQ(pg.get_read(read_id_1)->get_hits_as_unordered_map()[prg_id_1][0],
             *minimizer_hit_1); // is the hit really inserted?
-        EXPECT_EQ(*pg.get_read(read_id_1)->get_hits_as_unordered_map()[prg_id_2][0],
+        EXPECT_EQ(pg.get_read(read_id_1)->get_hits_as_unordered_map()[prg_id_2][0],
             *minimizer_hit_2); // is the hit really inserted?
         EXPECT_EQ(pg.get_read(read_id_1)->node_orientations.size(),
             2); // is the node_orientation was inserted in the read?
@@ -304,7 +304,7 @@ TEST(PangenomeGraph_add_hits_between_PRG_and_read, AddClusters)
         EXPECT_EQ(pg.reads.size(), 2);
         EXPECT_EQ(pg.get_read(read_id_3)->id, read_id_3);
         EXPECT_EQ(pg.get_read(read_id_3)->get_hits_as_unordered_map().size(), 1);
-        EXPECT_EQ(*pg.get_read(read_id_3)->get_hits_as_unordered_map()[prg_id_1][0],
+        EXPECT_EQ(pg.get_read(read_id_3)->get_hits_as_unordered_map()[prg_id_1][0],
             *minimizer_hit_3);
         EXPECT_EQ(pg.get_read(read_id_3)->get_nodes().size(), 1);
         EXPECT_EQ(pg.get_read(read_id_3)->get_nodes()[0].lock()->node_id, prg_id_1);
@@ -392,11 +392,11 @@ TEST(PangenomeGraph_add_hits_between_PRG_and_read, AddTheSameClusterTwice)
                                                           // inserted?
         EXPECT_EQ(pg.get_read(read_id_1)->get_hits_as_unordered_map().size(),
             1); // is the hit really inserted?
-        EXPECT_EQ(*pg.get_read(read_id_1)->get_hits_as_unordered_map()[prg_id_1][0],
+        EXPECT_EQ(pg.get_read(read_id_1)->get_hits_as_unordered_map()[prg_id_1][0],
             *minimizer_hit_1); // is the hit really inserted?
         EXPECT_EQ(pg.get_read(read_id_1)
                       ->get_hits_as_unordered_map()[prg_id_1][0]
-                      ->get_kmer_node_id(),
+                      .get_kmer_node_id(),
             prg_id_1); // is the node really inserted in the read?
         EXPECT_EQ(pg.get_read(read_id_1)->node_orientations.size(),
             1); // is the node_orientation was inserted in the read?
@@ -421,9 +421,9 @@ TEST(PangenomeGraph_add_hits_between_PRG_and_read, AddTheSameClusterTwice)
         change EXPECT_EQ(pg.get_read(read_id_1)->id, read_id_1); //should not change
         EXPECT_EQ(pg.get_read(read_id_1)->get_hits_as_unordered_map().size(), 1);
         //should not change
-        EXPECT_EQ(*pg.get_read(read_id_1)->get_hits_as_unordered_map()[prg_id_1][0],
+        EXPECT_EQ(pg.get_read(read_id_1)->get_hits_as_unordered_map()[prg_id_1][0],
         *minimizer_hit_1); //should not change
-        EXPECT_EQ(pg.get_read(read_id_1)->get_hits_as_unordered_map()[prg_id_1][0]->get_kmer_node_id(),
+        EXPECT_EQ(pg.get_read(read_id_1)->get_hits_as_unordered_map()[prg_id_1][0].get_kmer_node_id(),
         prg_id_1); //should not change
         EXPECT_EQ(pg.get_read(read_id_1)->node_orientations.size(), 1); //should not
         change EXPECT_EQ(pg.get_read(read_id_1)->node_orientations[0], true); //should
@@ -1147,7 +1147,8 @@ TEST(PangenomeGraphTest, save_mapped_read_strings)
 
     auto l0 = std::make_shared<LocalPRG>(LocalPRG(0, "zero", ""));
     pg.add_node(l0);
-    pg.add_hits_between_PRG_and_read(l0, 1, mhits.hits);
+    auto cluster = mhits.cluster();
+    pg.add_hits_between_PRG_and_read(l0, 1, cluster);
     mhits.clear();
 
     // read 2
@@ -1163,7 +1164,8 @@ TEST(PangenomeGraphTest, save_mapped_read_strings)
     MiniRecord mr5(0, p, 0, 0);
     mhits.add_hit(2, m5, mr5);
 
-    pg.add_hits_between_PRG_and_read(l0, 2, mhits.hits);
+    cluster = mhits.cluster();
+    pg.add_hits_between_PRG_and_read(l0, 2, cluster);
 
     std::string expected1
         = ">read1 pandora: 1 0:6 + \nshould\n>read2 pandora: 2 2:10 - \nis time \n";
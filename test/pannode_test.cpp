@@ -122,7 +122,7 @@ TEST(PangenomeNodeTest, get_read_overlap_coordinates)
     mhits.add_hit(1, m3, mr3);
 
     pr = std::make_shared<pangenome::Read>(1);
-    pr->add_hits(pan_node_ptr, mhits.hits);
+    pr->add_hits(pan_node_ptr, mhits.cluster());
     pan_node_ptr->reads.insert(pr);
     mhits.clear();
 
@@ -140,7 +140,7 @@ TEST(PangenomeNodeTest, get_read_overlap_coordinates)
     mhits.add_hit(2, m5, mr5);
 
     pr = std::make_shared<pangenome::Read>(2);
-    pr->add_hits(pan_node_ptr, mhits.hits);
+    pr->add_hits(pan_node_ptr, mhits.cluster());
     pan_node_ptr->reads.insert(pr);
     mhits.clear();
 
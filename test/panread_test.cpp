@@ -104,6 +104,38 @@ TEST(ReadAddHits, AddSecondCluster_ReadHitsMapContainsCorrectPrgIds)
     EXPECT_TRUE(result);
 }
 
+TEST(ReadAddHits, AddClustersOfTwoPrgs_GetHitsOfEachPrg)
+{
+    uint32_t read_id = 1;
+    Read read(read_id);
+    std::deque<Interval> raw_path = { Interval(7, 8), Interval(10, 14) };
+    prg::Path path;
+    path.initialize(raw_path);
+    Minimizer m1(0, 0, 5, 0); // kmer, start, end, strand
+    Minimizer m2(0, 1, 6, 0);
+    MiniRecord mr4(4, path, 0, 0);
+    MiniRecord mr5(5, path, 1, 1);
+
+    std::set<MinimizerHitPtr, pComp> cluster_4, cluster_5;
+    cluster_4.insert(std::make_shared<MinimizerHit>(read_id, m1, mr4));
+    cluster_4.insert(std::make_shared<MinimizerHit>(read_id, m2, mr4));
+    cluster_5.insert(std::make_shared<MinimizerHit>(read_id, m1, mr5));
+    auto local_prg_ptr_4 { std::make_shared<LocalPRG>(4, "four", "") };
+    auto local_prg_ptr_5 { std::make_shared<LocalPRG>(5, "five", "") };
+    read.add_hits(make_shared<pangenome::Node>(local_prg_ptr_5), cluster_5);
+    read.add_hits(make_shared<pangenome::Node>(local_prg_ptr_4), cluster_4);
+
+    const auto hits_4 = read.get_hits(4);
+    ASSERT_EQ(hits_4.size(), (size_t)2);
+    EXPECT_EQ(hits_4[0], **cluster_4.begin());
+    EXPECT_EQ(hits_4[1], **cluster_4.rbegin());
+    const auto hits_5 = read.get_hits(5);
+    ASSERT_EQ(hits_5.size(), (size_t)1);
+    EXPECT_EQ(hits_5[0], **cluster_5.begin());
+    EXPECT_EQ(hits_5[0].get_kmer_node_id(), (uint32_t)1);
+    EXPECT_TRUE(read.get_hits(6).empty());
+}
+
 TEST(PangenomeReadTest, find_position)
 {
     std::set<MinimizerHitPtr, pComp> dummy_cluster;
@@ -20,6 +20,13 @@ TEST(PathTest, initialize)
     }
 }
 
+TEST(PathTest, sizeof_onlyIntervals)
+{
+    // paths are copied into every k-mer node and index record, so they carry no
+    // memoization state
+    EXPECT_EQ(sizeof(Path), sizeof(vector<Interval>));
+}
+
 TEST(PathTest, length)
 {
     Path p;
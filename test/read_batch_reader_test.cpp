@@ -0,0 +1,92 @@
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "read_batch_reader.h"
+#include "fastaq_handler.h"
+
+using namespace std;
+
+const std::string TEST_CASE_DIR = "../../test/test_cases/";
+
+namespace {
+vector<string> read_all(const string& filepath)
+{
+    vector<string> reads;
+    FastaqHandler fh(filepath);
+    while (true) {
+        try {
+            fh.get_next();
+        } catch (std::out_of_range& err) {
+            break;
+        }
+        reads.push_back(fh.name + " " + fh.read);
+    }
+    return reads;
+}
+}
+
+TEST(ReadBatchReaderTest, non_existant_file_throws_exception)
+{
+    EXPECT_THROW(ReadBatchReader reader("fake.file"), std::ios_base::failure);
+}
+
+TEST(ReadBatchReaderTest, next_batch_readsInOrderInBatches)
+{
+    const auto expected = read_all(TEST_CASE_DIR + "reads.fq.gz");
+    ASSERT_EQ(expected.size(), (size_t)5);
+
+    ReadBatchReader reader(TEST_CASE_DIR + "reads.fq.gz", 2, 1);
+    ReadBatch batch;
+    vector<string> reads;
+    vector<uint32_t> batch_sizes;
+    while (reader.next_batch(batch)) {
+        EXPECT_EQ(batch.first_id, reads.size());
+        batch_sizes.push_back(batch.size);
+        for (uint32_t i = 0; i < batch.size; ++i) {
+            reads.push_back(batch.names[i] + " " + batch.reads[i]);
+        }
+    }
+
+    EXPECT_EQ(reads, expected);
+    EXPECT_EQ(batch_sizes, vector<uint32_t>({ 2, 2, 1 }));
+    EXPECT_EQ(reader.number_of_reads(), (uint32_t)5);
+    EXPECT_FALSE(reader.next_batch(batch));
+}
+
+TEST(ReadBatchReaderTest, next_batch_eachReadHandedOutOnceToManyThreads)
+{
+    const auto expected = read_all(TEST_CASE_DIR + "reads.fa");
+    ReadBatchReader reader(TEST_CASE_DIR + "reads.fa", 1, 2);
+    vector<vector<string>> reads_by_id(expected.size());
+
+    vector<thread> threads;
+    for (uint32_t t = 0; t < 3; ++t) {
+        threads.emplace_back([&reader, &reads_by_id] {
+            ReadBatch batch;
+            while (reader.next_batch(batch)) {
+                for (uint32_t i = 0; i < batch.size; ++i) {
+                    reads_by_id[batch.first_id + i].push_back(
+                        batch.names[i] + " " + batch.reads[i]);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (uint32_t id = 0; id < expected.size(); ++id) {
+        EXPECT_EQ(reads_by_id[id], vector<string>({ expected[id] }));
+    }
+    EXPECT_EQ(reader.number_of_reads(), expected.size());
+}
+
+TEST(ReadBatchReaderTest, destructor_stopsReadingBeforeTheEnd)
+{
+    ReadBatchReader reader(TEST_CASE_DIR + "reads.fa", 1, 1);
+    ReadBatch batch;
+    EXPECT_TRUE(reader.next_batch(batch));
+    EXPECT_EQ(batch.first_id, (uint32_t)0);
+}
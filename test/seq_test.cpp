@@ -2,6 +2,11 @@
 #include "seq.h"
 #include "minimizer.h"
 #include "interval.h"
+#include "inthash.h"
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <set>
 #include <stdint.h>
 #include <iostream>
 
@@ -94,3 +99,120 @@ TEST(SeqTest, sketchIncludesEveryLetter)
         EXPECT_EQ((pos_inc.find(i) != pos_inc.end()), true);
     }
 }
+
+namespace {
+// all the smallest k-mers of each window of w consecutive k-mers of an ACGT stretch
+// starting at position offset of a read
+void add_every_minimizer_of_every_window(std::set<Minimizer>& minimizers,
+    const std::string& stretch, const uint32_t w, const uint32_t k,
+    const uint32_t offset = 0)
+{
+    KmerHash hasher;
+    vector<Minimizer> kmers;
+    for (uint32_t i = 0; i + k <= stretch.length(); ++i) {
+        const auto kh = hasher.kmerhash(stretch.substr(i, k), k);
+        kmers.emplace_back(std::min(kh.first, kh.second), offset + i, offset + i + k,
+            kh.first <= kh.second);
+    }
+    for (uint32_t i = 0; i + w <= kmers.size(); ++i) {
+        uint64_t smallest = std::numeric_limits<uint64_t>::max();
+        for (uint32_t j = i; j < i + w; ++j) {
+            smallest = std::min(smallest, kmers[j].canonical_kmer_hash);
+        }
+        for (uint32_t j = i; j < i + w; ++j) {
+            if (kmers[j].canonical_kmer_hash == smallest) {
+                minimizers.insert(kmers[j]);
+            }
+        }
+    }
+}
+
+std::string random_read(std::mt19937& generator, const uint32_t max_length)
+{
+    std::string read;
+    const uint32_t length = generator() % max_length;
+    for (uint32_t i = 0; i < length; ++i) {
+        read += "ACGT"[generator() % 4];
+    }
+    return read;
+}
+
+void expect_sketch_is_every_minimizer_of_every_window(std::mt19937& generator,
+    const uint32_t w, const uint32_t k, const uint32_t max_length)
+{
+    const auto read = random_read(generator, max_length);
+    std::set<Minimizer> expected;
+    add_every_minimizer_of_every_window(expected, read, w, k);
+
+    const Seq sequence(0, "0", read, w, k);
+    EXPECT_EQ(sequence.sketch, vector<Minimizer>(expected.begin(), expected.end()))
+        << read << " w=" << w << " k=" << k;
+}
+}
+
+TEST(SeqTest, sketchIsEveryMinimizerOfEveryWindow)
+{
+    // small k so that there are many ties
+    std::mt19937 generator(0);
+    for (uint32_t test = 0; test < 500; ++test) {
+        const uint32_t w = 1 + generator() % 12, k = 1 + generator() % 4;
+        expect_sketch_is_every_minimizer_of_every_window(generator, w, k, 200);
+    }
+}
+
+TEST(SeqTest, sketchIsEveryMinimizerOfEveryWindow_defaultSizesKernels)
+{
+    std::mt19937 generator(0);
+    for (uint32_t test = 0; test < 50; ++test) {
+        expect_sketch_is_every_minimizer_of_every_window(generator, 14, 15, 2000);
+        expect_sketch_is_every_minimizer_of_every_window(
+            generator, 1 + generator() % 15, 15, 2000);
+    }
+}
+
+TEST(SeqTest, initialize_sameSketchAsNewSeq)
+{
+    Seq sequence(0, "0", "AGCTAATGCGTTAGGCTTAAGCTAGAGATTACCGATAGAT", 5, 3);
+    sequence.initialize(1, "1", "TTAGGCTTAAGCTAGAGCTAATGCGTTATTACCGAT", 4, 3);
+    const Seq new_sequence(1, "1", "TTAGGCTTAAGCTAGAGCTAATGCGTTATTACCGAT", 4, 3);
+    EXPECT_EQ(sequence.sketch, new_sequence.sketch);
+}
+
+TEST(SeqTest, sketchRestartsAfterAmbiguousBases)
+{
+    // each stretch of ACGT letters is sketched on its own
+    std::mt19937 generator(0);
+    for (uint32_t test = 0; test < 300; ++test) {
+        const uint32_t w = 1 + generator() % 12, k = 1 + generator() % 4;
+        std::string read;
+        std::set<Minimizer> expected;
+        const uint32_t number_ambiguous_bases = 1 + generator() % 3;
+        for (uint32_t i = 0; i <= number_ambiguous_bases; ++i) {
+            if (i > 0) {
+                read += "NnRY-"[generator() % 5];
+            }
+            const auto stretch = random_read(generator, 60);
+            add_every_minimizer_of_every_window(
+                expected, stretch, w, k, read.length());
+            read += stretch;
+        }
+
+        const Seq sequence(0, "0", read, w, k);
+        if (read.length() + 1 < w + k) {
+            EXPECT_TRUE(sequence.sketch.empty());
+            continue;
+        }
+        EXPECT_EQ(sequence.sketch, vector<Minimizer>(expected.begin(), expected.end()))
+            << read << " w=" << w << " k=" << k;
+        EXPECT_EQ(sequence.number_ambiguous_bases, number_ambiguous_bases);
+    }
+}
+
+TEST(SeqTest, initialize_resetsNumberAmbiguousBases)
+{
+    Seq sequence(0, "0", "AGCTAATGCGNTAGGCTTAAGCTAGAGANTTACCGATAGAT", 5, 3);
+    EXPECT_EQ(sequence.number_ambiguous_bases, (uint32_t)2);
+    EXPECT_FALSE(sequence.sketch.empty());
+    sequence.initialize(1, "1", "TTAGGCTTAAGCTAGAGCTAATGCGTTATTACCGAT", 4, 3);
+    EXPECT_EQ(sequence.number_ambiguous_bases, (uint32_t)0);
+}
@@ -8,10 +8,12 @@
 #include "minihit.h"
 #include "minihits.h"
 #include "index.h"
+#include "frozen_index.h"
 #include "inthash.h"
 #include "seq.h"
 #include <stdint.h>
 #include <iostream>
+#include <fstream>
 #include <algorithm>
 #include <vector>
 
@@ -96,6 +98,40 @@ TEST(UtilsTest, readPrgFile)
     EXPECT_EQ(prgs.size(), j);
 }
 
+TEST(UtilsTest, readPrgFile_skippedPrgsTakeTheirIds)
+{
+    std::vector<std::shared_ptr<LocalPRG>> prgs;
+    read_prg_file(prgs, TEST_CASE_DIR + "prg0123.fa", 0, 2);
+    EXPECT_EQ(prgs.size(), (uint)1);
+    EXPECT_EQ(prgs[0]->id, (uint)2);
+    EXPECT_EQ(prgs[0]->name, "prg3");
+}
+
+TEST(UtilsTest, readPrgFile_multipleThreads_sameIdsAndOrder)
+{
+    // enough PRGs for several batches
+    const std::string prgfile { "read_prg_file_threads.fa" };
+    {
+        std::ofstream handle(prgfile);
+        const std::vector<std::string> seqs { "AGCT", "A 5 GC 6 G 5 T",
+            "A 5 G 7 C 8 T 7  6 G 5 T", "ACGT 5 G 6 T 5 ACC" };
+        for (uint32_t i = 0; i < 2500; ++i) {
+            handle << ">prg" << i << "\n" << seqs[i % seqs.size()] << "\n";
+        }
+    }
+
+    std::vector<std::shared_ptr<LocalPRG>> prgs, prgs_in_parallel;
+    read_prg_file(prgs, prgfile, 3);
+    read_prg_file(prgs_in_parallel, prgfile, 3, 0, false, 4);
+    ASSERT_EQ(prgs_in_parallel.size(), (uint)2500);
+    for (uint32_t i = 0; i < prgs.size(); ++i) {
+        EXPECT_EQ(prgs_in_parallel[i]->id, i + 3);
+        EXPECT_EQ(prgs_in_parallel[i]->name, prgs[i]->name);
+        EXPECT_EQ(prgs_in_parallel[i]->seq, prgs[i]->seq);
+        EXPECT_EQ(prgs_in_parallel[i]->prg, prgs[i]->prg);
+    }
+}
+
 TEST(UtilsTest, readPrgFile_with_offset)
 {
     std::vector<std::shared_ptr<LocalPRG>> prgs;
@@ -146,10 +182,10 @@ TEST(UtilsTest, addReadHits)
 {
     // initialize minihits container
     auto minimizer_hits = std::make_shared<MinimizerHits>(MinimizerHits());
-    MinimizerHits expected1;
-    MinimizerHits expected2;
-    MinimizerHits expected3;
-    MinimizerHits expected4;
+    MinimizerHitCluster expected1;
+    MinimizerHitCluster expected2;
+    MinimizerHitCluster expected3;
+    MinimizerHitCluster expected4;
 
     // initialize index as we would expect with example prgs 1 and 3 from above
     KmerHash hash;
@@ -166,8 +202,8 @@ TEST(UtilsTest, addReadHits)
     Minimizer min2(0, 1, 4, 0); // kmer, start, end, strand
     MiniRecord mr2(1, p, 0, 1);
     MinimizerHitPtr m2(make_shared<MinimizerHit>(0, min2, mr2));
-    expected1.hits.insert(m1);
-    expected2.hits.insert(m2);
+    expected1.insert(m1);
+    expected2.insert(m2);
     d = { Interval(1, 4) };
     p.initialize(d);
     kh = hash.kmerhash("GCT", 3);
@@ -181,8 +217,8 @@ TEST(UtilsTest, addReadHits)
     MiniRecord mr4(1, p, 0, 1);
     MinimizerHitPtr m4(make_shared<MinimizerHit>(0, min4, mr4));
 
-    expected2.hits.insert(m3);
-    expected1.hits.insert(m4);
+    expected2.insert(m3);
+    expected1.insert(m4);
     d = { Interval(0, 1), Interval(4, 5), Interval(8, 9) };
     p.initialize(d);
     kh = hash.kmerhash("AGC", 3);
@@ -194,8 +230,8 @@ TEST(UtilsTest, addReadHits)
     Minimizer min6(0, 1, 4, 0); // kmer, start, end, strand
     MiniRecord mr6(3, p, 0, 1);
     MinimizerHitPtr m6(make_shared<MinimizerHit>(0, min6, mr6));
-    expected1.hits.insert(m5);
-    expected2.hits.insert(m6);
+    expected1.insert(m5);
+    expected2.insert(m6);
     d = { Interval(0, 1), Interval(4, 5), Interval(12, 13) };
     p.initialize(d);
     kh = hash.kmerhash("AGT", 3);
@@ -204,7 +240,7 @@ TEST(UtilsTest, addReadHits)
     Minimizer min9(0, 0, 3, 1); // kmer, start, end, strand
     MiniRecord mr9(3, p, 0, 1);
     MinimizerHitPtr m9(make_shared<MinimizerHit>(0, min9, mr9));
-    expected3.hits.insert(m9);
+    expected3.insert(m9);
     d = { Interval(0, 1), Interval(19, 20), Interval(23, 24) };
     p.initialize(d);
     index->add_record(min(kh.first, kh.second), 3, p, 0, (kh.first < kh.second));
@@ -212,7 +248,7 @@ TEST(UtilsTest, addReadHits)
     Minimizer min10(0, 0, 3, 1); // kmer, start, end, strand
     MiniRecord mr10(3, p, 0, 1);
     MinimizerHitPtr m10(make_shared<MinimizerHit>(0, min10, mr10));
-    expected3.hits.insert(m10);
+    expected3.insert(m10);
     d = { Interval(4, 5), Interval(8, 9), Interval(16, 16), Interval(23, 24) };
     p.initialize(d);
     kh = hash.kmerhash("GCT", 3);
@@ -225,8 +261,8 @@ TEST(UtilsTest, addReadHits)
     Minimizer min8(0, 0, 3, 0); // kmer, start, end, strand
     MiniRecord mr8(3, p, 0, 1);
     MinimizerHitPtr m8(make_shared<MinimizerHit>(0, min8, mr8));
-    expected2.hits.insert(m7);
-    expected1.hits.insert(m8);
+    expected2.insert(m7);
+    expected1.insert(m8);
     d = { Interval(4, 5), Interval(12, 13), Interval(16, 16), Interval(23, 24) };
     p.initialize(d);
     kh = hash.kmerhash("GTT", 3);
@@ -235,15 +271,17 @@ TEST(UtilsTest, addReadHits)
     Minimizer min11(0, 1, 4, 1); // kmer, start, end, strand
     MiniRecord mr11(3, p, 0, 1);
     MinimizerHitPtr m11(make_shared<MinimizerHit>(0, min11, mr11));
-    expected4.hits.insert(m11);
+    expected4.insert(m11);
 
+    const FrozenIndex frozen_index(*index);
     Seq s(0, "read1", "AGC", 1, 3);
-    add_read_hits(s, minimizer_hits, *index);
-    EXPECT_EQ(expected1.hits.size(), minimizer_hits->hits.size());
-    set<MinimizerHitPtr, pComp>::const_iterator it2 = expected1.hits.begin();
-    for (set<MinimizerHitPtr, pComp>::const_iterator it = minimizer_hits->hits.begin();
-         it != minimizer_hits->hits.end(); ++it) {
-        EXPECT_EQ(**it2, **it);
+    add_read_hits(s, minimizer_hits, frozen_index);
+    minimizer_hits->sort();
+    EXPECT_EQ(expected1.size(), minimizer_hits->hits.size());
+    set<MinimizerHitPtr, pComp>::const_iterator it2 = expected1.begin();
+    for (auto it = minimizer_hits->hits.begin(); it != minimizer_hits->hits.end();
+         ++it) {
+        EXPECT_EQ(**it2, MinimizerHit(*it));
         it2++;
     }
 
@@ -254,27 +292,29 @@ TEST(UtilsTest, addReadHits)
     uint32_t j = 0;
     EXPECT_EQ(j, minimizer_hits->hits.size());
     s = Seq(0, "read2", "AGTT", 2, 3);
-    add_read_hits(s, minimizer_hits, *index);
-    EXPECT_EQ(expected4.hits.size(), minimizer_hits->hits.size());
-    it2 = expected4.hits.begin();
-    for (set<MinimizerHitPtr, pComp>::const_iterator it = minimizer_hits->hits.begin();
-         it != minimizer_hits->hits.end(); ++it) {
-        EXPECT_EQ(**it2, **it);
+    add_read_hits(s, minimizer_hits, frozen_index);
+    minimizer_hits->sort();
+    EXPECT_EQ(expected4.size(), minimizer_hits->hits.size());
+    it2 = expected4.begin();
+    for (auto it = minimizer_hits->hits.begin(); it != minimizer_hits->hits.end();
+         ++it) {
+        EXPECT_EQ(**it2, MinimizerHit(*it));
         it2++;
     }
 
     // but for w=1, only add one more hit, for GTT
-    expected3.hits.insert(m11);
+    expected3.insert(m11);
 
     minimizer_hits = std::make_shared<MinimizerHits>(MinimizerHits());
     EXPECT_EQ(j, minimizer_hits->hits.size());
     s = Seq(0, "read2", "AGTT", 1, 3);
-    add_read_hits(s, minimizer_hits, *index);
-    EXPECT_EQ(expected3.hits.size(), minimizer_hits->hits.size());
-    it2 = expected3.hits.begin();
-    for (set<MinimizerHitPtr, pComp>::const_iterator it = minimizer_hits->hits.begin();
-         it != minimizer_hits->hits.end(); ++it) {
-        EXPECT_EQ(**it2, **it);
+    add_read_hits(s, minimizer_hits, frozen_index);
+    minimizer_hits->sort();
+    EXPECT_EQ(expected3.size(), minimizer_hits->hits.size());
+    it2 = expected3.begin();
+    for (auto it = minimizer_hits->hits.begin(); it != minimizer_hits->hits.end();
+         ++it) {
+        EXPECT_EQ(**it2, MinimizerHit(*it));
         it2++;
     }
 
@@ -284,13 +324,14 @@ TEST(UtilsTest, addReadHits)
     j = 0;
     EXPECT_EQ(j, minimizer_hits->hits.size());
     s = Seq(0, "read3", "AGCT", 1, 3);
-    add_read_hits(s, minimizer_hits, *index);
-    expected1.hits.insert(expected2.hits.begin(), expected2.hits.end());
-    EXPECT_EQ(expected1.hits.size(), minimizer_hits->hits.size());
-    it2 = expected1.hits.begin();
+    add_read_hits(s, minimizer_hits, frozen_index);
+    minimizer_hits->sort();
+    expected1.insert(expected2.begin(), expected2.end());
+    EXPECT_EQ(expected1.size(), minimizer_hits->hits.size());
+    it2 = expected1.begin();
     for (auto it = minimizer_hits->hits.begin(); it != minimizer_hits->hits.end();
          ++it) {
-        EXPECT_EQ(**it2, **it);
+        EXPECT_EQ(**it2, MinimizerHit(*it));
         it2++;
     }
 
@@ -300,19 +341,20 @@ TEST(UtilsTest, addReadHits)
     j = 0;
     EXPECT_EQ(j, minimizer_hits->hits.size());
     s = Seq(0, "read3", "AGCT", 2, 3);
-    add_read_hits(s, minimizer_hits, *index);
-    EXPECT_EQ(expected1.hits.size(), minimizer_hits->hits.size());
-    it2 = expected1.hits.begin();
+    add_read_hits(s, minimizer_hits, frozen_index);
+    minimizer_hits->sort();
+    EXPECT_EQ(expected1.size(), minimizer_hits->hits.size());
+    it2 = expected1.begin();
     for (auto it = minimizer_hits->hits.begin(); it != minimizer_hits->hits.end();
          ++it) {
-        EXPECT_EQ(**it2, **it);
+        EXPECT_EQ(**it2, MinimizerHit(*it));
         it2++;
     }
 
-    expected1.hits.clear();
-    expected2.hits.clear();
-    expected3.hits.clear();
-    expected4.hits.clear();
+    expected1.clear();
+    expected2.clear();
+    expected3.clear();
+    expected4.clear();
     index->clear();
 }
 
@@ -357,6 +399,61 @@ TEST(UtilsTest, filter_clusters2)
     EXPECT_EQ(ss_exp.size(), ss.size());
 }
 
+TEST(UtilsTest, defineClusters_smallClustersDontMaterializePrgs)
+{
+    std::vector<std::shared_ptr<LocalPRG>> prgs;
+    for (uint32_t id = 0; id < 2; ++id) {
+        prgs.push_back(std::make_shared<LocalPRG>(id, std::to_string(id), "ACGT", true));
+    }
+    prg::Path p;
+    p.initialize(Interval(0, 3));
+    // the graph of PRG 0 is start node -> k-mer node -> end node
+    prgs[0]->set_kmer_graph_loader([&](KmerGraph& kmer_graph) {
+        prg::Path terminus;
+        terminus.initialize(Interval(0, 0));
+        const auto start = kmer_graph.add_node(terminus);
+        const auto kmer = kmer_graph.add_node(p);
+        terminus.initialize(Interval(4, 4));
+        const auto end = kmer_graph.add_node(terminus);
+        kmer_graph.add_edge(start, kmer);
+        kmer_graph.add_edge(kmer, end);
+    });
+
+    // 3 hits on PRG 0, and 2 on PRG 1
+    auto minimizer_hits = std::make_shared<MinimizerHits>();
+    for (uint32_t i = 0; i < 5; ++i) {
+        Minimizer m(0, i, i + 3, 0);
+        minimizer_hits->add_hit(0, m, i < 3 ? 0 : 1, p, 0, false);
+    }
+
+    std::set<MinimizerHitCluster, clusterComp> clusters;
+    define_clusters(clusters, prgs, minimizer_hits, 10, 0.1, 2, 100);
+    EXPECT_TRUE(prgs[0]->is_materialized());
+    EXPECT_FALSE(prgs[1]->is_materialized());
+    EXPECT_EQ(clusters.size(), (size_t)1);
+}
+
+TEST(UtilsTest, defineClusters_lazyPrgWithoutKmerGraph)
+{
+    std::vector<std::shared_ptr<LocalPRG>> prgs {
+        std::make_shared<LocalPRG>(0, "0", "ACGT", true)
+    };
+    prg::Path p;
+    p.initialize(Interval(0, 3));
+
+    auto minimizer_hits = std::make_shared<MinimizerHits>();
+    for (uint32_t i = 0; i < 3; ++i) {
+        Minimizer m(0, i, i + 3, 0);
+        minimizer_hits->add_hit(0, m, 0, p, 0, false);
+    }
+
+    std::set<MinimizerHitCluster, clusterComp> clusters;
+    define_clusters(clusters, prgs, minimizer_hits, 10, 0.1, 2, 100);
+    EXPECT_TRUE(prgs[0]->is_materialized());
+    EXPECT_EQ(prgs[0]->kmer_prg.min_path_length(), (uint32_t)0);
+    EXPECT_EQ(clusters.size(), (size_t)1);
+}
+
 TEST(UtilsTest, simpleInferLocalPRGOrderForRead)
 {
     // initialize minihits container
@@ -483,8 +580,9 @@ TEST(UtilsTest, simpleInferLocalPRGOrderForRead)
     lp3->kmer_prg.add_edge(v[12], v[13]);
 
     // add read hits to mhs
+    const FrozenIndex frozen_index(*index);
     Seq s(0, "read1", "AGTTAAGTACG", 1, 3);
-    add_read_hits(s, minimizer_hits, *index);
+    add_read_hits(s, minimizer_hits, frozen_index);
     // add_read_hits(0, "read1", "AGTTAAGTACG", mhs, index, 1, 3);
 
     // initialize pangraph;
@@ -717,8 +815,9 @@ TEST(UtilsTest, biggerInferLocalPRGOrderForRead)
     lp2->kmer_prg.add_edge(v[24], v[25]);
 
     // add read hits to mhs
+    const FrozenIndex frozen_index(*index);
     Seq s(0, "read2", "AGTTATGCTAGCTACTTACGGTA", 1, 3);
-    add_read_hits(s, minimizer_hits, *index);
+    add_read_hits(s, minimizer_hits, frozen_index);
     // add_read_hits(0, "read2", "AGTTATGCTAGCTACTTACGGTA", mhs, index, 1, 3);
 
     // initialize pangraph;
@@ -969,8 +1068,9 @@ TEST(UtilsTest, pangraphFromReadFile_Fa)
     setup_index(prgs, index);
 
     auto pangraph = std::make_shared<pangenome::Graph>(pangenome::Graph());
+    auto frozen_index = std::make_shared<FrozenIndex>(*index);
     pangraph_from_read_file(
-        TEST_CASE_DIR + "read2.fa", pangraph, index, prgs, 1, 3, 1, 0.1, 1);
+        TEST_CASE_DIR + "read2.fa", pangraph, frozen_index, prgs, 1, 3, 1, 0.1, 1);
 
     // create a pangraph object representing the truth we expect (prg 3 4 2 1)
     // note that prgs 1, 3, 4 share no 3mer, but 2 shares a 3mer with each of 2 other
@@ -994,8 +1094,9 @@ TEST(UtilsTest, pangraphFromReadFile_Fq)
     setup_index(prgs, index);
 
     auto pangraph = std::make_shared<pangenome::Graph>(pangenome::Graph());
+    auto frozen_index = std::make_shared<FrozenIndex>(*index);
     pangraph_from_read_file(
-        TEST_CASE_DIR + "read2.fq", pangraph, index, prgs, 1, 3, 1, 0.1, 1);
+        TEST_CASE_DIR + "read2.fq", pangraph, frozen_index, prgs, 1, 3, 1, 0.1, 1);
 
     // create a pangraph object representing the truth we expect (prg 3 4 2 1)
     // note that prgs 1, 3, 4 share no 3mer, but 2 shares a 3mer with each of 2 other